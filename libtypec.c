@@ -41,11 +41,26 @@ SOFTWARE.
 #include <errno.h>
 #include <sys/stat.h>
 #include <fcntl.h>
+#include <time.h>
+#include <limits.h>
 
 static char ver_buf[64];
 static struct utsname ker_uname;
 static const struct libtypec_os_backend *cur_libtypec_os_backend;
 
+/*
+ * Run fn(arg) through the async scheduler in class prio, for queries that
+ * have no op of their own. Returns 1 with *ret set if the engine ran it, 0 if
+ * the caller should run it directly.
+ */
+static int route_call(enum libtypec_async_prio prio, int (*fn)(void *), void *arg, int *ret)
+{
+    struct libtypec_async_call call = { .fn = fn, .arg = arg };
+    struct libtypec_async_req req = { .op = LIBTYPEC_ASYNC_CALL, .prio = prio, .buf = &call };
+
+    return libtypec_async_route(&req, ret);
+}
+
 /**
  * \mainpage libtypec 0.4.0 API Reference
  *
@@ -193,6 +208,12 @@ int libtypec_exit(void)
     if (!cur_libtypec_os_backend || !cur_libtypec_os_backend->exit )
         return -EIO;
 
+    libtypec_async_stop();
+    libtypec_telemetry_stop();
+    libtypec_energy_close();
+    libtypec_journal_close();
+    libtypec_profile_close();
+
     /* clear session info */
 
     return cur_libtypec_os_backend->exit();
@@ -208,9 +229,15 @@ int libtypec_exit(void)
  */
 int libtypec_connector_reset(int conn_num, int rst_type)
 {
+    struct libtypec_async_req req = { .op = LIBTYPEC_ASYNC_CONNECTOR_RESET, .conn_num = conn_num, .arg = { rst_type } };
+    int ret;
+
     if (!cur_libtypec_os_backend || !cur_libtypec_os_backend->connector_reset)
         return -EIO;
 
+    if (libtypec_async_route(&req, &ret))
+        return ret;
+
     return cur_libtypec_os_backend->connector_reset(conn_num, rst_type);
 }
 
@@ -223,9 +250,15 @@ int libtypec_connector_reset(int conn_num, int rst_type)
  */
 int libtypec_set_uor(unsigned char conn_num, unsigned char uor)
 {
+    struct libtypec_async_req req = { .op = LIBTYPEC_ASYNC_SET_UOR, .conn_num = conn_num, .arg = { uor } };
+    int ret;
+
     if (!cur_libtypec_os_backend || !cur_libtypec_os_backend->set_uor_ops)
         return -EIO;
 
+    if (libtypec_async_route(&req, &ret))
+        return ret;
+
     return cur_libtypec_os_backend->set_uor_ops(conn_num, uor);
 }
 
@@ -238,9 +271,15 @@ int libtypec_set_uor(unsigned char conn_num, unsigned char uor)
  */
 int libtypec_set_pdr(unsigned char conn_num, unsigned char pdr)
 {
+    struct libtypec_async_req req = { .op = LIBTYPEC_ASYNC_SET_PDR, .conn_num = conn_num, .arg = { pdr } };
+    int ret;
+
     if (!cur_libtypec_os_backend || !cur_libtypec_os_backend->set_pdr_ops)
         return -EIO;
 
+    if (libtypec_async_route(&req, &ret))
+        return ret;
+
     return cur_libtypec_os_backend->set_pdr_ops(conn_num, pdr);
 }
 
@@ -253,9 +292,15 @@ int libtypec_set_pdr(unsigned char conn_num, unsigned char pdr)
  */
 int libtypec_set_ccom(unsigned char conn_num, unsigned char ccom)
 {
+    struct libtypec_async_req req = { .op = LIBTYPEC_ASYNC_SET_CCOM, .conn_num = conn_num, .arg = { ccom } };
+    int ret;
+
     if (!cur_libtypec_os_backend || !cur_libtypec_os_backend->set_ccom_ops)
         return -EIO;
 
+    if (libtypec_async_route(&req, &ret))
+        return ret;
+
     return cur_libtypec_os_backend->set_ccom_ops(conn_num, ccom);
 }
 
@@ -268,9 +313,15 @@ int libtypec_set_ccom(unsigned char conn_num, unsigned char ccom)
  */
 int libtypec_get_capability(struct libtypec_capability_data *cap_data)
 {
+    struct libtypec_async_req req = { .op = LIBTYPEC_ASYNC_GET_CAPABILITY, .prio = LIBTYPEC_ASYNC_PRIO_QUERY, .buf = cap_data };
+    int ret;
+
     if (!cur_libtypec_os_backend || !cur_libtypec_os_backend->get_capability_ops )
         return -EIO;
 
+    if (libtypec_async_route(&req, &ret))
+        return ret;
+
     return cur_libtypec_os_backend->get_capability_ops(cap_data);
 }
 
@@ -285,9 +336,15 @@ int libtypec_get_capability(struct libtypec_capability_data *cap_data)
  */
 int libtypec_get_conn_capability(int conn_num, struct libtypec_connector_cap_data *conn_cap_data)
 {
+    struct libtypec_async_req req = { .op = LIBTYPEC_ASYNC_GET_CONN_CAPABILITY, .prio = LIBTYPEC_ASYNC_PRIO_QUERY, .conn_num = conn_num, .buf = conn_cap_data };
+    int ret;
+
     if (!cur_libtypec_os_backend || !cur_libtypec_os_backend->get_conn_capability_ops )
         return -EIO;
 
+    if (libtypec_async_route(&req, &ret))
+        return ret;
+
     return cur_libtypec_os_backend->get_conn_capability_ops(conn_num, conn_cap_data);
 }
 
@@ -304,10 +361,18 @@ int libtypec_get_conn_capability(int conn_num, struct libtypec_connector_cap_dat
  */
 int libtypec_get_alternate_modes(int recipient, int conn_num, struct altmode_data *alt_mode_data)
 {
+    struct libtypec_async_req req = { .op = LIBTYPEC_ASYNC_GET_ALTERNATE_MODES, .prio = LIBTYPEC_ASYNC_PRIO_QUERY, .conn_num = conn_num, .arg = { recipient }, .buf = alt_mode_data };
+    int ret;
+
     if (!cur_libtypec_os_backend || !cur_libtypec_os_backend->get_alternate_modes )
         return -EIO;
 
-    return cur_libtypec_os_backend->get_alternate_modes(recipient, conn_num, alt_mode_data);
+    if (libtypec_async_route(&req, &ret))
+        return ret;
+
+    ret = cur_libtypec_os_backend->get_alternate_modes(recipient, conn_num, alt_mode_data, LIBTYPEC_MAX_ALTMODES_LEGACY);
+
+    return ret > LIBTYPEC_MAX_ALTMODES_LEGACY ? LIBTYPEC_MAX_ALTMODES_LEGACY : ret;
 }
 
 /**
@@ -319,9 +384,15 @@ int libtypec_get_alternate_modes(int recipient, int conn_num, struct altmode_dat
  */
 int libtypec_get_cable_properties(int conn_num, struct libtypec_cable_property *cbl_prop_data)
 {
+    struct libtypec_async_req req = { .op = LIBTYPEC_ASYNC_GET_CABLE_PROPERTIES, .prio = LIBTYPEC_ASYNC_PRIO_QUERY, .conn_num = conn_num, .buf = cbl_prop_data };
+    int ret;
+
     if (!cur_libtypec_os_backend || !cur_libtypec_os_backend->get_cable_properties_ops )
         return -EIO;
 
+    if (libtypec_async_route(&req, &ret))
+        return ret;
+
     return cur_libtypec_os_backend->get_cable_properties_ops(conn_num, cbl_prop_data);
 }
 
@@ -334,10 +405,78 @@ int libtypec_get_cable_properties(int conn_num, struct libtypec_cable_property *
  */
 int libtypec_get_connector_status(int conn_num, struct libtypec_connector_status *conn_sts)
 {
+    return libtypec_get_connector_status_prio(conn_num, conn_sts, LIBTYPEC_ASYNC_PRIO_QUERY);
+}
+
+/* libtypec_get_connector_status() in scheduling class prio, for pollers */
+int libtypec_get_connector_status_prio(int conn_num, struct libtypec_connector_status *conn_sts,
+                                       enum libtypec_async_prio prio)
+{
+    struct libtypec_async_req req = { .op = LIBTYPEC_ASYNC_GET_CONNECTOR_STATUS, .prio = prio, .conn_num = conn_num, .buf = conn_sts };
+    int ret;
+
     if (!cur_libtypec_os_backend || !cur_libtypec_os_backend->get_connector_status_ops )
         return -EIO;
 
-    return cur_libtypec_os_backend->get_connector_status_ops(conn_num, conn_sts);
+    /* The engine thread evaluates the alerts */
+    if (libtypec_async_route(&req, &ret))
+        return ret;
+
+    ret = cur_libtypec_os_backend->get_connector_status_ops(conn_num, conn_sts);
+    if (ret >= 0)
+        libtypec_alert_eval_status(conn_num, conn_sts);
+
+    return ret;
+}
+
+/**
+ * This function shall be used to take one VBUS voltage and current reading
+ * of a connector
+ *
+ * \param conn_num connector number
+ * \param sample Filled with the reading, stamped with CLOCK_MONOTONIC
+ *
+ * \returns 0 on success, -ENODATA when the connector has no reading
+ */
+int libtypec_get_power_sample(int conn_num, struct libtypec_power_sample *sample)
+{
+    return libtypec_get_power_sample_prio(conn_num, sample, LIBTYPEC_ASYNC_PRIO_QUERY);
+}
+
+struct power_sample_args {
+    int conn_num;
+    struct libtypec_power_sample *sample;
+};
+
+static int power_sample_call(void *arg)
+{
+    struct power_sample_args *a = arg;
+
+    return libtypec_get_power_sample(a->conn_num, a->sample);
+}
+
+/* libtypec_get_power_sample() in scheduling class prio, for the sampler */
+int libtypec_get_power_sample_prio(int conn_num, struct libtypec_power_sample *sample,
+                                   enum libtypec_async_prio prio)
+{
+    struct power_sample_args args = { conn_num, sample };
+    struct timespec ts;
+    int ret;
+
+    if (!cur_libtypec_os_backend || !cur_libtypec_os_backend->get_power_sample_ops )
+        return -EIO;
+
+    if (route_call(prio, power_sample_call, &args, &ret))
+        return ret;
+
+    ret = cur_libtypec_os_backend->get_power_sample_ops(conn_num, sample);
+    if (ret < 0)
+        return ret;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    sample->ts_ns = (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+
+    return 0;
 }
 
 /**
@@ -351,9 +490,15 @@ int libtypec_get_connector_status(int conn_num, struct libtypec_connector_status
 
 int libtypec_get_current_cam(int conn_num, struct libtypec_current_cam *cur_cam)
 {
+    struct libtypec_async_req req = { .op = LIBTYPEC_ASYNC_GET_CURRENT_CAM, .prio = LIBTYPEC_ASYNC_PRIO_QUERY, .conn_num = conn_num, .buf = cur_cam };
+    int ret;
+
     if (!cur_libtypec_os_backend || !cur_libtypec_os_backend->get_current_cam_ops)
         return -EIO;
 
+    if (libtypec_async_route(&req, &ret))
+        return ret;
+
     return cur_libtypec_os_backend->get_current_cam_ops(conn_num, cur_cam);
 }
 
@@ -369,11 +514,29 @@ int libtypec_get_current_cam(int conn_num, struct libtypec_current_cam *cur_cam)
  * \returns 0 on success
  */
 
+struct pd_message_args {
+    int recipient, conn_num, num_bytes, resp_type;
+    char *resp;
+};
+
+static int pd_message_call(void *arg)
+{
+    struct pd_message_args *a = arg;
+
+    return libtypec_get_pd_message(a->recipient, a->conn_num, a->num_bytes, a->resp_type, a->resp);
+}
+
 int libtypec_get_pd_message(int recipient, int conn_num, int num_bytes, int resp_type, char *pd_msg_resp)
 {
+    struct pd_message_args args = { recipient, conn_num, num_bytes, resp_type, pd_msg_resp };
+    int ret;
+
     if (!cur_libtypec_os_backend || !cur_libtypec_os_backend->get_pd_message_ops )
         return -EIO;
 
+    if (route_call(LIBTYPEC_ASYNC_PRIO_QUERY, pd_message_call, &args, &ret))
+        return ret;
+
     return cur_libtypec_os_backend->get_pd_message_ops(recipient, conn_num, num_bytes, resp_type, pd_msg_resp);
 }
 
@@ -398,11 +561,169 @@ int libtypec_get_pd_message(int recipient, int conn_num, int num_bytes, int resp
  */
 int libtypec_get_pdos (int conn_num, int partner, int offset, int *num_pdo, int src_snk, int type, struct libtypec_get_pdos *pdo_data)
 {
+    struct libtypec_async_req req = { .op = LIBTYPEC_ASYNC_GET_PDOS, .prio = LIBTYPEC_ASYNC_PRIO_QUERY, .conn_num = conn_num,
+                                      .arg = { partner, offset, src_snk, type }, .buf = pdo_data };
+    int ret;
+
+    if (!cur_libtypec_os_backend || !cur_libtypec_os_backend->get_pdos_ops )
+        return -EIO;
+
+    if (libtypec_async_route(&req, &ret))
+    {
+        *num_pdo = req.out;
+        return ret;
+    }
+
+    return cur_libtypec_os_backend->get_pdos_ops(conn_num,  partner, offset,  num_pdo,  src_snk, type,
+                                                 pdo_data->pdo, sizeof(pdo_data->pdo) / sizeof(pdo_data->pdo[0]));
+
+}
+
+/**
+ * This function shall be used to set up an arena for the *_view queries
+ *
+ * \param arena Arena to initialize
+ * \param buf Caller memory backing the arena
+ * \param size Size of buf in bytes
+ */
+void libtypec_arena_init(struct libtypec_arena *arena, void *buf, size_t size)
+{
+    arena->base = buf;
+    arena->size = size;
+    arena->used = 0;
+}
+
+/**
+ * This function shall be used to release every view of an arena at once
+ *
+ * \param arena Arena to reset
+ */
+void libtypec_arena_reset(struct libtypec_arena *arena)
+{
+    arena->used = 0;
+}
+
+/* Aligned free space of an arena, returned as a count of elem sized slots */
+static void *arena_tail(struct libtypec_arena *arena, size_t elem, size_t *slots)
+{
+    size_t start = (arena->used + _Alignof(max_align_t) - 1) & ~(_Alignof(max_align_t) - 1);
+
+    if (start >= arena->size)
+    {
+        *slots = 0;
+        return arena->base + arena->size;
+    }
+
+    *slots = (arena->size - start) / elem;
+    return arena->base + start;
+}
+
+/**
+ * This function shall be used to get all PDOs of a connector or its partner
+ * into an arena, with room for SPR and EPR PDOs
+ *
+ * \param conn_num connector number
+ * \param partner 1 for the partner PDOs, 0 for the connector's own
+ * \param src_snk 1 for source, 0 for sink capabilities
+ * \param type PDO type filter of GET_PDOS
+ * \param arena Arena the PDOs are stored in
+ * \param view Set to the PDOs in the arena
+ *
+ * \returns number of PDOs, -ENOSPC if the arena has no room for LIBTYPEC_MAX_PDOS
+ */
+struct pdos_view_args {
+    int conn_num, partner, src_snk, type;
+    struct libtypec_arena *arena;
+    struct libtypec_pdo_view *view;
+};
+
+static int pdos_view_call(void *arg)
+{
+    struct pdos_view_args *a = arg;
+
+    return libtypec_get_pdos_view(a->conn_num, a->partner, a->src_snk, a->type, a->arena, a->view);
+}
+
+int libtypec_get_pdos_view(int conn_num, int partner, int src_snk, int type,
+                           struct libtypec_arena *arena, struct libtypec_pdo_view *view)
+{
+    struct pdos_view_args args = { conn_num, partner, src_snk, type, arena, view };
+    unsigned int *pdo;
+    size_t slots;
+    int ret, num = 0;
+
     if (!cur_libtypec_os_backend || !cur_libtypec_os_backend->get_pdos_ops )
         return -EIO;
 
-    return cur_libtypec_os_backend->get_pdos_ops(conn_num,  partner, offset,  num_pdo,  src_snk, type, pdo_data);
+    if (route_call(LIBTYPEC_ASYNC_PRIO_QUERY, pdos_view_call, &args, &ret))
+        return ret;
+
+    pdo = arena_tail(arena, sizeof(*pdo), &slots);
+    if (slots < LIBTYPEC_MAX_PDOS)
+        return -ENOSPC;
+
+    ret = cur_libtypec_os_backend->get_pdos_ops(conn_num, partner, 0, &num, src_snk, type, pdo, LIBTYPEC_MAX_PDOS);
+    if (ret < 0)
+        return ret;
 
+    view->pdo = pdo;
+    view->num = num;
+    arena->used = (unsigned char *)(pdo + num) - arena->base;
+
+    return num;
+}
+
+/**
+ * This function shall be used to get the alternate modes of a recipient
+ * into an arena. The view takes as much of the arena as the modes need.
+ *
+ * \param recipient AM_CONNECTOR, AM_SOP or AM_SOP_PR
+ * \param conn_num connector number
+ * \param arena Arena the modes are stored in
+ * \param view Set to the modes in the arena
+ *
+ * \returns number of modes, -ENOSPC if the arena could not hold them all;
+ * view->total then tells how many there are
+ */
+struct altmodes_view_args {
+    int recipient, conn_num;
+    struct libtypec_arena *arena;
+    struct libtypec_altmode_view *view;
+};
+
+static int altmodes_view_call(void *arg)
+{
+    struct altmodes_view_args *a = arg;
+
+    return libtypec_get_alternate_modes_view(a->recipient, a->conn_num, a->arena, a->view);
+}
+
+int libtypec_get_alternate_modes_view(int recipient, int conn_num,
+                                      struct libtypec_arena *arena, struct libtypec_altmode_view *view)
+{
+    struct altmodes_view_args args = { recipient, conn_num, arena, view };
+    struct altmode_data *am;
+    size_t slots;
+    int ret;
+
+    if (!cur_libtypec_os_backend || !cur_libtypec_os_backend->get_alternate_modes )
+        return -EIO;
+
+    if (route_call(LIBTYPEC_ASYNC_PRIO_QUERY, altmodes_view_call, &args, &ret))
+        return ret;
+
+    am = arena_tail(arena, sizeof(*am), &slots);
+
+    ret = cur_libtypec_os_backend->get_alternate_modes(recipient, conn_num, am, slots > INT_MAX ? INT_MAX : (int)slots);
+    if (ret < 0)
+        return ret;
+
+    view->am = am;
+    view->total = ret;
+    view->num = (size_t)ret > slots ? (int)slots : ret;
+    arena->used = (unsigned char *)(am + view->num) - arena->base;
+
+    return view->num < view->total ? -ENOSPC : view->num;
 }
 
 /**
@@ -414,10 +735,15 @@ int libtypec_get_pdos (int conn_num, int partner, int offset, int *num_pdo, int
  */
 int libtypec_get_error_status(unsigned char conn_num, struct libtypec_get_error_status *error_status)
 {
+    struct libtypec_async_req req = { .op = LIBTYPEC_ASYNC_GET_ERROR_STATUS, .prio = LIBTYPEC_ASYNC_PRIO_QUERY, .conn_num = conn_num, .buf = error_status };
+    int ret;
 
     if (!cur_libtypec_os_backend || !cur_libtypec_os_backend->get_error_status_ops)
         return -EIO;
 
+    if (libtypec_async_route(&req, &ret))
+        return ret;
+
     return cur_libtypec_os_backend->get_error_status_ops(conn_num, error_status);
 
 }
@@ -431,10 +757,15 @@ int libtypec_get_error_status(unsigned char conn_num, struct libtypec_get_error_
  */
 int libtypec_set_new_cam(unsigned char conn_num, unsigned char entry_exit, unsigned char new_cam, unsigned int am_spec)
 {
+    struct libtypec_async_req req = { .op = LIBTYPEC_ASYNC_SET_NEW_CAM, .conn_num = conn_num, .arg = { entry_exit, new_cam, am_spec } };
+    int ret;
 
     if (!cur_libtypec_os_backend || !cur_libtypec_os_backend->set_new_cam_ops)
         return -EIO;
 
+    if (libtypec_async_route(&req, &ret))
+        return ret;
+
     return cur_libtypec_os_backend->set_new_cam_ops(conn_num, entry_exit, new_cam, am_spec);
 
 }
@@ -448,10 +779,15 @@ int libtypec_set_new_cam(unsigned char conn_num, unsigned char entry_exit, unsig
  */
 int libtypec_get_cam_cs(unsigned char conn_num, unsigned char cam, struct libtypec_get_cam_cs *cam_cs)
 {
+    struct libtypec_async_req req = { .op = LIBTYPEC_ASYNC_GET_CAM_CS, .prio = LIBTYPEC_ASYNC_PRIO_QUERY, .conn_num = conn_num, .arg = { cam }, .buf = cam_cs };
+    int ret;
 
     if (!cur_libtypec_os_backend || !cur_libtypec_os_backend->get_cam_cs_ops)
         return -EIO;
 
+    if (libtypec_async_route(&req, &ret))
+        return ret;
+
     return cur_libtypec_os_backend->get_cam_cs_ops(conn_num, cam, cam_cs);
 }
 
@@ -464,10 +800,15 @@ int libtypec_get_cam_cs(unsigned char conn_num, unsigned char cam, struct libtyp
  */
 int libtypec_get_lpm_ppm_info(unsigned char conn_num, struct libtypec_get_lpm_ppm_info *lpm_ppm_info)
 {
+    struct libtypec_async_req req = { .op = LIBTYPEC_ASYNC_GET_LPM_PPM_INFO, .prio = LIBTYPEC_ASYNC_PRIO_QUERY, .conn_num = conn_num, .buf = lpm_ppm_info };
+    int ret;
 
     if (!cur_libtypec_os_backend || !cur_libtypec_os_backend->get_lpm_ppm_info_ops)
         return -EIO;
 
+    if (libtypec_async_route(&req, &ret))
+        return ret;
+
     return cur_libtypec_os_backend->get_lpm_ppm_info_ops(conn_num, lpm_ppm_info);
 
 }
@@ -510,6 +851,75 @@ int libtypec_get_bb_data(int bb_instance,char* bb_data)
 
 }
 
+/**
+ * This function shall be used to select how PPM commands are arbitrated
+ * between processes sharing a command channel (e.g. UCSI debugfs)
+ *
+ * \param  mode LIBTYPEC_CMD_ARB_LEASE to take a lease per command or
+ * LIBTYPEC_CMD_ARB_BROKER to forward commands to a running broker
+ *
+ * \param  max_wait_ms Bound on waiting for the channel, 0 keeps the current value
+ *
+ * \returns 0 on success, -EBUSY is returned by commands that could not get the
+ * channel within max_wait_ms. In broker mode commands never fall back to the
+ * lease: a lost broker connection is retried on the next command, which fails
+ * with the connect error if the broker is gone.
+ */
+int libtypec_set_cmd_arbitration(enum libtypec_cmd_arbitration mode, unsigned int max_wait_ms)
+{
+    if (!cur_libtypec_os_backend || !cur_libtypec_os_backend->set_cmd_arbitration_ops)
+        return -EIO;
+
+    return cur_libtypec_os_backend->set_cmd_arbitration_ops(mode, max_wait_ms);
+}
+
+/**
+ * This function shall be used to serve PPM commands for other processes
+ * using LIBTYPEC_CMD_ARB_BROKER. Clients are served round robin, one command
+ * each per turn. The function does not return unless an error occurs.
+ *
+ * \returns negative error code on failure
+ */
+int libtypec_run_cmd_broker(void)
+{
+    if (!cur_libtypec_os_backend || !cur_libtypec_os_backend->run_cmd_broker_ops)
+        return -EIO;
+
+    return cur_libtypec_os_backend->run_cmd_broker_ops();
+}
+
+/**
+ * This function shall be used to bound how long a PPM command may take,
+ * measured from when the command channel is obtained until the response
+ * is read
+ *
+ * \param  timeout_ms Per command deadline in milliseconds, 0 restores the default
+ *
+ * \returns 0 on success, commands exceeding the deadline fail with -ETIMEDOUT
+ */
+int libtypec_set_cmd_timeout(unsigned int timeout_ms)
+{
+    if (!cur_libtypec_os_backend || !cur_libtypec_os_backend->set_cmd_timeout_ops)
+        return -EIO;
+
+    return cur_libtypec_os_backend->set_cmd_timeout_ops(timeout_ms);
+}
+
+/**
+ * This function shall be used to cancel PPM commands that are in flight or
+ * waiting for the command channel. It may be called from any thread.
+ * Commands issued after it returns are not affected.
+ *
+ * \returns 0 on success, cancelled commands fail with -ECANCELED
+ */
+int libtypec_cancel(void)
+{
+    if (!cur_libtypec_os_backend || !cur_libtypec_os_backend->cancel_cmd_ops)
+        return -EIO;
+
+    return cur_libtypec_os_backend->cancel_cmd_ops();
+}
+
 int libtypec_register_typec_notification_callback(enum usb_typec_event event, usb_typec_callback_t cb, void* data)
 {
     if (event >= USBC_EVENT_COUNT) {
@@ -548,6 +958,11 @@ int libtypec_unregister_callback(enum usb_typec_event event, usb_typec_callback_
     return 0;
 }
 
+/**
+ * This function runs the event loop of the backend and calls the registered
+ * callbacks. On the sysfs backend events come from udev, on the debugfs
+ * backend they are synthesized by polling GET_CONNECTOR_STATUS.
+ */
 void libtypec_monitor_events(void)
 {
     if (!cur_libtypec_os_backend || !cur_libtypec_os_backend->monitor_events )
@@ -555,3 +970,275 @@ void libtypec_monitor_events(void)
 
     cur_libtypec_os_backend->monitor_events();
 }
+
+enum libtypec_event_source libtypec_event_src = LIBTYPEC_EVENT_SRC_AUTO;
+
+/**
+ * This function shall be used to select where the sysfs backend takes its
+ * events from, before calling libtypec_monitor_events()
+ *
+ * \param src LIBTYPEC_EVENT_SRC_UDEV, LIBTYPEC_EVENT_SRC_KERNEL or
+ * LIBTYPEC_EVENT_SRC_AUTO to use kernel uevents when udevd is not running
+ *
+ * \returns 0 on success, -EINVAL on invalid source
+ */
+int libtypec_set_event_source(enum libtypec_event_source src)
+{
+    if (src < LIBTYPEC_EVENT_SRC_AUTO || src > LIBTYPEC_EVENT_SRC_KERNEL)
+        return -EINVAL;
+
+    libtypec_event_src = src;
+
+    return 0;
+}
+
+static __thread const struct libtypec_event_info *cur_event_info;
+
+/* Call all callbacks registered for event, info is visible to them */
+void libtypec_notify(enum usb_typec_event event, const struct libtypec_event_info *info)
+{
+    const struct libtypec_event_info *prev = cur_event_info;
+    libtypec_notification_list_t* node;
+    struct libtypec_event_info with_status;
+
+    if (event >= USBC_EVENT_COUNT)
+        return;
+
+    if (libtypec_journal_active())
+    {
+        /* The journal keeps connector state, udev events carry none */
+        if (!info->status_valid && info->conn_num >= 0 && event < USBC_ALERT &&
+            cur_libtypec_os_backend && cur_libtypec_os_backend->get_connector_status_ops)
+        {
+            with_status = *info;
+            memset(&with_status.status, 0, sizeof(with_status.status));
+            if (libtypec_get_connector_status_prio(info->conn_num, &with_status.status, LIBTYPEC_ASYNC_PRIO_QUERY) >= 0)
+            {
+                with_status.status_valid = 1;
+                info = &with_status;
+            }
+        }
+        libtypec_journal_event(event, info);
+    }
+
+    cur_event_info = info;
+    for (node = registered_callbacks[event]; node; node = node->next)
+        node->cb_func(event, node->data);
+    cur_event_info = prev;
+}
+
+/* Fan a set of connector status change bits out into typed events */
+void libtypec_notify_status_change(const struct libtypec_event_info *info)
+{
+    static const enum usb_typec_event bit_event[16] = {
+        [1] = USBC_EXT_SUPPLY_CHANGED,
+        [2] = USBC_POWER_OPMODE_CHANGED,
+        [3] = USBC_ATTENTION,
+        [5] = USBC_PROVIDER_CAPS_CHANGED,
+        [6] = USBC_POWER_LEVEL_CHANGED,
+        [7] = USBC_PD_RESET_COMPLETE,
+        [8] = USBC_CAM_CHANGED,
+        [9] = USBC_BATTERY_STATUS_CHANGED,
+        [11] = USBC_PARTNER_CHANGED,
+        [12] = USBC_POWER_DIRECTION_CHANGED,
+        [13] = USBC_SINK_PATH_CHANGED,
+        [15] = USBC_CONNECTOR_ERROR,
+    };
+    unsigned short bits = info->changed.raw_conn_stschang;
+    int i;
+
+    if (info->changed.ConnectChange)
+        libtypec_notify(info->status_valid && !info->status.ConnectStatus ?
+                        USBC_DEVICE_DISCONNECTED : USBC_DEVICE_CONNECTED, info);
+
+    for (i = 0; i < 16; i++)
+    {
+        if ((bits & (1 << i)) && bit_event[i])
+            libtypec_notify(bit_event[i], info);
+    }
+
+    if (info->status_valid)
+        libtypec_alert_eval_status(info->conn_num, &info->status);
+}
+
+/*
+ * Change bits between two connector statuses: bits newly reported by the PPM
+ * plus bits synthesized from field diffs, since the kernel driver usually
+ * acknowledges the PPM change bits and sysfs reports none at all.
+ */
+unsigned short libtypec_status_diff(const struct libtypec_connector_status *old,
+                                   const struct libtypec_connector_status *cur)
+{
+    union connectorstatuschange chg;
+
+    chg.raw_conn_stschang = cur->ConnectorStatusChange.raw_conn_stschang &
+                            ~old->ConnectorStatusChange.raw_conn_stschang;
+
+    if (cur->ConnectStatus != old->ConnectStatus)
+        chg.ConnectChange = 1;
+    if (cur->PowerOperationMode != old->PowerOperationMode)
+        chg.PowerOperationModechange = 1;
+    if (cur->PowerDirection != old->PowerDirection)
+        chg.PowerDirectionChanged = 1;
+    if (cur->RequestDataObject != old->RequestDataObject)
+        chg.NegotiatedPowerLevelChange = 1;
+    if (cur->ConnectorPartnerFlags != old->ConnectorPartnerFlags ||
+        cur->ConnectorPartnerType != old->ConnectorPartnerType)
+        chg.ConnectorPartnerChanged = 1;
+    if (cur->SinkPathStatus != old->SinkPathStatus)
+        chg.SinkPathStatusChange = 1;
+    if (cur->BatteryChargingCapabilityStatus != old->BatteryChargingCapabilityStatus)
+        chg.BatteryChargingStatusChange = 1;
+
+    return chg.raw_conn_stschang;
+}
+
+/* Create the directory a state file such as LIBTYPEC_JOURNAL_FILE lives in */
+int libtypec_state_dir(const char *path)
+{
+    char dir[PATH_MAX];
+    char *slash;
+
+    snprintf(dir, sizeof(dir), "%s", path);
+    slash = strrchr(dir, '/');
+    if (!slash || slash == dir)
+        return 0;
+    *slash = '\0';
+
+    if (mkdir(dir, 0755) < 0 && errno != EEXIST)
+        return -errno;
+
+    return 0;
+}
+
+static int refresh_partner_pdos(int conn_num, int src_snk, unsigned int *pdo, int *num)
+{
+    struct libtypec_arena arena;
+    struct libtypec_pdo_view view;
+    int ret;
+
+    libtypec_arena_init(&arena, pdo, LIBTYPEC_PORT_CACHE_MAX_PDOS * sizeof(*pdo));
+
+    ret = libtypec_get_pdos_view(conn_num, 1, src_snk, 0, &arena, &view);
+    if (ret < 0)
+        return ret;
+
+    *num = view.num;
+
+    return 0;
+}
+
+/**
+ * This function shall be used to bring a connector cache up to date with
+ * the fewest commands. Connector status is always read, then only the data
+ * whose change bits are set is fetched again:
+ * SupportedProviderCapabilitiesChange refreshes partner PDOs,
+ * SupportedCAMChange refreshes alternate modes and the current CAM, and a
+ * partner or connect change refreshes everything about the partner, taking
+ * PDOs and alternate modes of a known partner from the profile cache.
+ * Change bits are also synthesized from status diffs since not every
+ * backend reports them. An invalid cache is filled completely.
+ *
+ * \param conn_num connector number
+ * \param cache Cache to update, zeroed before its first use
+ *
+ * \returns LIBTYPEC_REFRESH_* mask of what was fetched, negative on failure
+ */
+int libtypec_refresh_port(int conn_num, struct libtypec_port_cache *cache)
+{
+    struct libtypec_connector_status sts;
+    struct libtypec_profile profile;
+    int ret, done = LIBTYPEC_REFRESH_STATUS;
+
+    ret = libtypec_get_connector_status(conn_num, &sts);
+    if (ret < 0)
+        return ret;
+
+    if (cache->valid)
+        cache->changed.raw_conn_stschang = libtypec_status_diff(&cache->status, &sts);
+    else
+        cache->changed.raw_conn_stschang = 0xffff;
+
+    cache->status = sts;
+    cache->valid = 1;
+
+    if (!sts.ConnectStatus)
+    {
+        /* Nothing to fetch without a partner */
+        cache->partner_id_valid = 0;
+        cache->num_partner_src_pdos = 0;
+        cache->num_partner_snk_pdos = 0;
+        cache->num_partner_altmodes = 0;
+        return done;
+    }
+
+    if (cache->changed.ConnectChange || cache->changed.ConnectorPartnerChanged)
+    {
+        cache->changed.SupportedProviderCapabilitiesChange = 1;
+        cache->changed.SupportedCAMChange = 1;
+
+        cache->partner_id_valid = libtypec_get_pd_message(AM_SOP, conn_num, sizeof(cache->partner_id),
+                                                          DISCOVER_ID_REQ, cache->partner_id.buf_disc_id) >= 0;
+        done |= LIBTYPEC_REFRESH_IDENTITY;
+
+        /* A known partner is described by its cached profile */
+        ret = libtypec_get_profile(AM_SOP, conn_num, cache->partner_id_valid ? &cache->partner_id : NULL, &profile);
+        cache->num_partner_src_pdos = profile.num_src_pdos < LIBTYPEC_MAX_PDOS ? profile.num_src_pdos : LIBTYPEC_MAX_PDOS;
+        memcpy(cache->partner_src_pdo, profile.src_pdo, cache->num_partner_src_pdos * sizeof(profile.src_pdo[0]));
+        cache->num_partner_snk_pdos = profile.num_snk_pdos < LIBTYPEC_MAX_PDOS ? profile.num_snk_pdos : LIBTYPEC_MAX_PDOS;
+        memcpy(cache->partner_snk_pdo, profile.snk_pdo, cache->num_partner_snk_pdos * sizeof(profile.snk_pdo[0]));
+        cache->num_partner_altmodes = profile.num_altmodes < LIBTYPEC_PORT_CACHE_MAX_ALTMODES ?
+                                      profile.num_altmodes : LIBTYPEC_PORT_CACHE_MAX_ALTMODES;
+        memcpy(cache->partner_altmode, profile.altmode, cache->num_partner_altmodes * sizeof(profile.altmode[0]));
+        done |= LIBTYPEC_REFRESH_PDOS | LIBTYPEC_REFRESH_ALTMODES;
+        if (ret > 0)
+            done |= LIBTYPEC_REFRESH_PROFILE;
+    }
+
+    if (cache->changed.SupportedProviderCapabilitiesChange && !(done & LIBTYPEC_REFRESH_PDOS))
+    {
+        if (refresh_partner_pdos(conn_num, 1, cache->partner_src_pdo, &cache->num_partner_src_pdos) < 0)
+            cache->num_partner_src_pdos = 0;
+        if (refresh_partner_pdos(conn_num, 0, cache->partner_snk_pdo, &cache->num_partner_snk_pdos) < 0)
+            cache->num_partner_snk_pdos = 0;
+        done |= LIBTYPEC_REFRESH_PDOS;
+    }
+
+    if (cache->changed.SupportedCAMChange)
+    {
+        struct libtypec_arena arena;
+        struct libtypec_altmode_view view;
+
+        if (!(done & LIBTYPEC_REFRESH_ALTMODES))
+        {
+            /* Keep the first modes if the partner has more than the cache holds */
+            libtypec_arena_init(&arena, cache->partner_altmode, sizeof(cache->partner_altmode));
+            ret = libtypec_get_alternate_modes_view(AM_SOP, conn_num, &arena, &view);
+            cache->num_partner_altmodes = ret >= 0 || ret == -ENOSPC ? view.num : 0;
+        }
+
+        if (libtypec_get_current_cam(conn_num, &cache->cur_cam) < 0)
+            memset(&cache->cur_cam, 0, sizeof(cache->cur_cam));
+        done |= LIBTYPEC_REFRESH_ALTMODES | LIBTYPEC_REFRESH_CUR_CAM;
+    }
+
+    return done;
+}
+
+/**
+ * This function shall be used from a notification callback to get the
+ * connector and status details of the event being delivered
+ *
+ * \param info Filled with the event details
+ *
+ * \returns 0 on success, -ENOENT when not called from a callback
+ */
+int libtypec_get_event_info(struct libtypec_event_info *info)
+{
+    if (!cur_event_info)
+        return -ENOENT;
+
+    *info = *cur_event_info;
+
+    return 0;
+}
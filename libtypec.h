@@ -35,6 +35,7 @@ SOFTWARE.
 #define LIBTYPEC_H
 
 #include <stdint.h>
+#include <stddef.h>
 #include "libtypec_config.h"
 
 union optionalfeature {
@@ -167,6 +168,38 @@ struct altmode_data
 	uint32_t vdo;
 };
 
+/** SPR (7) plus EPR (6) PDOs a capabilities message can carry */
+#define LIBTYPEC_MAX_PDOS 13
+/** Modes libtypec_get_alternate_modes() stores at most */
+#define LIBTYPEC_MAX_ALTMODES_LEGACY 64
+
+/**
+ * Caller owned memory the *_view queries carve their results from. Set up
+ * once per scan with libtypec_arena_init(); libtypec never allocates for
+ * it and views stay valid until the arena is reset.
+ */
+struct libtypec_arena
+{
+    unsigned char *base;
+    size_t size;
+    size_t used;
+};
+
+struct libtypec_pdo_view
+{
+    const unsigned int *pdo;
+    int num;
+};
+
+struct libtypec_altmode_view
+{
+    const struct altmode_data *am;
+    /** Modes stored in the view */
+    int num;
+    /** Modes reported by the backend, more than num if the arena ran out */
+    int total;
+};
+
 union libtypec_discovered_identity
 {
 	char buf_disc_id[24];
@@ -447,6 +480,35 @@ union libtypec_pps_sink
     
 };
 
+union libtypec_epr_avs
+{
+	unsigned int epr_avs;
+	struct epr_avs_bits
+	{
+		unsigned pdp:8;
+		unsigned min_volt:8;
+		unsigned rsvd1:1;
+		unsigned max_volt:9;
+		unsigned peak_cur:2;
+		unsigned apdo_type:2;
+		unsigned type:2;
+	}obj_epr_avs;
+};
+
+union libtypec_spr_avs
+{
+	unsigned int spr_avs;
+	struct spr_avs_bits
+	{
+		unsigned max_cur_20v:10;
+		unsigned max_cur_15v:10;
+		unsigned rsvd1:6;
+		unsigned peak_cur:2;
+		unsigned apdo_type:2;
+		unsigned type:2;
+	}obj_spr_avs;
+};
+
 #define LIBTYPEC_VERSION_INDEX 0
 #define LIBTYPEC_KERNEL_INDEX 1
 #define LIBTYPEC_OS_INDEX 2
@@ -487,17 +549,633 @@ union libtypec_pps_sink
 #define PDO_VARIABLE 2
 #define PDO_AUGMENTED 3
 
+#define APDO_SPR_PPS 0
+#define APDO_EPR_AVS 1
+#define APDO_SPR_AVS 2
+
+enum libtypec_vdo_layout {
+    /** USB PD 2.0 */
+    LIBTYPEC_VDO_PD2P0_PARTNER_ID_HEADER=0,
+    LIBTYPEC_VDO_PD2P0_CABLE_ID_HEADER,
+    LIBTYPEC_VDO_PD2P0_CERT_STAT,
+    LIBTYPEC_VDO_PD2P0_PRODUCT,
+    LIBTYPEC_VDO_PD2P0_PASSIVE_CABLE,
+    LIBTYPEC_VDO_PD2P0_ACTIVE_CABLE,
+    LIBTYPEC_VDO_PD2P0_AMA,
+    LIBTYPEC_VDO_PD2P0_FIXED_SUPPLY_SRC,
+    LIBTYPEC_VDO_PD2P0_VARIABLE_SUPPLY_SRC,
+    LIBTYPEC_VDO_PD2P0_BATTERY_SUPPLY_SRC,
+    LIBTYPEC_VDO_PD2P0_FIXED_SUPPLY_SNK,
+    LIBTYPEC_VDO_PD2P0_VARIABLE_SUPPLY_SNK,
+    LIBTYPEC_VDO_PD2P0_BATTERY_SUPPLY_SNK,
+    /** USB PD 3.0 */
+    LIBTYPEC_VDO_PD3P0_PARTNER_ID_HEADER,
+    LIBTYPEC_VDO_PD3P0_CABLE_ID_HEADER,
+    LIBTYPEC_VDO_PD3P0_CERT_STAT,
+    LIBTYPEC_VDO_PD3P0_PRODUCT,
+    LIBTYPEC_VDO_PD3P0_PASSIVE_CABLE,
+    LIBTYPEC_VDO_PD3P0_ACTIVE_CABLE_VDO1,
+    LIBTYPEC_VDO_PD3P0_ACTIVE_CABLE_VDO2,
+    LIBTYPEC_VDO_PD3P0_AMA,
+    LIBTYPEC_VDO_PD3P0_VPD,
+    LIBTYPEC_VDO_PD3P0_UFP_VDO1,
+    LIBTYPEC_VDO_PD3P0_UFP_VDO2,
+    LIBTYPEC_VDO_PD3P0_DFP,
+    LIBTYPEC_VDO_PD3P0_FIXED_SUPPLY_SRC,
+    LIBTYPEC_VDO_PD3P0_VARIABLE_SUPPLY_SRC,
+    LIBTYPEC_VDO_PD3P0_BATTERY_SUPPLY_SRC,
+    LIBTYPEC_VDO_PD3P0_PPS_APDO_SRC,
+    LIBTYPEC_VDO_PD3P0_FIXED_SUPPLY_SNK,
+    LIBTYPEC_VDO_PD3P0_VARIABLE_SUPPLY_SNK,
+    LIBTYPEC_VDO_PD3P0_BATTERY_SUPPLY_SNK,
+    LIBTYPEC_VDO_PD3P0_PPS_APDO_SNK,
+    /** USB PD 3.1 */
+    LIBTYPEC_VDO_PD3P1_PARTNER_ID_HEADER,
+    LIBTYPEC_VDO_PD3P1_CABLE_ID_HEADER,
+    LIBTYPEC_VDO_PD3P1_CERT_STAT,
+    LIBTYPEC_VDO_PD3P1_PRODUCT,
+    LIBTYPEC_VDO_PD3P1_PASSIVE_CABLE,
+    LIBTYPEC_VDO_PD3P1_ACTIVE_CABLE_VDO1,
+    LIBTYPEC_VDO_PD3P1_ACTIVE_CABLE_VDO2,
+    LIBTYPEC_VDO_PD3P1_VPD,
+    LIBTYPEC_VDO_PD3P1_UFP,
+    LIBTYPEC_VDO_PD3P1_DFP,
+    LIBTYPEC_VDO_PD3P1_FIXED_SUPPLY_SRC,
+    LIBTYPEC_VDO_PD3P1_VARIABLE_SUPPLY_SRC,
+    LIBTYPEC_VDO_PD3P1_BATTERY_SUPPLY_SRC,
+    LIBTYPEC_VDO_PD3P1_PPS_APDO_SRC,
+    LIBTYPEC_VDO_PD3P1_FIXED_SUPPLY_SNK,
+    LIBTYPEC_VDO_PD3P1_VARIABLE_SUPPLY_SNK,
+    LIBTYPEC_VDO_PD3P1_BATTERY_SUPPLY_SNK,
+    LIBTYPEC_VDO_PD3P1_PPS_APDO_SNK,
+    /** Alternate modes */
+    LIBTYPEC_VDO_DP_ALT_MODE_PARTNER,
+    LIBTYPEC_VDO_DP_ALT_MODE_ACTIVE_CABLE,
+    LIBTYPEC_VDO_TBT3_SOP,
+    LIBTYPEC_VDO_TBT3_SOP_PR,
+    LIBTYPEC_VDO_LAYOUT_COUNT
+};
+
+#define LIBTYPEC_VDO_MAX_FIELDS 16
+
+enum libtypec_pdo_kind {
+    LIBTYPEC_PDO_KIND_FIXED=0,
+    LIBTYPEC_PDO_KIND_BATTERY,
+    LIBTYPEC_PDO_KIND_VARIABLE,
+    LIBTYPEC_PDO_KIND_SPR_PPS,
+    LIBTYPEC_PDO_KIND_EPR_AVS,
+    LIBTYPEC_PDO_KIND_SPR_AVS,
+    LIBTYPEC_PDO_KIND_RESERVED,
+};
+
+/**
+ * Structure-of-arrays output of libtypec_decode_pdos(). Every array must
+ * hold as many entries as PDOs are decoded. Values not carried by a PDO
+ * kind are 0, e.g. max_ma of a battery PDO. flags holds the capability bits
+ * above the value fields: bits 29..20 of fixed PDOs, PPS Power Limited,
+ * and the AVS peak current.
+ */
+struct libtypec_pdo_soa {
+    uint8_t *kind;
+    uint32_t *min_mv;
+    uint32_t *max_mv;
+    uint32_t *max_ma;
+    uint32_t *max_mw;
+    uint32_t *flags;
+};
+
+#define LIBTYPEC_ID_HDR_MODAL (1 << 0)
+#define LIBTYPEC_ID_HDR_USB_DEVICE (1 << 1)
+#define LIBTYPEC_ID_HDR_USB_HOST (1 << 2)
+
+/** Structure-of-arrays output of libtypec_decode_id_headers() */
+struct libtypec_id_header_soa {
+    uint16_t *vid;
+    uint8_t *ufp_type;
+    uint8_t *dfp_type;
+    uint8_t *flags;
+};
+
+/** The field holds a USB-IF vendor ID */
+#define LIBTYPEC_VDO_FIELD_VID (1 << 0)
+
+/**
+ * One decoded field of a VDO or PDO. All strings point to static tables of
+ * the library.
+ */
+struct libtypec_vdo_field {
+    const char *name;
+    /** Meaning of an enumerated field, NULL otherwise */
+    const char *desc;
+    /** Unit of value ("mV", "mA" or "mW"), NULL for unitless fields */
+    const char *unit;
+    uint32_t raw;
+    /** raw scaled to unit; equal to raw for unitless fields */
+    uint32_t value;
+    unsigned char name_len;
+    unsigned char flags;
+};
+
 enum usb_typec_event {
     USBC_DEVICE_CONNECTED,
     USBC_DEVICE_DISCONNECTED,
+    /** Events below map to union connectorstatuschange bits */
+    USBC_EXT_SUPPLY_CHANGED,
+    USBC_POWER_OPMODE_CHANGED,
+    USBC_ATTENTION,
+    USBC_PROVIDER_CAPS_CHANGED,
+    USBC_POWER_LEVEL_CHANGED,
+    USBC_PD_RESET_COMPLETE,
+    USBC_CAM_CHANGED,
+    USBC_BATTERY_STATUS_CHANGED,
+    USBC_PARTNER_CHANGED,
+    USBC_POWER_DIRECTION_CHANGED,
+    USBC_SINK_PATH_CHANGED,
+    USBC_CONNECTOR_ERROR,
+    /** A libtypec_alert_add() condition became true or cleared */
+    USBC_ALERT,
+    USBC_ALERT_CLEARED,
     USBC_EVENT_COUNT
 };
+
+/**
+ * Details of the event being delivered, see libtypec_get_event_info()
+ */
+struct libtypec_event_info {
+    /** Connector the event belongs to, -1 if unknown */
+    int conn_num;
+    /** Change bits reported by the PPM or synthesized from status diffs */
+    union connectorstatuschange changed;
+    /** Connector status the event was derived from, if status_valid */
+    struct libtypec_connector_status status;
+    int status_valid;
+    /** For USBC_ALERT and USBC_ALERT_CLEARED: alert ID and metric value */
+    int alert_id;
+    int alert_value;
+};
+
+enum libtypec_alert_metric {
+    /** Operating power of the RDO of the contract, from connector status */
+    LIBTYPEC_ALERT_CONTRACT_OP_MW=0,
+    /** Maximum power of the RDO of the contract, from connector status */
+    LIBTYPEC_ALERT_CONTRACT_MAX_MW,
+    /** PowerOperationMode of connector status */
+    LIBTYPEC_ALERT_POWER_OP_MODE,
+    /** VBUS voltage of telemetry samples */
+    LIBTYPEC_ALERT_VBUS_MV,
+    /** VBUS current of telemetry samples */
+    LIBTYPEC_ALERT_VBUS_MA,
+    /** VBUS power of telemetry samples */
+    LIBTYPEC_ALERT_VBUS_MW,
+    LIBTYPEC_ALERT_METRIC_COUNT
+};
+
+enum libtypec_alert_cmp {
+    LIBTYPEC_ALERT_BELOW=0,
+    LIBTYPEC_ALERT_ABOVE,
+    LIBTYPEC_ALERT_EQUAL,
+    LIBTYPEC_ALERT_NOT_EQUAL,
+};
+
+/**
+ * Threshold subscription for libtypec_alert_add(). A BELOW alert fires when
+ * the metric drops under threshold and clears once it is back at
+ * threshold + hysteresis or more; ABOVE alerts mirror that.
+ */
+struct libtypec_alert {
+    /** Connector to watch, -1 for every connector */
+    int conn_num;
+    enum libtypec_alert_metric metric;
+    enum libtypec_alert_cmp cmp;
+    int threshold;
+    int hysteresis;
+};
+
+#define LIBTYPEC_PORT_CACHE_MAX_PDOS 16
+#define LIBTYPEC_PORT_CACHE_MAX_ALTMODES 32
+
+#define LIBTYPEC_REFRESH_STATUS (1 << 0)
+#define LIBTYPEC_REFRESH_PDOS (1 << 1)
+#define LIBTYPEC_REFRESH_ALTMODES (1 << 2)
+#define LIBTYPEC_REFRESH_IDENTITY (1 << 3)
+#define LIBTYPEC_REFRESH_CUR_CAM (1 << 4)
+/** Partner PDOs and alternate modes came from the profile cache */
+#define LIBTYPEC_REFRESH_PROFILE (1 << 5)
+
+/**
+ * Per connector state kept up to date by libtypec_refresh_port(). Zero it
+ * before the first refresh.
+ */
+struct libtypec_port_cache {
+    int valid;
+    struct libtypec_connector_status status;
+    union libtypec_discovered_identity partner_id;
+    int partner_id_valid;
+    unsigned int partner_src_pdo[LIBTYPEC_PORT_CACHE_MAX_PDOS];
+    int num_partner_src_pdos;
+    unsigned int partner_snk_pdo[LIBTYPEC_PORT_CACHE_MAX_PDOS];
+    int num_partner_snk_pdos;
+    struct altmode_data partner_altmode[LIBTYPEC_PORT_CACHE_MAX_ALTMODES];
+    int num_partner_altmodes;
+    struct libtypec_current_cam cur_cam;
+    /** Change bits that drove the last refresh */
+    union connectorstatuschange changed;
+};
+
+#define LIBTYPEC_SNAPSHOT_MAX_PORTS 16
+#define LIBTYPEC_SNAPSHOT_MAX_ALTMODES 32
+
+/** PDO lists of a port snapshot */
+enum libtypec_snapshot_pdo_list {
+    LIBTYPEC_SNAP_PORT_SRC=0,
+    LIBTYPEC_SNAP_PORT_SNK,
+    LIBTYPEC_SNAP_PARTNER_SRC,
+    LIBTYPEC_SNAP_PARTNER_SNK,
+    LIBTYPEC_SNAP_PDO_LISTS,
+};
+
+/** Alternate mode lists of a port snapshot */
+enum libtypec_snapshot_am_list {
+    LIBTYPEC_SNAP_AM_PORT=0,
+    LIBTYPEC_SNAP_AM_PARTNER,
+    LIBTYPEC_SNAP_AM_CABLE,
+    LIBTYPEC_SNAP_AM_LISTS,
+};
+
+#define LIBTYPEC_SNAP_VALID_CAP (1 << 0)
+#define LIBTYPEC_SNAP_VALID_STATUS (1 << 1)
+#define LIBTYPEC_SNAP_VALID_CABLE (1 << 2)
+#define LIBTYPEC_SNAP_VALID_PARTNER_ID (1 << 3)
+#define LIBTYPEC_SNAP_VALID_CABLE_ID (1 << 4)
+
+/**
+ * Everything known about one connector at one point in time, filled by
+ * libtypec_snapshot_port(). valid tells which of the single objects could
+ * be read; lists that could not be read are empty.
+ */
+struct libtypec_port_snapshot {
+    uint32_t conn_num;
+    uint32_t valid;
+    struct libtypec_connector_cap_data cap;
+    struct libtypec_connector_status status;
+    struct libtypec_cable_property cable;
+    union libtypec_discovered_identity partner_id;
+    union libtypec_discovered_identity cable_id;
+    uint32_t num_pdos[LIBTYPEC_SNAP_PDO_LISTS];
+    uint32_t pdo[LIBTYPEC_SNAP_PDO_LISTS][LIBTYPEC_MAX_PDOS];
+    uint32_t num_altmodes[LIBTYPEC_SNAP_AM_LISTS];
+    struct altmode_data altmode[LIBTYPEC_SNAP_AM_LISTS][LIBTYPEC_SNAPSHOT_MAX_ALTMODES];
+};
+
+struct libtypec_snapshot {
+    /** CLOCK_REALTIME time the snapshot was started */
+    uint64_t ts_ns;
+    struct libtypec_capability_data ppm;
+    uint32_t num_ports;
+    struct libtypec_port_snapshot port[LIBTYPEC_SNAPSHOT_MAX_PORTS];
+};
+
+/*
+ * Binary snapshot encoding: a header followed by num_records records. Each
+ * record starts on an 8 byte boundary with a struct libtypec_snapshot_rec
+ * and carries the object it names in host byte order and libtypec.h
+ * layout, so a mapped file can be walked with libtypec_snapshot_next() and
+ * its payloads cast in place. Unknown record types are to be skipped.
+ */
+#define LIBTYPEC_SNAPSHOT_MAGIC "TCSN"
+#define LIBTYPEC_SNAPSHOT_VERSION 1
+#define LIBTYPEC_SNAPSHOT_ALIGN 8
+
+enum libtypec_snapshot_rec_type {
+    /** struct libtypec_capability_data */
+    LIBTYPEC_SNAP_REC_PPM=1,
+    /** struct libtypec_connector_cap_data */
+    LIBTYPEC_SNAP_REC_PORT_CAP,
+    /** struct libtypec_connector_status */
+    LIBTYPEC_SNAP_REC_PORT_STATUS,
+    /** struct libtypec_cable_property */
+    LIBTYPEC_SNAP_REC_CABLE,
+    /** union libtypec_discovered_identity */
+    LIBTYPEC_SNAP_REC_PARTNER_ID,
+    /** union libtypec_discovered_identity */
+    LIBTYPEC_SNAP_REC_CABLE_ID,
+    /** uint32_t[], list is an enum libtypec_snapshot_pdo_list */
+    LIBTYPEC_SNAP_REC_PDOS,
+    /** struct altmode_data[], list is an enum libtypec_snapshot_am_list */
+    LIBTYPEC_SNAP_REC_ALTMODES,
+};
+
+struct libtypec_snapshot_hdr {
+    char magic[4];
+    uint16_t version;
+    /** Offset of the first record */
+    uint16_t hdr_size;
+    /** Size of the whole encoding */
+    uint32_t total_len;
+    uint32_t num_records;
+    uint64_t ts_ns;
+};
+
+struct libtypec_snapshot_rec {
+    uint16_t type;
+    uint8_t port;
+    uint8_t list;
+    /** Payload size, without the padding up to the next record */
+    uint32_t len;
+};
+
+/** Field of a struct libtypec_capability_data */
+enum libtypec_field_ppm {
+    LIBTYPEC_FIELD_PPM_ATTRIBUTES=0,
+    LIBTYPEC_FIELD_PPM_NUM_CONNECTORS,
+    LIBTYPEC_FIELD_PPM_OPTIONAL_FEATURES,
+    LIBTYPEC_FIELD_PPM_NUM_ALT_MODES,
+    LIBTYPEC_FIELD_PPM_BC_VERSION,
+    LIBTYPEC_FIELD_PPM_PD_VERSION,
+    LIBTYPEC_FIELD_PPM_TYPEC_VERSION,
+    LIBTYPEC_FIELD_PPM_COUNT
+};
+
+/** Field of a struct libtypec_connector_cap_data */
+enum libtypec_field_cap {
+    LIBTYPEC_FIELD_CAP_OPERATION_MODE=0,
+    LIBTYPEC_FIELD_CAP_PROVIDER,
+    LIBTYPEC_FIELD_CAP_CONSUMER,
+    LIBTYPEC_FIELD_CAP_SWAP_TO_DFP,
+    LIBTYPEC_FIELD_CAP_SWAP_TO_UFP,
+    LIBTYPEC_FIELD_CAP_SWAP_TO_SRC,
+    LIBTYPEC_FIELD_CAP_SWAP_TO_SNK,
+    LIBTYPEC_FIELD_CAP_EXTENDED_OPERATION_MODE,
+    LIBTYPEC_FIELD_CAP_MISCELLANEOUS,
+    LIBTYPEC_FIELD_CAP_REVERSE_CURRENT_PROTECTION,
+    LIBTYPEC_FIELD_CAP_PARTNER_PD_REV,
+    LIBTYPEC_FIELD_CAP_COUNT
+};
+
+/** Field of a struct libtypec_connector_status */
+enum libtypec_field_status {
+    LIBTYPEC_FIELD_STATUS_CHANGE=0,
+    LIBTYPEC_FIELD_STATUS_POWER_OPERATION_MODE,
+    LIBTYPEC_FIELD_STATUS_CONNECT,
+    LIBTYPEC_FIELD_STATUS_POWER_DIRECTION,
+    LIBTYPEC_FIELD_STATUS_PARTNER_FLAGS,
+    LIBTYPEC_FIELD_STATUS_PARTNER_TYPE,
+    LIBTYPEC_FIELD_STATUS_RDO,
+    LIBTYPEC_FIELD_STATUS_BATTERY_CHARGING,
+    LIBTYPEC_FIELD_STATUS_LIMITED_REASON,
+    LIBTYPEC_FIELD_STATUS_PD_VERSION,
+    LIBTYPEC_FIELD_STATUS_ORIENTATION,
+    LIBTYPEC_FIELD_STATUS_SINK_PATH,
+    LIBTYPEC_FIELD_STATUS_REVERSE_CURRENT_PROTECTION,
+    LIBTYPEC_FIELD_STATUS_POWER_READING_READY,
+    LIBTYPEC_FIELD_STATUS_CURRENT_SCALE,
+    LIBTYPEC_FIELD_STATUS_PEAK_CURRENT,
+    LIBTYPEC_FIELD_STATUS_AVERAGE_CURRENT,
+    LIBTYPEC_FIELD_STATUS_VOLTAGE_SCALE,
+    LIBTYPEC_FIELD_STATUS_VOLTAGE_READING,
+    LIBTYPEC_FIELD_STATUS_COUNT
+};
+
+/** Field of a struct libtypec_cable_property */
+enum libtypec_field_cable {
+    LIBTYPEC_FIELD_CABLE_SPEED=0,
+    LIBTYPEC_FIELD_CABLE_CURRENT,
+    LIBTYPEC_FIELD_CABLE_VBUS_SUPPORT,
+    LIBTYPEC_FIELD_CABLE_TYPE,
+    LIBTYPEC_FIELD_CABLE_DIRECTIONALITY,
+    LIBTYPEC_FIELD_CABLE_PLUG_END_TYPE,
+    LIBTYPEC_FIELD_CABLE_MODE_SUPPORT,
+    LIBTYPEC_FIELD_CABLE_PD_REVISION,
+    LIBTYPEC_FIELD_CABLE_LATENCY,
+    LIBTYPEC_FIELD_CABLE_COUNT
+};
+
+/** Field of a union libtypec_discovered_identity */
+enum libtypec_field_id {
+    LIBTYPEC_FIELD_ID_CERT_STAT=0,
+    LIBTYPEC_FIELD_ID_HEADER,
+    LIBTYPEC_FIELD_ID_PRODUCT,
+    LIBTYPEC_FIELD_ID_PRODUCT_TYPE_VDO1,
+    LIBTYPEC_FIELD_ID_PRODUCT_TYPE_VDO2,
+    LIBTYPEC_FIELD_ID_PRODUCT_TYPE_VDO3,
+    LIBTYPEC_FIELD_ID_COUNT
+};
+
+/** The object appeared (new_value 1) or went away (new_value 0) */
+#define LIBTYPEC_FIELD_PRESENT 0xff
+
+/**
+ * One difference found by libtypec_snapshot_diff(). object is the
+ * LIBTYPEC_SNAP_REC_* type of the changed object and field one of its
+ * LIBTYPEC_FIELD_* values. For PDO and alternate mode lists field is the
+ * index in the list and the values are the raw PDO, or svid << 32 | vdo,
+ * with 0 for entries past the end of the list. Objects that went away
+ * compare as all zero, so one that appears is reported as
+ * LIBTYPEC_FIELD_PRESENT followed by its non zero fields.
+ */
+struct libtypec_snapshot_change {
+    uint8_t port;
+    uint8_t object;
+    /** enum libtypec_snapshot_pdo_list or _am_list for list objects */
+    uint8_t list;
+    uint8_t field;
+    uint32_t reserved;
+    uint64_t old_value;
+    uint64_t new_value;
+};
 enum libtypec_backend {
     LIBTYPEC_BACKEND_SYSFS=0,
     LIBTYPEC_BACKEND_DBGFS,
     /*LIBTYPEC_BACKEND_I2C,*/ /*Potential backend interface*/
 };
 
+enum libtypec_cmd_arbitration {
+    /** Per command flock() lease on the PPM command channel */
+    LIBTYPEC_CMD_ARB_LEASE=0,
+    /** Forward commands to the process running libtypec_run_cmd_broker() */
+    LIBTYPEC_CMD_ARB_BROKER,
+};
+
+enum libtypec_async_op {
+    LIBTYPEC_ASYNC_CONNECTOR_RESET=0,
+    LIBTYPEC_ASYNC_GET_CAPABILITY,
+    LIBTYPEC_ASYNC_GET_CONN_CAPABILITY,
+    LIBTYPEC_ASYNC_GET_ALTERNATE_MODES,
+    LIBTYPEC_ASYNC_GET_CURRENT_CAM,
+    LIBTYPEC_ASYNC_GET_PDOS,
+    LIBTYPEC_ASYNC_GET_CABLE_PROPERTIES,
+    LIBTYPEC_ASYNC_GET_CONNECTOR_STATUS,
+    LIBTYPEC_ASYNC_SET_UOR,
+    LIBTYPEC_ASYNC_SET_PDR,
+    LIBTYPEC_ASYNC_SET_CCOM,
+    LIBTYPEC_ASYNC_GET_LPM_PPM_INFO,
+    LIBTYPEC_ASYNC_GET_ERROR_STATUS,
+    LIBTYPEC_ASYNC_SET_NEW_CAM,
+    LIBTYPEC_ASYNC_GET_CAM_CS,
+    /** arg[0] = recipient, buf = struct libtypec_profile */
+    LIBTYPEC_ASYNC_READ_PROFILE,
+    LIBTYPEC_ASYNC_OP_COUNT
+};
+
+enum libtypec_async_prio {
+    /** Set and reset ops run as control, everything else as query */
+    LIBTYPEC_ASYNC_PRIO_DEFAULT=0,
+    LIBTYPEC_ASYNC_PRIO_CONTROL,
+    LIBTYPEC_ASYNC_PRIO_QUERY,
+    /** Rate limited periodic polling */
+    LIBTYPEC_ASYNC_PRIO_BACKGROUND,
+};
+
+struct libtypec_async_sched {
+    /** Background commands per second, 0 for no limit */
+    unsigned int bg_rate;
+    /** Background commands allowed back to back */
+    unsigned int bg_burst;
+    /** A waiting query overtakes control requests after this long, 0 never */
+    unsigned int query_age_ms;
+    /** A waiting background request overtakes the others after this long, 0 never */
+    unsigned int bg_age_ms;
+};
+
+struct libtypec_async_req;
+
+typedef void (*libtypec_async_cb_t)(struct libtypec_async_req *req, void *data);
+
+/**
+ * Request for libtypec_async_submit(). Arguments follow the synchronous API
+ * of the op, e.g. GET_PDOS takes arg[] = { partner, offset, src_snk, type }.
+ */
+struct libtypec_async_req {
+    enum libtypec_async_op op;
+    enum libtypec_async_prio prio;
+    int conn_num;
+    int arg[4];
+    /** Result structure for query ops */
+    void *buf;
+    /** Completion status, the return value of the synchronous API */
+    int ret;
+    /** Secondary result, num_pdo for GET_PDOS */
+    int out;
+    libtypec_async_cb_t cb;
+    void *cb_data;
+    /** Owned by the engine while queued */
+    struct libtypec_async_req *next;
+    uint64_t queued_ns;
+};
+
+enum libtypec_event_source {
+    /** Kernel uevents when udevd is not running, udev otherwise */
+    LIBTYPEC_EVENT_SRC_AUTO=0,
+    /** udevd rebroadcast "udev" netlink group */
+    LIBTYPEC_EVENT_SRC_UDEV,
+    /** Raw NETLINK_KOBJECT_UEVENT kernel group with an in-kernel filter */
+    LIBTYPEC_EVENT_SRC_KERNEL,
+};
+
+#define LIBTYPEC_TELEMETRY_RING 4096
+#define LIBTYPEC_TELEMETRY_MAX_PORTS 32
+
+/**
+ * One VBUS reading. Currents are positive in the direction reported by the
+ * PPM or power supply; peak_ma is 0 when the source has no peak reading.
+ */
+struct libtypec_power_sample {
+    /** CLOCK_MONOTONIC time of the reading */
+    uint64_t ts_ns;
+    int voltage_mv;
+    int current_ma;
+    int peak_ma;
+    /** A partner is attached */
+    unsigned char connected;
+    /** The connector provides VBUS, otherwise it consumes it */
+    unsigned char sourcing;
+};
+
+/**
+ * Statistics over a window of telemetry samples. Percentiles are taken from
+ * a histogram and are accurate to 1/256 of the max_mw - min_mw range.
+ */
+struct libtypec_power_stats {
+    unsigned int count;
+    uint64_t first_ns;
+    uint64_t last_ns;
+    int min_mv, max_mv, mean_mv;
+    int min_ma, max_ma, mean_ma;
+    int min_mw, max_mw, mean_mw;
+    int p50_mw, p90_mw, p99_mw;
+};
+
+#define LIBTYPEC_ENERGY_STATE_FILE "/var/lib/libtypec/energy"
+
+/** Cumulative energy in microjoules, 3.6e9 uJ per Wh */
+struct libtypec_energy {
+    uint64_t delivered_uj;
+    uint64_t received_uj;
+};
+
+#define LIBTYPEC_JOURNAL_FILE "/var/lib/libtypec/journal"
+#define LIBTYPEC_JOURNAL_SIZE (1024 * 1024)
+
+/**
+ * One event read back from the journal. Connector state is kept as the
+ * LIBTYPEC_FIELD_STATUS_* fields of struct libtypec_connector_status,
+ * without the change bits and VBUS readings.
+ */
+struct libtypec_journal_entry {
+    /** CLOCK_REALTIME time of the event, to the microsecond */
+    uint64_t ts_ns;
+    /** Connector, -1 if the event named none */
+    int conn_num;
+    /** enum usb_typec_event */
+    int event;
+    /** Bits (1 << LIBTYPEC_FIELD_STATUS_*) of the fields the event changed */
+    uint32_t changed;
+    /** Bits of the fields value holds, from this or earlier entries */
+    uint32_t known;
+    uint32_t value[LIBTYPEC_FIELD_STATUS_COUNT];
+    /** For USBC_ALERT and USBC_ALERT_CLEARED */
+    int alert_id;
+    int alert_value;
+};
+
+/** Called for every entry of a query, a non zero return stops the query */
+typedef int (*libtypec_journal_cb_t)(const struct libtypec_journal_entry *entry, void *data);
+
+#define LIBTYPEC_PROFILE_FILE "/var/lib/libtypec/profiles"
+#define LIBTYPEC_PROFILE_SLOTS 64
+#define LIBTYPEC_PROFILE_MAX_ALTMODES LIBTYPEC_SNAPSHOT_MAX_ALTMODES
+/** A cached profile is checked against the device at most this often */
+#define LIBTYPEC_PROFILE_VERIFY_S 60
+/** Without the async engine a cached profile is used for this long */
+#define LIBTYPEC_PROFILE_MAX_AGE_S (24 * 3600)
+
+#define LIBTYPEC_PROFILE_VALID_SRC (1 << 0)
+#define LIBTYPEC_PROFILE_VALID_SNK (1 << 1)
+#define LIBTYPEC_PROFILE_VALID_ALTMODES (1 << 2)
+#define LIBTYPEC_PROFILE_VALID_CABLE (1 << 3)
+
+/**
+ * What a partner (AM_SOP) or cable (AM_SOP_PR) reports besides its
+ * identity: PDOs for partners, cable properties for cables, and alternate
+ * modes. Profiles are cached under their Discover Identity response, see
+ * libtypec_get_profile().
+ */
+struct libtypec_profile {
+    uint32_t recipient;
+    /** LIBTYPEC_PROFILE_VALID_* bits of what could be read */
+    uint32_t valid;
+    union libtypec_discovered_identity id;
+    /** CLOCK_REALTIME time the profile was last read from the device */
+    uint64_t verified_ns;
+    uint32_t num_src_pdos;
+    uint32_t num_snk_pdos;
+    uint32_t src_pdo[LIBTYPEC_MAX_PDOS];
+    uint32_t snk_pdo[LIBTYPEC_MAX_PDOS];
+    struct libtypec_cable_property cable;
+    uint32_t num_altmodes;
+    struct altmode_data altmode[LIBTYPEC_PROFILE_MAX_ALTMODES];
+};
+
 typedef void (*usb_typec_callback_t)(enum usb_typec_event event, void* data);
 
 typedef struct libtypec_notification_list{
@@ -525,6 +1203,13 @@ int libtypec_get_cable_properties(int conn_num, struct libtypec_cable_property *
 int libtypec_get_connector_status(int conn_num, struct libtypec_connector_status *conn_sts);
 int libtypec_get_pd_message(int recipient, int conn_num, int num_bytes, int resp_type, char *pd_msg_resp);
 
+void libtypec_arena_init(struct libtypec_arena *arena, void *buf, size_t size);
+void libtypec_arena_reset(struct libtypec_arena *arena);
+int libtypec_get_pdos_view(int conn_num, int partner, int src_snk, int type,
+                           struct libtypec_arena *arena, struct libtypec_pdo_view *view);
+int libtypec_get_alternate_modes_view(int recipient, int conn_num,
+                                      struct libtypec_arena *arena, struct libtypec_altmode_view *view);
+
 int libtypec_get_bb_status(unsigned int *num_bb_instance);
 int libtypec_get_bb_data(int num_billboards,char* bb_data);
 int libtypec_set_uor(unsigned char conn_num, unsigned char uor);
@@ -535,8 +1220,59 @@ int libtypec_get_error_status(unsigned char conn_num, struct libtypec_get_error_
 int libtypec_set_new_cam(unsigned char conn_num, unsigned char entry_exit, unsigned char new_cam, unsigned int am_spec);
 int libtypec_get_cam_cs(unsigned char conn_num, unsigned char cam, struct libtypec_get_cam_cs *cam_cs);
 
+int libtypec_set_cmd_arbitration(enum libtypec_cmd_arbitration mode, unsigned int max_wait_ms);
+int libtypec_run_cmd_broker(void);
+int libtypec_set_cmd_timeout(unsigned int timeout_ms);
+int libtypec_cancel(void);
+
+int libtypec_async_start(void);
+int libtypec_async_stop(void);
+int libtypec_async_submit(struct libtypec_async_req *req);
+int libtypec_async_get_fd(void);
+int libtypec_async_reap(struct libtypec_async_req **done, int max);
+int libtypec_async_set_sched(const struct libtypec_async_sched *sched);
+
 int libtypec_register_typec_notification_callback(enum usb_typec_event event, usb_typec_callback_t cb, void* data);
 int libtypec_unregister_typec_notification_callback(enum usb_typec_event event, usb_typec_callback_t cb);
 void libtypec_monitor_events(void);
+int libtypec_set_event_source(enum libtypec_event_source src);
+int libtypec_get_event_info(struct libtypec_event_info *info);
+int libtypec_refresh_port(int conn_num, struct libtypec_port_cache *cache);
+
+int libtypec_get_power_sample(int conn_num, struct libtypec_power_sample *sample);
+int libtypec_telemetry_start(unsigned int conn_mask, unsigned int period_us);
+int libtypec_telemetry_stop(void);
+int libtypec_telemetry_stats(int conn_num, unsigned int window_ms, struct libtypec_power_stats *stats);
+int libtypec_alert_add(const struct libtypec_alert *alert);
+int libtypec_alert_remove(int alert_id);
+int libtypec_energy_open(const char *path, int account);
+int libtypec_energy_close(void);
+int libtypec_energy_get_port(int conn_num, struct libtypec_energy *energy);
+int libtypec_energy_get_partner(unsigned short vid, unsigned short pid, struct libtypec_energy *energy);
+int libtypec_decode_vdo(enum libtypec_vdo_layout layout, uint32_t vdo, struct libtypec_vdo_field *field, int max);
+int libtypec_decode_pdos(const uint32_t *pdo, size_t num, const struct libtypec_pdo_soa *out);
+int libtypec_decode_id_headers(const uint32_t *vdo, size_t num, const struct libtypec_id_header_soa *out);
+int libtypec_snapshot_port(int conn_num, struct libtypec_port_snapshot *port);
+int libtypec_snapshot_take(struct libtypec_snapshot *snap);
+int libtypec_snapshot_encode(const struct libtypec_snapshot *snap, void *buf, size_t len);
+const struct libtypec_snapshot_rec *libtypec_snapshot_next(const void *buf, size_t len,
+                                                           const struct libtypec_snapshot_rec *rec);
+int libtypec_snapshot_port_diff(const struct libtypec_port_snapshot *prev, const struct libtypec_port_snapshot *cur,
+                                struct libtypec_snapshot_change *out, int max);
+int libtypec_snapshot_diff(const struct libtypec_snapshot *prev, const struct libtypec_snapshot *cur,
+                           struct libtypec_snapshot_change *out, int max);
+const char *libtypec_snapshot_field_name(int object, int field);
+int libtypec_journal_open(const char *path, size_t size);
+int libtypec_journal_close(void);
+int libtypec_journal_query(const char *path, uint64_t from_ns, uint64_t to_ns,
+                           libtypec_journal_cb_t cb, void *data);
+int libtypec_profile_open(const char *path);
+int libtypec_profile_close(void);
+int libtypec_profile_lookup(int recipient, const union libtypec_discovered_identity *id,
+                            struct libtypec_profile *profile);
+int libtypec_profile_store(const struct libtypec_profile *profile);
+int libtypec_profile_read(int recipient, int conn_num, struct libtypec_profile *profile);
+int libtypec_get_profile(int recipient, int conn_num, const union libtypec_discovered_identity *id,
+                         struct libtypec_profile *profile);
 
 #endif /*LIBTYPEC_H*/
@@ -0,0 +1,219 @@
+/*
+MIT License
+
+Copyright (c) 2022 Rajaram Regupathy <rajaram.regupathy@gmail.com>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+// SPDX-License-Identifier: MIT
+/**
+ * @file libtypec_alert.c
+ * @author Rajaram Regupathy <rajaram.regupathy@gmail.com>
+ * @brief Threshold alerts on connector status and power telemetry
+ *
+ * Alerts are evaluated on every connector status the library sees, whether
+ * read by libtypec_get_connector_status() or delivered by the event monitor,
+ * and on every telemetry sample. Each alert keeps a fired bit per connector
+ * so it notifies once on entry and once on exit of its condition.
+ */
+
+#include "libtypec.h"
+#include "libtypec_ops.h"
+#include <string.h>
+#include <errno.h>
+#include <pthread.h>
+
+#define ALERT_MAX 64
+#define ALERT_MAX_PORTS 64
+
+struct alert_slot {
+	int used;
+	struct libtypec_alert a;
+	/* connectors on which the condition currently holds */
+	uint64_t fired;
+};
+
+struct alert_fire {
+	int id;
+	int conn_num;
+	int value;
+	int raised;
+};
+
+static pthread_mutex_t alert_lock = PTHREAD_MUTEX_INITIALIZER;
+static struct alert_slot alerts[ALERT_MAX];
+
+/**
+ * This function shall be used to subscribe to a threshold condition. The
+ * alert is delivered as USBC_ALERT when the condition starts to hold and
+ * USBC_ALERT_CLEARED when it stops; libtypec_get_event_info() gives the
+ * connector, alert ID and metric value.
+ *
+ * \param alert Condition to watch
+ *
+ * \returns alert ID on success, -ENOSPC when all slots are in use
+ */
+int libtypec_alert_add(const struct libtypec_alert *alert)
+{
+	int i;
+
+	if (alert->metric >= LIBTYPEC_ALERT_METRIC_COUNT || alert->cmp > LIBTYPEC_ALERT_NOT_EQUAL ||
+	    alert->hysteresis < 0 || alert->conn_num < -1 || alert->conn_num >= ALERT_MAX_PORTS)
+		return -EINVAL;
+
+	pthread_mutex_lock(&alert_lock);
+	for (i = 0; i < ALERT_MAX; i++)
+	{
+		if (!alerts[i].used)
+		{
+			alerts[i].used = 1;
+			alerts[i].a = *alert;
+			alerts[i].fired = 0;
+			break;
+		}
+	}
+	pthread_mutex_unlock(&alert_lock);
+
+	return i < ALERT_MAX ? i : -ENOSPC;
+}
+
+/**
+ * This function shall be used to remove an alert subscription
+ *
+ * \param alert_id ID returned by libtypec_alert_add()
+ *
+ * \returns 0 on success
+ */
+int libtypec_alert_remove(int alert_id)
+{
+	if (alert_id < 0 || alert_id >= ALERT_MAX)
+		return -EINVAL;
+
+	pthread_mutex_lock(&alert_lock);
+	alerts[alert_id].used = 0;
+	pthread_mutex_unlock(&alert_lock);
+
+	return 0;
+}
+
+static int alert_holds(const struct libtypec_alert *a, int value, int fired)
+{
+	switch (a->cmp)
+	{
+	case LIBTYPEC_ALERT_BELOW:
+		return fired ? value < a->threshold + a->hysteresis : value < a->threshold;
+	case LIBTYPEC_ALERT_ABOVE:
+		return fired ? value > a->threshold - a->hysteresis : value > a->threshold;
+	case LIBTYPEC_ALERT_EQUAL:
+		return value == a->threshold;
+	default:
+		return value != a->threshold;
+	}
+}
+
+/*
+ * Evaluate the alerts on the metrics in values[] whose bit is set in valid.
+ * A connector without a partner re-arms its alerts without notifying.
+ */
+static void alert_eval(int conn_num, const int *values, unsigned int valid, int connected,
+		       const struct libtypec_connector_status *sts)
+{
+	struct alert_fire fire[ALERT_MAX];
+	struct libtypec_event_info info;
+	int i, n = 0;
+
+	if (conn_num < 0 || conn_num >= ALERT_MAX_PORTS)
+		return;
+
+	pthread_mutex_lock(&alert_lock);
+	for (i = 0; i < ALERT_MAX; i++)
+	{
+		struct alert_slot *slot = &alerts[i];
+		uint64_t bit = 1ull << conn_num;
+		int fired, holds;
+
+		if (!slot->used || !(valid & (1u << slot->a.metric)))
+			continue;
+		if (slot->a.conn_num != -1 && slot->a.conn_num != conn_num)
+			continue;
+
+		fired = !!(slot->fired & bit);
+
+		if (!connected)
+		{
+			slot->fired &= ~bit;
+			continue;
+		}
+
+		holds = alert_holds(&slot->a, values[slot->a.metric], fired);
+		if (holds == fired)
+			continue;
+
+		slot->fired ^= bit;
+		fire[n].id = i;
+		fire[n].conn_num = conn_num;
+		fire[n].value = values[slot->a.metric];
+		fire[n].raised = holds;
+		n++;
+	}
+	pthread_mutex_unlock(&alert_lock);
+
+	/* Callbacks run unlocked so they can add or remove alerts */
+	for (i = 0; i < n; i++)
+	{
+		memset(&info, 0, sizeof(info));
+		info.conn_num = fire[i].conn_num;
+		info.alert_id = fire[i].id;
+		info.alert_value = fire[i].value;
+		if (sts)
+		{
+			info.status = *sts;
+			info.status_valid = 1;
+		}
+		libtypec_notify(fire[i].raised ? USBC_ALERT : USBC_ALERT_CLEARED, &info);
+	}
+}
+
+void libtypec_alert_eval_status(int conn_num, const struct libtypec_connector_status *sts)
+{
+	int values[LIBTYPEC_ALERT_METRIC_COUNT];
+
+	values[LIBTYPEC_ALERT_CONTRACT_OP_MW] = ((sts->RequestDataObject >> 10) & 0x3ff) * 250;
+	values[LIBTYPEC_ALERT_CONTRACT_MAX_MW] = (sts->RequestDataObject & 0x3ff) * 250;
+	values[LIBTYPEC_ALERT_POWER_OP_MODE] = sts->PowerOperationMode;
+
+	alert_eval(conn_num, values,
+		   1u << LIBTYPEC_ALERT_CONTRACT_OP_MW | 1u << LIBTYPEC_ALERT_CONTRACT_MAX_MW |
+		   1u << LIBTYPEC_ALERT_POWER_OP_MODE,
+		   sts->ConnectStatus, sts);
+}
+
+void libtypec_alert_eval_sample(int conn_num, const struct libtypec_power_sample *sample)
+{
+	int values[LIBTYPEC_ALERT_METRIC_COUNT];
+
+	values[LIBTYPEC_ALERT_VBUS_MV] = sample->voltage_mv;
+	values[LIBTYPEC_ALERT_VBUS_MA] = sample->current_ma;
+	values[LIBTYPEC_ALERT_VBUS_MW] = (int)(((long long)sample->voltage_mv * sample->current_ma) / 1000);
+
+	alert_eval(conn_num, values,
+		   1u << LIBTYPEC_ALERT_VBUS_MV | 1u << LIBTYPEC_ALERT_VBUS_MA | 1u << LIBTYPEC_ALERT_VBUS_MW,
+		   sample->connected, NULL);
+}
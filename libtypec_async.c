@@ -0,0 +1,598 @@
+/*
+MIT License
+
+Copyright (c) 2022 Rajaram Regupathy <rajaram.regupathy@gmail.com>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+// SPDX-License-Identifier: MIT
+/**
+ * @file libtypec_async.c
+ * @author Rajaram Regupathy <rajaram.regupathy@gmail.com>
+ * @brief Asynchronous command engine for libtypec
+ *
+ * Requests are queued on the engine of the current session (one PPM) and
+ * executed by a single worker thread, so the PPM channel sees one command at
+ * a time while callers never block on it.
+ *
+ * The engine keeps one FIFO per priority class. Control requests run before
+ * queries and queries before background polls, background traffic is rate
+ * limited, and a request that has waited longer than the aging bound of its
+ * class is served ahead of higher classes so nothing starves.
+ */
+
+#include "libtypec.h"
+#include "libtypec_ops.h"
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <time.h>
+#include <sys/eventfd.h>
+
+#define ASYNC_NR_CLASSES 3
+#define ASYNC_BG_RATE 20		/* background commands per second */
+#define ASYNC_BG_BURST 4
+#define ASYNC_QUERY_AGE_MS 250
+#define ASYNC_BG_AGE_MS 1000
+
+struct async_queue {
+	struct libtypec_async_req *head;
+	struct libtypec_async_req *tail;
+};
+
+struct libtypec_async_engine {
+	pthread_mutex_t lock;
+	pthread_cond_t cond;
+	pthread_t worker;
+	int running;
+	int efd;
+	/* pending requests, one FIFO per priority class */
+	struct async_queue q[ASYNC_NR_CLASSES];
+	struct libtypec_async_sched sched;
+	/* theoretical arrival time of the next background command (GCRA) */
+	uint64_t bg_tat_ns;
+	/* completed requests without a callback, waiting to be reaped */
+	struct libtypec_async_req *done_head;
+	struct libtypec_async_req *done_tail;
+};
+
+static struct libtypec_async_engine async_eng = {
+	.lock = PTHREAD_MUTEX_INITIALIZER,
+	.cond = PTHREAD_COND_INITIALIZER,
+	.efd = -1,
+	.sched = {
+		.bg_rate = ASYNC_BG_RATE,
+		.bg_burst = ASYNC_BG_BURST,
+		.query_age_ms = ASYNC_QUERY_AGE_MS,
+		.bg_age_ms = ASYNC_BG_AGE_MS,
+	},
+};
+
+static uint64_t async_now_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/* Queue index of a request, 0 being the most urgent */
+static int async_class(const struct libtypec_async_req *req)
+{
+	if (req->prio != LIBTYPEC_ASYNC_PRIO_DEFAULT)
+		return req->prio - LIBTYPEC_ASYNC_PRIO_CONTROL;
+
+	switch (req->op)
+	{
+	case LIBTYPEC_ASYNC_CONNECTOR_RESET:
+	case LIBTYPEC_ASYNC_SET_UOR:
+	case LIBTYPEC_ASYNC_SET_PDR:
+	case LIBTYPEC_ASYNC_SET_CCOM:
+	case LIBTYPEC_ASYNC_SET_NEW_CAM:
+		return LIBTYPEC_ASYNC_PRIO_CONTROL - LIBTYPEC_ASYNC_PRIO_CONTROL;
+	default:
+		return LIBTYPEC_ASYNC_PRIO_QUERY - LIBTYPEC_ASYNC_PRIO_CONTROL;
+	}
+}
+
+static void async_append(struct libtypec_async_req **head, struct libtypec_async_req **tail,
+			 struct libtypec_async_req *req)
+{
+	req->next = NULL;
+	if (*tail)
+		(*tail)->next = req;
+	else
+		*head = req;
+	*tail = req;
+}
+
+static struct libtypec_async_req *async_pop(int cls)
+{
+	struct async_queue *q = &async_eng.q[cls];
+	struct libtypec_async_req *req = q->head;
+
+	q->head = req->next;
+	if (!q->head)
+		q->tail = NULL;
+
+	return req;
+}
+
+/*
+ * Pick the next request to run, called with the engine lock held. When only
+ * rate limited background requests are pending, *wait_ns is set to the time
+ * until the next one becomes eligible.
+ */
+static struct libtypec_async_req *async_pick(uint64_t now, uint64_t *wait_ns)
+{
+	const int bg = LIBTYPEC_ASYNC_PRIO_BACKGROUND - LIBTYPEC_ASYNC_PRIO_CONTROL;
+	uint64_t age_ns[ASYNC_NR_CLASSES] = {
+		0,
+		async_eng.sched.query_age_ms * 1000000ULL,
+		async_eng.sched.bg_age_ms * 1000000ULL,
+	};
+	uint64_t interval = 0, bg_at = now;
+	int cls, pick = -1;
+
+	*wait_ns = 0;
+
+	if (async_eng.sched.bg_rate)
+	{
+		uint64_t slack;
+
+		interval = 1000000000ULL / async_eng.sched.bg_rate;
+		slack = interval * (async_eng.sched.bg_burst ? async_eng.sched.bg_burst - 1 : 0);
+		if (async_eng.bg_tat_ns > now + slack)
+			bg_at = async_eng.bg_tat_ns - slack;
+	}
+
+	/* Aged requests first, oldest wins */
+	for (cls = 1; cls < ASYNC_NR_CLASSES; cls++)
+	{
+		struct libtypec_async_req *head = async_eng.q[cls].head;
+
+		if (!head || now - head->queued_ns < age_ns[cls] || (cls == bg && bg_at > now))
+			continue;
+		if (pick < 0 || head->queued_ns < async_eng.q[pick].head->queued_ns)
+			pick = cls;
+	}
+
+	for (cls = 0; pick < 0 && cls < ASYNC_NR_CLASSES; cls++)
+	{
+		if (!async_eng.q[cls].head)
+			continue;
+		if (cls == bg && bg_at > now)
+			*wait_ns = bg_at - now;
+		else
+			pick = cls;
+	}
+
+	if (pick < 0)
+		return NULL;
+
+	if (pick == bg && interval)
+		async_eng.bg_tat_ns = (async_eng.bg_tat_ns > now ? async_eng.bg_tat_ns : now) + interval;
+
+	return async_pop(pick);
+}
+
+static int async_exec(struct libtypec_async_req *req)
+{
+	switch (req->op)
+	{
+	case LIBTYPEC_ASYNC_CONNECTOR_RESET:
+		return libtypec_connector_reset(req->conn_num, req->arg[0]);
+	case LIBTYPEC_ASYNC_GET_CAPABILITY:
+		return libtypec_get_capability(req->buf);
+	case LIBTYPEC_ASYNC_GET_CONN_CAPABILITY:
+		return libtypec_get_conn_capability(req->conn_num, req->buf);
+	case LIBTYPEC_ASYNC_GET_ALTERNATE_MODES:
+		return libtypec_get_alternate_modes(req->arg[0], req->conn_num, req->buf);
+	case LIBTYPEC_ASYNC_GET_CURRENT_CAM:
+		return libtypec_get_current_cam(req->conn_num, req->buf);
+	case LIBTYPEC_ASYNC_GET_PDOS:
+		return libtypec_get_pdos(req->conn_num, req->arg[0], req->arg[1], &req->out,
+					 req->arg[2], req->arg[3], req->buf);
+	case LIBTYPEC_ASYNC_GET_CABLE_PROPERTIES:
+		return libtypec_get_cable_properties(req->conn_num, req->buf);
+	case LIBTYPEC_ASYNC_GET_CONNECTOR_STATUS:
+		return libtypec_get_connector_status(req->conn_num, req->buf);
+	case LIBTYPEC_ASYNC_SET_UOR:
+		return libtypec_set_uor(req->conn_num, req->arg[0]);
+	case LIBTYPEC_ASYNC_SET_PDR:
+		return libtypec_set_pdr(req->conn_num, req->arg[0]);
+	case LIBTYPEC_ASYNC_SET_CCOM:
+		return libtypec_set_ccom(req->conn_num, req->arg[0]);
+	case LIBTYPEC_ASYNC_GET_LPM_PPM_INFO:
+		return libtypec_get_lpm_ppm_info(req->conn_num, req->buf);
+	case LIBTYPEC_ASYNC_GET_ERROR_STATUS:
+		return libtypec_get_error_status(req->conn_num, req->buf);
+	case LIBTYPEC_ASYNC_SET_NEW_CAM:
+		return libtypec_set_new_cam(req->conn_num, req->arg[0], req->arg[1], req->arg[2]);
+	case LIBTYPEC_ASYNC_GET_CAM_CS:
+		return libtypec_get_cam_cs(req->conn_num, req->arg[0], req->buf);
+	case LIBTYPEC_ASYNC_READ_PROFILE:
+		return libtypec_profile_read(req->arg[0], req->conn_num, req->buf);
+	case LIBTYPEC_ASYNC_CALL:
+	{
+		const struct libtypec_async_call *call = req->buf;
+
+		return call->fn(call->arg);
+	}
+	default:
+		return -EINVAL;
+	}
+}
+
+/* Make the completion fd readable, called with the engine lock held */
+static void async_kick(void)
+{
+	uint64_t one = 1;
+
+	/* EAGAIN: the counter is saturated, the fd is readable anyway */
+	while (async_eng.efd >= 0 && write(async_eng.efd, &one, sizeof(one)) < 0 && errno == EINTR)
+		;
+}
+
+/* Called without the engine lock held */
+static void async_complete(struct libtypec_async_req *req)
+{
+	if (req->cb)
+	{
+		req->cb(req, req->cb_data);
+		return;
+	}
+
+	pthread_mutex_lock(&async_eng.lock);
+	async_append(&async_eng.done_head, &async_eng.done_tail, req);
+	async_kick();
+	pthread_mutex_unlock(&async_eng.lock);
+}
+
+static void *async_worker(void *arg)
+{
+	struct libtypec_async_req *req;
+	uint64_t wait_ns;
+
+	pthread_mutex_lock(&async_eng.lock);
+
+	while (async_eng.running)
+	{
+		req = async_pick(async_now_ns(), &wait_ns);
+
+		if (!req)
+		{
+			if (wait_ns)
+			{
+				struct timespec ts;
+				uint64_t until = async_now_ns() + wait_ns;
+
+				ts.tv_sec = until / 1000000000ULL;
+				ts.tv_nsec = until % 1000000000ULL;
+				pthread_cond_timedwait(&async_eng.cond, &async_eng.lock, &ts);
+			}
+			else
+				pthread_cond_wait(&async_eng.cond, &async_eng.lock);
+			continue;
+		}
+
+		pthread_mutex_unlock(&async_eng.lock);
+
+		req->ret = async_exec(req);
+		async_complete(req);
+
+		pthread_mutex_lock(&async_eng.lock);
+	}
+
+	pthread_mutex_unlock(&async_eng.lock);
+
+	return NULL;
+}
+
+/**
+ * This function starts the asynchronous command engine of the current
+ * session. libtypec_init() must have been called.
+ *
+ * \returns 0 on success, negative error code on failure
+ */
+int libtypec_async_start(void)
+{
+	pthread_condattr_t attr;
+	int ret = 0;
+
+	pthread_mutex_lock(&async_eng.lock);
+
+	if (async_eng.running)
+		goto out;
+
+	/* Background rate limiting and aging use timed waits on the monotonic clock */
+	pthread_condattr_init(&attr);
+	pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+	pthread_cond_destroy(&async_eng.cond);
+	pthread_cond_init(&async_eng.cond, &attr);
+	pthread_condattr_destroy(&attr);
+	async_eng.bg_tat_ns = 0;
+
+	async_eng.efd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+	if (async_eng.efd < 0)
+	{
+		ret = -errno;
+		goto out;
+	}
+
+	async_eng.running = 1;
+	/* Left over from before a stop */
+	if (async_eng.done_head)
+		async_kick();
+
+	ret = -pthread_create(&async_eng.worker, NULL, async_worker, NULL);
+	if (ret)
+	{
+		async_eng.running = 0;
+		close(async_eng.efd);
+		async_eng.efd = -1;
+	}
+
+out:
+	pthread_mutex_unlock(&async_eng.lock);
+
+	return ret;
+}
+
+/**
+ * This function stops the asynchronous command engine. It waits for the
+ * command in flight, queued requests complete with -ECANCELED. Requests
+ * without a callback, cancelled or completed and not yet reaped, stay on
+ * the completion list for libtypec_async_reap(); the completion fd is
+ * closed.
+ *
+ * \returns 0 on success
+ */
+int libtypec_async_stop(void)
+{
+	struct libtypec_async_req *pending = NULL, **link = &pending;
+	int cls;
+
+	pthread_mutex_lock(&async_eng.lock);
+
+	if (!async_eng.running)
+	{
+		pthread_mutex_unlock(&async_eng.lock);
+		return 0;
+	}
+
+	async_eng.running = 0;
+	for (cls = 0; cls < ASYNC_NR_CLASSES; cls++)
+	{
+		*link = async_eng.q[cls].head;
+		if (async_eng.q[cls].tail)
+			link = &async_eng.q[cls].tail->next;
+		async_eng.q[cls].head = async_eng.q[cls].tail = NULL;
+	}
+	pthread_cond_broadcast(&async_eng.cond);
+
+	pthread_mutex_unlock(&async_eng.lock);
+
+	pthread_join(async_eng.worker, NULL);
+
+	while (pending)
+	{
+		struct libtypec_async_req *next = pending->next;
+
+		pending->ret = -ECANCELED;
+		async_complete(pending);
+		pending = next;
+	}
+
+	pthread_mutex_lock(&async_eng.lock);
+	close(async_eng.efd);
+	async_eng.efd = -1;
+	pthread_mutex_unlock(&async_eng.lock);
+
+	return 0;
+}
+
+/* Queue a request of any op, including the internal LIBTYPEC_ASYNC_CALL */
+static int async_submit(struct libtypec_async_req *req)
+{
+	int cls;
+
+	if (req->prio < 0 || req->prio > LIBTYPEC_ASYNC_PRIO_BACKGROUND)
+		return -EINVAL;
+
+	pthread_mutex_lock(&async_eng.lock);
+
+	if (!async_eng.running)
+	{
+		pthread_mutex_unlock(&async_eng.lock);
+		return -EIO;
+	}
+
+	req->ret = -EINPROGRESS;
+	req->queued_ns = async_now_ns();
+	cls = async_class(req);
+	async_append(&async_eng.q[cls].head, &async_eng.q[cls].tail, req);
+	pthread_cond_signal(&async_eng.cond);
+
+	pthread_mutex_unlock(&async_eng.lock);
+
+	return 0;
+}
+
+/**
+ * This function queues a request on the asynchronous command engine. The
+ * request is owned by the engine until it completes and must stay valid
+ * until then.
+ *
+ * On completion req->ret holds what the synchronous API would have returned.
+ * If req->cb is set it is called from the engine thread, otherwise the
+ * request is added to the completion list and the fd returned by
+ * libtypec_async_get_fd() becomes readable.
+ *
+ * req->prio selects the scheduling class. LIBTYPEC_ASYNC_PRIO_DEFAULT runs
+ * set and reset ops as control and everything else as query, periodic
+ * polling should use LIBTYPEC_ASYNC_PRIO_BACKGROUND.
+ *
+ * \param req Request to queue
+ *
+ * \returns 0 on success, -EINVAL for an unknown op, -EIO if the engine is
+ * not running
+ */
+int libtypec_async_submit(struct libtypec_async_req *req)
+{
+	if (!req || req->op < 0 || req->op >= LIBTYPEC_ASYNC_OP_COUNT)
+		return -EINVAL;
+
+	return async_submit(req);
+}
+
+/**
+ * This function returns an fd that is readable while completed requests are
+ * waiting to be reaped. It can be added to poll/epoll sets.
+ *
+ * \returns fd on success, -EIO if the engine is not running
+ */
+int libtypec_async_get_fd(void)
+{
+	return async_eng.efd >= 0 ? async_eng.efd : -EIO;
+}
+
+/**
+ * This function collects completed requests that have no callback
+ *
+ * \param done Array receiving the completed requests
+ * \param max Size of the done array
+ *
+ * \returns Number of requests stored in done
+ */
+int libtypec_async_reap(struct libtypec_async_req **done, int max)
+{
+	uint64_t cnt;
+	int n = 0;
+
+	pthread_mutex_lock(&async_eng.lock);
+
+	/* EAGAIN: nothing was signalled since the last reap */
+	while (async_eng.efd >= 0 && read(async_eng.efd, &cnt, sizeof(cnt)) < 0 && errno == EINTR)
+		;
+
+	while (n < max && async_eng.done_head)
+	{
+		done[n++] = async_eng.done_head;
+		async_eng.done_head = async_eng.done_head->next;
+	}
+	if (!async_eng.done_head)
+		async_eng.done_tail = NULL;
+
+	/* Keep the fd readable for what is left */
+	if (async_eng.done_head)
+		async_kick();
+
+	pthread_mutex_unlock(&async_eng.lock);
+
+	return n;
+}
+
+/**
+ * This function tunes the scheduler of the asynchronous command engine
+ *
+ * \param sched Background rate limit and per class aging bounds. A bg_rate
+ * of 0 disables rate limiting, an aging bound of 0 disables aging for that
+ * class.
+ *
+ * \returns 0 on success, -EINVAL on invalid parameters
+ */
+int libtypec_async_set_sched(const struct libtypec_async_sched *sched)
+{
+	if (!sched)
+		return -EINVAL;
+
+	pthread_mutex_lock(&async_eng.lock);
+	async_eng.sched = *sched;
+	if (!async_eng.sched.query_age_ms)
+		async_eng.sched.query_age_ms = UINT32_MAX;
+	if (!async_eng.sched.bg_age_ms)
+		async_eng.sched.bg_age_ms = UINT32_MAX;
+	pthread_cond_signal(&async_eng.cond);
+	pthread_mutex_unlock(&async_eng.lock);
+
+	return 0;
+}
+
+struct async_sync_wait {
+	pthread_mutex_t lock;
+	pthread_cond_t cond;
+	int done;
+};
+
+static void async_sync_cb(struct libtypec_async_req *req, void *data)
+{
+	struct async_sync_wait *w = data;
+
+	pthread_mutex_lock(&w->lock);
+	w->done = 1;
+	pthread_cond_signal(&w->cond);
+	pthread_mutex_unlock(&w->lock);
+}
+
+/*
+ * Run a request through the scheduler and wait for it. Used by the
+ * synchronous APIs so operator actions, queries and polling are ordered by
+ * class instead of racing the engine for the channel.
+ *
+ * Returns 1 with *ret set if the request was executed by the engine, 0 if
+ * the caller should run it directly (engine stopped, or called from the
+ * engine thread itself).
+ */
+int libtypec_async_route(struct libtypec_async_req *req, int *ret)
+{
+	struct async_sync_wait w = {
+		.lock = PTHREAD_MUTEX_INITIALIZER,
+		.cond = PTHREAD_COND_INITIALIZER,
+	};
+	pthread_t worker;
+	int running;
+
+	pthread_mutex_lock(&async_eng.lock);
+	running = async_eng.running;
+	worker = async_eng.worker;
+	pthread_mutex_unlock(&async_eng.lock);
+
+	if (!running || pthread_equal(pthread_self(), worker))
+		return 0;
+
+	req->cb = async_sync_cb;
+	req->cb_data = &w;
+
+	if (async_submit(req) < 0)
+		return 0;
+
+	pthread_mutex_lock(&w.lock);
+	while (!w.done)
+		pthread_cond_wait(&w.cond, &w.lock);
+	pthread_mutex_unlock(&w.lock);
+
+	*ret = req->ret;
+
+	return 1;
+}
@@ -30,6 +30,11 @@ SOFTWARE.
  * @brief Functions for libtypec debugfs based operations
  */
 
+/**
+ *  required for accept4() used by the command broker.
+ */
+#define _GNU_SOURCE
+
 #include "libtypec_ops.h"
 #include <dirent.h>
 #include <stdio.h>
@@ -43,26 +48,156 @@ SOFTWARE.
 #include <fcntl.h>
 #include <unistd.h>
 #include <poll.h>
+#include <time.h>
+#include <sched.h>
+#include <pthread.h>
+#include <sys/file.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/eventfd.h>
+#include <stdint.h>
+
+#define UCSI_LEASE_WAIT_MS 1000	/* default bound on waiting for the channel */
+#define UCSI_LEASE_BACKOFF_MAX_US 1000
+#define UCSI_LEASE_HANDOFF_US 2000	/* yield window after release when others wait */
+#define UCSI_LEASE_WAIT_FMT "/dev/shm/libtypec-ucsi-%lx"
+#define UCSI_BROKER_SOCK "/run/libtypec-ucsi.sock"
+#define UCSI_BROKER_MAX_CLIENTS 16
+#define UCSI_CMD_LEN 64
+#define UCSI_CMD_TIMEOUT_MS 2000	/* default per-command response deadline */
+#define UCSI_POLL_MIN_MS 100		/* status poll interval right after a change */
+#define UCSI_POLL_MAX_MS 2000		/* status poll interval once ports are idle */
+#define UCSI_MAX_CONNECTORS 127
+#define UCSI_COPY_LEN(len, obj) ((size_t)(len) < sizeof(obj) ? (size_t)(len) : sizeof(obj))
 
 int fp_command;
 int fp_response;
 struct pollfd  pfds;
 
+/*
+ * The debugfs command/response pair is a single channel per PPM, so every
+ * command is executed under a lease: a process-wide mutex for threads plus
+ * an flock() on the command file for other processes. A process waiting for
+ * the lease holds a shared OFD lock on a side file, so a busy holder sees it
+ * and yields between commands instead of re-grabbing the lease ahead of
+ * everyone else. The kernel drops the lock of a waiter that dies.
+ */
+struct ucsi_broker_req {
+	char cmd[UCSI_CMD_LEN];
+};
+
+struct ucsi_broker_rsp {
+	int ret;
+	unsigned char data[UCSI_CMD_LEN];
+};
+
+static pthread_mutex_t ucsi_lock;
+static pthread_once_t ucsi_lock_once = PTHREAD_ONCE_INIT;
+static int ucsi_lease_depth;
+static unsigned int ucsi_lease_wait_ms = UCSI_LEASE_WAIT_MS;
+static struct timespec ucsi_lease_released;
+static int ucsi_waiters_fd = -1;
+static int ucsi_arb_mode = LIBTYPEC_CMD_ARB_LEASE;
+static int ucsi_broker_fd = -1;
+static unsigned int ucsi_cmd_timeout_ms = UCSI_CMD_TIMEOUT_MS;
+
+/*
+ * Cancellation token: libtypec_cancel() bumps the generation and kicks the
+ * eventfd. A transaction records the generation when it takes the lease and
+ * fails with -ECANCELED as soon as it observes a newer one.
+ */
+static int ucsi_cancel_fd = -1;
+static unsigned int ucsi_cancel_gen;
+static unsigned int ucsi_txn_gen;
+
 int hexCharToInt(char c) {
     if (c >= '0' && c <= '9') return c - '0';
     if (c >= 'a' && c <= 'f') return c - 'a' + 10;
     if (c >= 'A' && c <= 'F') return c - 'A' + 10;
     return -1; // Invalid character
 }
-int get_ucsi_response(unsigned char *data) {
+static long ucsi_elapsed_us(const struct timespec *from)
+{
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+
+	return (now.tv_sec - from->tv_sec) * 1000000L + (now.tv_nsec - from->tv_nsec) / 1000;
+}
+
+static void ucsi_sleep_us(long us)
+{
+	struct timespec ts = { us / 1000000, (us % 1000000) * 1000 };
+
+	nanosleep(&ts, NULL);
+}
+
+static void ucsi_deadline(struct timespec *ts, unsigned int ms)
+{
+	clock_gettime(CLOCK_MONOTONIC, ts);
+	ts->tv_sec += ms / 1000;
+	ts->tv_nsec += (ms % 1000) * 1000000L;
+	if (ts->tv_nsec >= 1000000000L)
+	{
+		ts->tv_sec++;
+		ts->tv_nsec -= 1000000000L;
+	}
+}
+
+/*
+ * Wait for fd to become readable before the deadline. Returns 0 when
+ * readable, -ETIMEDOUT once the deadline passes and -ECANCELED if the
+ * current transaction was cancelled.
+ */
+static int ucsi_wait_fd(int fd, const struct timespec *deadline)
+{
+	struct pollfd wfds[2] = {
+		{ .fd = fd, .events = POLLIN },
+		{ .fd = ucsi_cancel_fd, .events = POLLIN },
+	};
+	int nfds = ucsi_cancel_fd >= 0 ? 2 : 1;
+
+	while (1)
+	{
+		long left_us;
+		uint64_t cnt;
+
+		if (__atomic_load_n(&ucsi_cancel_gen, __ATOMIC_ACQUIRE) != ucsi_txn_gen)
+			return -ECANCELED;
+
+		left_us = -ucsi_elapsed_us(deadline);
+		if (left_us <= 0)
+			return -ETIMEDOUT;
+
+		if (poll(wfds, nfds, (left_us + 999) / 1000) < 0)
+		{
+			if (errno == EINTR)
+				continue;
+			return -errno;
+		}
+
+		if (wfds[0].revents)
+			return 0;
+
+		/*
+		 * Drain the kick; the generation check above decides if it was
+		 * ours. EAGAIN means another waiter drained it first.
+		 */
+		if (nfds > 1 && wfds[1].revents &&
+		    read(ucsi_cancel_fd, &cnt, sizeof(cnt)) < 0 && errno != EAGAIN && errno != EINTR)
+			return -errno;
+	}
+}
+
+int get_ucsi_response(unsigned char *data, const struct timespec *deadline) {
     char c[64];
     unsigned char temp[64]; // Temporary buffer for reversal, assuming data will not exceed 64 bytes
     int i = 0, j = 0, result, dataIndex = 0;
 
     if (fp_response <= 0) return -1;
 
-    result = poll(&pfds, 1, -1);
-    if (result < 0) return -1;
+    result = ucsi_wait_fd(pfds.fd, deadline);
+    if (result < 0) return result;
 
     j = read(fp_response, c, 64);
     if (j <= 2) return -1; // Not enough data read or no data to process
@@ -128,6 +263,274 @@ int search_dbgfs_files(char *basePath, char *commandPath, char *responsePath) {
     closedir(dir);
     return -1;
 }
+
+static void ucsi_lock_init(void)
+{
+	pthread_mutexattr_t attr;
+
+	pthread_mutexattr_init(&attr);
+	pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+	pthread_mutex_init(&ucsi_lock, &attr);
+	pthread_mutexattr_destroy(&attr);
+}
+
+static void ucsi_lease_wait_open(void)
+{
+	struct stat sb;
+	char path[64];
+
+	if (ucsi_waiters_fd >= 0 || fstat(fp_command, &sb) < 0)
+		return;
+
+	snprintf(path, sizeof(path), UCSI_LEASE_WAIT_FMT, (unsigned long)sb.st_ino);
+
+	/* Read access is enough for a shared lock, any user can wait */
+	ucsi_waiters_fd = open(path, O_RDONLY | O_CREAT | O_CLOEXEC, 0644);
+}
+
+/* Announce (on) or withdraw a wait for the lease */
+static void ucsi_lease_waiting(int on)
+{
+	struct flock fl = {
+		.l_type = on ? F_RDLCK : F_UNLCK,
+		.l_whence = SEEK_SET,
+		.l_len = 1,
+	};
+
+	if (ucsi_waiters_fd >= 0)
+		fcntl(ucsi_waiters_fd, F_OFD_SETLK, &fl);
+}
+
+/* Whether another process is waiting for the lease */
+static int ucsi_lease_contended(void)
+{
+	struct flock fl = {
+		.l_type = F_WRLCK,
+		.l_whence = SEEK_SET,
+		.l_len = 1,
+	};
+
+	if (ucsi_waiters_fd < 0 || fcntl(ucsi_waiters_fd, F_OFD_GETLK, &fl) < 0)
+		return 0;
+
+	return fl.l_type != F_UNLCK;
+}
+
+/*
+ * Take the channel lease. Nested calls from the owning thread only bump the
+ * depth so a multi-command transaction (e.g. GET_PDOS offset walk) is not
+ * interleaved with commands from other processes.
+ *
+ * Returns 0 on success, -EBUSY if the lease could not be obtained within the
+ * configured wait bound, -ECANCELED if libtypec_cancel() was called while
+ * waiting. In broker mode no lease is taken; a lost broker connection is
+ * made again and its error returned if that fails.
+ */
+static int ucsi_broker_connect(void);
+
+static int ucsi_lease_acquire(void)
+{
+	struct timespec start, deadline;
+	long backoff_us = 50, wait_us = (long)ucsi_lease_wait_ms * 1000;
+	unsigned int gen = __atomic_load_n(&ucsi_cancel_gen, __ATOMIC_ACQUIRE);
+	int waiting = 0, ret = -EBUSY;
+
+	pthread_once(&ucsi_lock_once, ucsi_lock_init);
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	clock_gettime(CLOCK_REALTIME, &deadline);
+	deadline.tv_sec += ucsi_lease_wait_ms / 1000;
+	deadline.tv_nsec += (ucsi_lease_wait_ms % 1000) * 1000000L;
+	if (deadline.tv_nsec >= 1000000000L)
+	{
+		deadline.tv_sec++;
+		deadline.tv_nsec -= 1000000000L;
+	}
+
+	if (pthread_mutex_timedlock(&ucsi_lock, &deadline) != 0)
+		return -EBUSY;
+
+	if (ucsi_lease_depth++ > 0)
+		return 0;
+
+	/* Cancelled while queued behind another thread */
+	if (__atomic_load_n(&ucsi_cancel_gen, __ATOMIC_ACQUIRE) != gen)
+	{
+		ucsi_lease_depth--;
+		pthread_mutex_unlock(&ucsi_lock);
+		return -ECANCELED;
+	}
+	ucsi_txn_gen = gen;
+
+	if (ucsi_arb_mode == LIBTYPEC_CMD_ARB_BROKER)
+	{
+		/* Never fall back to the lease behind the broker's back */
+		if (ucsi_broker_fd < 0)
+		{
+			ret = ucsi_broker_connect();
+			if (ret < 0)
+			{
+				ucsi_lease_depth--;
+				pthread_mutex_unlock(&ucsi_lock);
+				return ret;
+			}
+			ucsi_broker_fd = ret;
+		}
+		return 0;
+	}
+
+	/* Give waiting processes a turn before taking the channel back */
+	if (ucsi_lease_contended())
+	{
+		long since = ucsi_elapsed_us(&ucsi_lease_released);
+
+		if (since < UCSI_LEASE_HANDOFF_US)
+			ucsi_sleep_us(UCSI_LEASE_HANDOFF_US - since);
+	}
+
+	while (flock(fp_command, LOCK_EX | LOCK_NB) < 0)
+	{
+		int err = errno;
+
+		if (__atomic_load_n(&ucsi_cancel_gen, __ATOMIC_ACQUIRE) != gen)
+			ret = -ECANCELED;
+
+		if (ret == -ECANCELED || (err != EWOULDBLOCK && err != EINTR) ||
+		    ucsi_elapsed_us(&start) >= wait_us)
+		{
+			if (waiting)
+				ucsi_lease_waiting(0);
+			ucsi_lease_depth--;
+			pthread_mutex_unlock(&ucsi_lock);
+			return ret;
+		}
+
+		/* A signal, not contention */
+		if (err == EINTR)
+			continue;
+
+		if (!waiting)
+			ucsi_lease_waiting(1);
+		waiting = 1;
+
+		ucsi_sleep_us(backoff_us);
+		if (backoff_us < UCSI_LEASE_BACKOFF_MAX_US)
+			backoff_us <<= 1;
+	}
+
+	if (waiting)
+		ucsi_lease_waiting(0);
+
+	return 0;
+}
+
+static void ucsi_lease_release(void)
+{
+	if (--ucsi_lease_depth == 0 && ucsi_arb_mode != LIBTYPEC_CMD_ARB_BROKER)
+	{
+		flock(fp_command, LOCK_UN);
+		clock_gettime(CLOCK_MONOTONIC, &ucsi_lease_released);
+	}
+
+	pthread_mutex_unlock(&ucsi_lock);
+}
+
+static int ucsi_broker_xfer(const void *cmd, size_t len, unsigned char *resp, size_t resp_len,
+			    const struct timespec *deadline)
+{
+	struct ucsi_broker_req req = {0};
+	struct ucsi_broker_rsp rsp;
+	int ret;
+
+	memcpy(req.cmd, cmd, len < sizeof(req.cmd) ? len : sizeof(req.cmd));
+
+	if (send(ucsi_broker_fd, &req, sizeof(req), MSG_NOSIGNAL) != sizeof(req))
+		return -EIO;
+
+	ret = ucsi_wait_fd(ucsi_broker_fd, deadline);
+	if (ret < 0)
+	{
+		/* The late response would desync the stream, the next command reconnects */
+		close(ucsi_broker_fd);
+		ucsi_broker_fd = -1;
+		return ret;
+	}
+
+	if (recv(ucsi_broker_fd, &rsp, sizeof(rsp), MSG_WAITALL) != sizeof(rsp) ||
+	    rsp.ret > (int)sizeof(rsp.data))
+		return -EIO;
+
+	if (rsp.ret > (int)resp_len)
+		rsp.ret = resp_len;
+	if (rsp.ret > 0)
+		memcpy(resp, rsp.data, rsp.ret);
+
+	return rsp.ret;
+}
+
+/*
+ * Execute one UCSI command over the debugfs channel: write the command and
+ * collect the response while holding the channel lease (or hand it to the
+ * broker when running as a broker client). resp holds resp_len bytes.
+ *
+ * Returns the response length, -EIO on a failed or short command write,
+ * -ETIMEDOUT if the PPM did not answer within the command timeout and
+ * -ECANCELED if the transaction was cancelled.
+ */
+static int ucsi_xfer(const void *cmd, size_t len, unsigned char *resp, size_t resp_len)
+{
+	struct timespec deadline;
+	int ret;
+
+	ret = ucsi_lease_acquire();
+	if (ret < 0)
+		return ret;
+
+	ucsi_deadline(&deadline, ucsi_cmd_timeout_ms);
+
+	if (ucsi_arb_mode == LIBTYPEC_CMD_ARB_BROKER)
+		ret = ucsi_broker_xfer(cmd, len, resp, resp_len, &deadline);
+	else
+	{
+		/* Drop anything left over from a timed out command */
+		lseek(fp_response, 0, SEEK_SET);
+
+		ret = write(fp_command, cmd, len);
+
+		if (ret < 0)
+			ret = errno == EINTR ? -ECANCELED : -EIO;
+		else if ((size_t)ret != len)
+			ret = -EIO;
+		else
+			ret = get_ucsi_response(resp, &deadline);
+	}
+
+	ucsi_lease_release();
+
+	return ret;
+}
+
+static int ucsi_broker_connect(void)
+{
+	struct sockaddr_un addr = { .sun_family = AF_UNIX };
+	int fd;
+
+	fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+	if (fd < 0)
+		return -errno;
+
+	strncpy(addr.sun_path, UCSI_BROKER_SOCK, sizeof(addr.sun_path) - 1);
+
+	if (connect(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0)
+	{
+		int err = -errno;
+
+		close(fd);
+		return err;
+	}
+
+	return fd;
+}
 static int libtypec_dbgfs_init(char **session_info)
 {
 
@@ -148,6 +551,11 @@ static int libtypec_dbgfs_init(char **session_info)
 
 		pfds.fd = fp_response;
 		pfds.events = POLLIN;
+
+		ucsi_lease_wait_open();
+
+		if (ucsi_cancel_fd < 0)
+			ucsi_cancel_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
 		
 		return 0;
 	}
@@ -181,11 +589,9 @@ static int libtypec_dbgfs_connector_reset_ops(int conn_num, int rst_type)
 		rstcmd.rst_type = rst_type;
 
 		snprintf(buf, sizeof(buf), "0x%x", rstcmd.rst_cmd);
-		ret = write(fp_command,buf,sizeof(buf));
-
-		if(ret)
+		ret = ucsi_xfer(buf, sizeof(buf), buf, sizeof(buf));
+		if(ret > 0)
 		{
-			ret = get_ucsi_response(buf);
 			if(ret < 16)
 				ret = -1;
 		}
@@ -195,6 +601,19 @@ static int libtypec_dbgfs_connector_reset_ops(int conn_num, int rst_type)
 
 static int libtypec_dbgfs_exit(void)
 {
+	if (ucsi_broker_fd >= 0)
+		close(ucsi_broker_fd);
+	if (ucsi_waiters_fd >= 0)
+		close(ucsi_waiters_fd);
+	ucsi_broker_fd = -1;
+	ucsi_waiters_fd = -1;
+	ucsi_arb_mode = LIBTYPEC_CMD_ARB_LEASE;
+	ucsi_cmd_timeout_ms = UCSI_CMD_TIMEOUT_MS;
+
+	if (ucsi_cancel_fd >= 0)
+		close(ucsi_cancel_fd);
+	ucsi_cancel_fd = -1;
+
 	close(fp_command);
 	close(fp_response);
     fp_command = -1;
@@ -202,6 +621,184 @@ static int libtypec_dbgfs_exit(void)
 	return 0;
 }
 
+static int libtypec_dbgfs_set_cmd_arbitration_ops(int mode, unsigned int max_wait_ms)
+{
+	int fd = -1;
+
+	if (mode != LIBTYPEC_CMD_ARB_LEASE && mode != LIBTYPEC_CMD_ARB_BROKER)
+		return -EINVAL;
+
+	if (mode == LIBTYPEC_CMD_ARB_BROKER)
+	{
+		fd = ucsi_broker_connect();
+		if (fd < 0)
+			return fd;
+	}
+
+	pthread_once(&ucsi_lock_once, ucsi_lock_init);
+	pthread_mutex_lock(&ucsi_lock);
+
+	if (ucsi_broker_fd >= 0)
+		close(ucsi_broker_fd);
+	ucsi_broker_fd = fd;
+	ucsi_arb_mode = mode;
+	if (max_wait_ms)
+		ucsi_lease_wait_ms = max_wait_ms;
+
+	pthread_mutex_unlock(&ucsi_lock);
+
+	return 0;
+}
+
+static int libtypec_dbgfs_set_cmd_timeout_ops(unsigned int timeout_ms)
+{
+	__atomic_store_n(&ucsi_cmd_timeout_ms, timeout_ms ? timeout_ms : UCSI_CMD_TIMEOUT_MS, __ATOMIC_RELAXED);
+
+	return 0;
+}
+
+static int libtypec_dbgfs_cancel_cmd_ops(void)
+{
+	uint64_t one = 1;
+
+	__atomic_add_fetch(&ucsi_cancel_gen, 1, __ATOMIC_RELEASE);
+
+	/* EAGAIN: the counter is saturated, waiters are woken already */
+	while (ucsi_cancel_fd >= 0 && write(ucsi_cancel_fd, &one, sizeof(one)) < 0)
+	{
+		if (errno == EAGAIN)
+			break;
+		if (errno != EINTR)
+			return -errno;
+	}
+
+	return 0;
+}
+
+/* Partially received request of a broker client */
+struct ucsi_broker_client {
+	size_t have;
+	struct ucsi_broker_req req;
+};
+
+static void ucsi_broker_drop(struct pollfd *pfd, struct ucsi_broker_client *cl, int *nfds, int idx)
+{
+	close(pfd[idx].fd);
+	--(*nfds);
+	pfd[idx] = pfd[*nfds];
+	cl[idx] = cl[*nfds];
+}
+
+/*
+ * Serve UCSI commands for broker clients. Each poll round executes at most one
+ * command per client, so a client streaming commands cannot starve others.
+ * Client sockets are non-blocking and requests are assembled per client, so a
+ * client that sends part of a request does not hold up the rest.
+ */
+static int libtypec_dbgfs_run_cmd_broker_ops(void)
+{
+	struct sockaddr_un addr = { .sun_family = AF_UNIX };
+	struct pollfd pfd[UCSI_BROKER_MAX_CLIENTS + 1];
+	struct ucsi_broker_client cl[UCSI_BROKER_MAX_CLIENTS + 1];
+	int nfds = 1, ret = 0;
+
+	if (fp_command <= 0)
+		return -ENODEV;
+
+	/* pfd[0] is the listening socket, clients follow */
+	pfd[0].fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+	pfd[0].events = POLLIN;
+	if (pfd[0].fd < 0)
+		return -errno;
+
+	strncpy(addr.sun_path, UCSI_BROKER_SOCK, sizeof(addr.sun_path) - 1);
+	unlink(UCSI_BROKER_SOCK);
+
+	/*
+	 * Only the broker's user may connect, like the debugfs files it stands
+	 * in for. Nobody can connect before listen(), so the mode is set in time.
+	 */
+	if (bind(pfd[0].fd, (struct sockaddr *)&addr, sizeof(addr)) < 0 ||
+	    chmod(UCSI_BROKER_SOCK, 0600) < 0 ||
+	    listen(pfd[0].fd, UCSI_BROKER_MAX_CLIENTS) < 0)
+	{
+		ret = -errno;
+		close(pfd[0].fd);
+		unlink(UCSI_BROKER_SOCK);
+		return ret;
+	}
+
+	while (1)
+	{
+		if (poll(pfd, nfds, -1) < 0)
+		{
+			if (errno == EINTR)
+				continue;
+			ret = -errno;
+			break;
+		}
+
+		for (int i = 1; i < nfds; i++)
+		{
+			struct ucsi_broker_client *c = &cl[i];
+			struct ucsi_broker_rsp rsp = {0};
+			ssize_t n;
+
+			if (!pfd[i].revents)
+				continue;
+
+			if (!(pfd[i].revents & POLLIN))
+			{
+				ucsi_broker_drop(pfd, cl, &nfds, i--);
+				continue;
+			}
+
+			n = recv(pfd[i].fd, (char *)&c->req + c->have, sizeof(c->req) - c->have, 0);
+			if (n <= 0)
+			{
+				if (n < 0 && (errno == EAGAIN || errno == EINTR))
+					continue;
+				ucsi_broker_drop(pfd, cl, &nfds, i--);
+				continue;
+			}
+
+			c->have += n;
+			if (c->have < sizeof(c->req))
+				continue;
+			c->have = 0;
+
+			c->req.cmd[sizeof(c->req.cmd) - 1] = '\0';
+			rsp.ret = ucsi_xfer(c->req.cmd, strlen(c->req.cmd) + 1, rsp.data, sizeof(rsp.data));
+
+			/* Clients wait for each response, a full socket means a broken one */
+			if (send(pfd[i].fd, &rsp, sizeof(rsp), MSG_NOSIGNAL) != sizeof(rsp))
+				ucsi_broker_drop(pfd, cl, &nfds, i--);
+		}
+
+		if (pfd[0].revents & POLLIN)
+		{
+			int cfd = accept4(pfd[0].fd, NULL, NULL, SOCK_CLOEXEC | SOCK_NONBLOCK);
+
+			if (cfd >= 0 && nfds <= UCSI_BROKER_MAX_CLIENTS)
+			{
+				pfd[nfds].fd = cfd;
+				pfd[nfds].events = POLLIN;
+				pfd[nfds].revents = 0;
+				cl[nfds].have = 0;
+				nfds++;
+			}
+			else if (cfd >= 0)
+				close(cfd);
+		}
+	}
+
+	for (int i = 0; i < nfds; i++)
+		close(pfd[i].fd);
+	unlink(UCSI_BROKER_SOCK);
+
+	return ret;
+}
+
 static int libtypec_dbgfs_get_capability_ops(struct libtypec_capability_data *cap_data)
 {
 	int ret=-1;
@@ -209,16 +806,13 @@ static int libtypec_dbgfs_get_capability_ops(struct libtypec_capability_data *ca
 
 	if(fp_command > 0)
 	{
-		ret = write(fp_command,"6",sizeof("6"));
- 
-		if(ret)
+		ret = ucsi_xfer("6", sizeof("6"), buf, sizeof(buf));
+		if(ret > 0)
 		{
-			ret = get_ucsi_response(buf);
 			if(ret < 16)
 				ret = -1;
-
-			// Copy the entire buf into cap_data
-			memcpy(cap_data, buf, sizeof(*cap_data));
+			else
+				memcpy(cap_data, buf, sizeof(*cap_data));
 		}
 	}
 	return ret;
@@ -232,20 +826,22 @@ static int libtypec_dbgfs_get_conn_capability_ops(int conn_num, struct libtypec_
     if(fp_command > 0)
 	{
 		snprintf(buf, sizeof(buf), "0x%x", (conn_num + 1) << 16 | 0x7);
-		ret = write(fp_command,buf,sizeof(buf));
-
-		if(ret)
+		ret = ucsi_xfer(buf, sizeof(buf), buf, sizeof(buf));
+		if(ret > 0)
 		{
-			ret = get_ucsi_response(buf);
 			if(ret < 16)
 				ret = -1;
-			// Copy the entire buf into cap_data
-			memcpy(conn_cap_data, buf, sizeof(*conn_cap_data));
+			else
+				memcpy(conn_cap_data, buf, sizeof(*conn_cap_data));
 		}
 	}
 	return ret;
 }
-static int libtypec_dbgfs_get_alternate_modes(int recipient, int conn_num, struct altmode_data *alt_mode_data)
+/*
+ * Stores at most max modes but keeps counting, so a short buffer is
+ * detected by a return value above max.
+ */
+static int libtypec_dbgfs_get_alternate_modes(int recipient, int conn_num, struct altmode_data *alt_mode_data, int max)
 {
 
 	union get_am_cmd
@@ -263,9 +859,14 @@ static int libtypec_dbgfs_get_alternate_modes(int recipient, int conn_num, struc
 	int ret=-1,i=0;
 	unsigned char buf[64];
 	unsigned short psvid = 0;
+	struct altmode_data am;
 
 	if(fp_command > 0)
 	{
+		ret = ucsi_lease_acquire();
+		if(ret < 0)
+			return ret;
+
 		do
 		{
 			am_cmd.s.cmd = 0xc;
@@ -275,24 +876,29 @@ static int libtypec_dbgfs_get_alternate_modes(int recipient, int conn_num, struc
 			am_cmd.s.offset = i;
 			am_cmd.s.num_am = 0;
 			snprintf(buf, sizeof(buf), "%lld", am_cmd.cmd_val);
-			ret = write(fp_command,buf,sizeof(buf));
+			ret = ucsi_xfer(buf, sizeof(buf), buf, sizeof(buf));
 			if(ret)
 			{
-				ret = get_ucsi_response(buf);
 				if(ret< 16)
-					return -1;
+				{
+					i = ret < 0 ? ret : -1;
+					break;
+				}
 				
-				alt_mode_data[i].svid 	 = buf[1] << 8 | buf[0];
-				alt_mode_data[i].vdo 	 = buf[5] << 24 | buf[4] << 16 | buf[3] << 8 | buf[2];
+				am.svid 	 = buf[1] << 8 | buf[0];
+				am.vdo 	 = buf[5] << 24 | buf[4] << 16 | buf[3] << 8 | buf[2];
 
-				if((alt_mode_data[i].svid == 0) | (alt_mode_data[i].svid == psvid))
+				if((am.svid == 0) | (am.svid == psvid))
 					break;
-				psvid = alt_mode_data[i].svid;
+				psvid = am.svid;
+				if(i < max)
+					alt_mode_data[i] = am;
 			}
 			i++;
 
 		}while(1);
 
+		ucsi_lease_release();
 	}
 	return i;
 }
@@ -304,19 +910,18 @@ static int libtypec_dbfs_get_current_cam_ops(int conn_num, struct libtypec_curre
 	if(fp_command > 0)
 	{
 		snprintf(buf, sizeof(buf), "0x%x", (conn_num + 1) << 16 | 0x0E);
-		ret = write(fp_command,buf,sizeof(buf));
-		if(ret)
+		ret = ucsi_xfer(buf, sizeof(buf), buf, sizeof(buf));
+		if(ret > 0)
 		{
-			ret = get_ucsi_response(buf);
 			if(ret < 16)
 				ret = -1;
-			// Copy the entire buf into cap_data
-			memcpy(cur_cam, buf, ret);
+			else
+				memcpy(cur_cam, buf, UCSI_COPY_LEN(ret, *cur_cam));
 		}
 	}
     return ret;
 }
-static int libtypec_dbgfs_get_pdos_ops(int conn_num, int partner, int offset, int *num_pdo, int src_snk, int type, struct libtypec_get_pdos *pdo_data)
+static int libtypec_dbgfs_get_pdos_ops(int conn_num, int partner, int offset, int *num_pdo, int src_snk, int type, unsigned int *pdo, int max)
 {
 	union get_pdo_cmd
 	{
@@ -338,32 +943,39 @@ static int libtypec_dbgfs_get_pdos_ops(int conn_num, int partner, int offset, in
 
 	if(fp_command > 0)
 	{
+		ret = ucsi_lease_acquire();
+		if(ret < 0)
+			return ret;
+
 		do
 		{
 			pdo_cmd.s.cmd = 0x10;
 			pdo_cmd.s.len = 0;
 			pdo_cmd.s.con = conn_num+1;
 			pdo_cmd.s.ptnr = partner;
-			pdo_cmd.s.offset = i;
+			pdo_cmd.s.offset = offset + i;
 			pdo_cmd.s.num = 0;
 			pdo_cmd.s.src_snk = src_snk;
 			pdo_cmd.s.type = type;
 			
 			snprintf(buf, sizeof(buf), "0x%llx", pdo_cmd.cmd_val);
-			ret = write(fp_command,buf,sizeof(buf));
+			ret = ucsi_xfer(buf, sizeof(buf), buf, sizeof(buf));
 			if(ret)
 			{
-				ret = get_ucsi_response(buf);
 				if(ret< 16)
-					return -1;
-				pdo_data->pdo[i] = buf[3] << 24 | buf[2] << 16 | buf[1] << 8 | buf[0];
-				if((pdo_data->pdo[i] == 0) | (pdo_data->pdo[i] == ppdo))
+				{
+					ucsi_lease_release();
+					return ret < 0 ? ret : -1;
+				}
+				pdo[i] = buf[3] << 24 | buf[2] << 16 | buf[1] << 8 | buf[0];
+				if((pdo[i] == 0) | (pdo[i] == ppdo))
 					break;
-				ppdo = pdo_data->pdo[i];
+				ppdo = pdo[i];
 			}
 			i++;
-		}while(1);
+		}while(i < max);
 
+		ucsi_lease_release();
 	}
 	
 	*num_pdo = i;
@@ -376,14 +988,13 @@ static int libtypec_dbgfs_get_cable_properties_ops(int conn_num, struct libtypec
 	if(fp_command > 0)
 	{
 		snprintf(buf, sizeof(buf), "0x%x", (conn_num + 1) << 16 | 0x11);
-		ret = write(fp_command,buf,sizeof(buf));
-		if(ret)
+		ret = ucsi_xfer(buf, sizeof(buf), buf, sizeof(buf));
+		if(ret > 0)
 		{
-			ret = get_ucsi_response(buf);
 			if(ret < 16)
 				ret = -1;
-			// Copy the entire buf into cap_data
-			memcpy(conn_cap, buf, ret);
+			else
+				memcpy(conn_cap, buf, UCSI_COPY_LEN(ret, *conn_cap));
 		}
 	}
 	return ret;
@@ -396,18 +1007,46 @@ static int libtypec_dbgs_get_connector_status_ops(int conn_num, struct libtypec_
 	if(fp_command > 0)
 	{
 		snprintf(buf, sizeof(buf), "0x%x", (conn_num + 1) << 16 | 0x12);
-		ret = write(fp_command,buf,sizeof(buf));
-		if(ret)
+		ret = ucsi_xfer(buf, sizeof(buf), buf, sizeof(buf));
+		if(ret > 0)
 		{
-			ret = get_ucsi_response(buf);
 			if(ret < 16)
 				ret = -1;
-			// Copy the entire buf into cap_data
-			memcpy(conn_sts, buf, ret);
+			else
+				memcpy(conn_sts, buf, UCSI_COPY_LEN(ret, *conn_sts));
 		}
 	}
     return ret;
 }
+
+/*
+ * UCSI 3.0 power reading of GET_CONNECTOR_STATUS: VoltageScale and
+ * CurrentScale are multiples of 5 mV and 5 mA. Older PPMs return a shorter
+ * status without the reading.
+ */
+static int libtypec_dbgfs_get_power_sample_ops(int conn_num, struct libtypec_power_sample *sample)
+{
+	struct libtypec_connector_status sts;
+	int ret;
+
+	memset(&sts, 0, sizeof(sts));
+
+	ret = libtypec_dbgs_get_connector_status_ops(conn_num, &sts);
+	if (ret < 0)
+		return ret;
+
+	if (!sts.PowerReadingReady)
+		return -ENODATA;
+
+	sample->voltage_mv = sts.VoltageReading * sts.VoltageScale * 5;
+	sample->current_ma = sts.AverageCurrent * sts.CurrentScale * 5;
+	sample->peak_ma = sts.PeakCurrent * sts.CurrentScale * 5;
+	sample->connected = sts.ConnectStatus;
+	sample->sourcing = sts.PowerDirection;
+
+	return 0;
+}
+
 static int libtypec_dbgfs_set_uor_ops(unsigned char conn_num, unsigned char uor)
 {
 	int ret=-1;
@@ -431,10 +1070,9 @@ static int libtypec_dbgfs_set_uor_ops(unsigned char conn_num, unsigned char uor)
 		setuorcmd.uor_type = 0x4 | uor;
 
 		snprintf(buf, sizeof(buf), "0x%x", setuorcmd.uor_cmd);
-		ret = write(fp_command,buf,sizeof(buf));
-		if(ret)
+		ret = ucsi_xfer(buf, sizeof(buf), buf, sizeof(buf));
+		if(ret > 0)
 		{
-			ret = get_ucsi_response(buf);
 			if(ret < 16)
 				ret = -1;
 		}
@@ -464,10 +1102,9 @@ static int libtypec_dbgfs_set_pdr_ops(unsigned char conn_num, unsigned char pdr)
 		setpdrcmd.con_num = conn_num + 1;
 		setpdrcmd.pdr_type = pdr;
 		snprintf(buf, sizeof(buf), "0x%x", setpdrcmd.pdr_cmd);
-		ret = write(fp_command,buf,sizeof(buf));
-		if(ret)
+		ret = ucsi_xfer(buf, sizeof(buf), buf, sizeof(buf));
+		if(ret > 0)
 		{
-			ret = get_ucsi_response(buf);
 			if(ret < 16)
 				ret = -1;
 		}
@@ -496,10 +1133,9 @@ static int libtypec_dbgfs_set_ccom_ops(unsigned char conn_num, unsigned char cco
 		setccomcmd.con_num = conn_num + 1;
 		setccomcmd.ccom_type = ccom ;
 		snprintf(buf, sizeof(buf), "0x%x", setccomcmd.ccom_cmd);
-		ret = write(fp_command,buf,sizeof(buf));
-		if(ret)
+		ret = ucsi_xfer(buf, sizeof(buf), buf, sizeof(buf));
+		if(ret > 0)
 		{
-			ret = get_ucsi_response(buf);
 			if(ret < 16)
 				ret = -1;
 		}
@@ -515,14 +1151,13 @@ static int libtypec_dbgfs_get_lpm_info_ops(unsigned char conn_num, struct libtyp
 	if(fp_command > 0)
 	{
 		snprintf(buf, sizeof(buf), "0x%x", (conn_num + 1) << 16 | 0x22);
-		ret = write(fp_command,buf,sizeof(buf));
-		if(ret)
+		ret = ucsi_xfer(buf, sizeof(buf), buf, sizeof(buf));
+		if(ret > 0)
 		{
-			ret = get_ucsi_response(buf);
 			if(ret < 16)
 				ret = -1;
-			// Copy the entire buf into cap_data
-			memcpy(lpm_ppm_info, buf, ret);
+			else
+				memcpy(lpm_ppm_info, buf, UCSI_COPY_LEN(ret, *lpm_ppm_info));
 		}
 	}
     return ret;
@@ -535,14 +1170,13 @@ static int libtypec_dbgfs_get_error_status_ops(unsigned char conn_num, struct li
 	if(fp_command > 0)
 	{
 		snprintf(buf, sizeof(buf), "0x%x", (conn_num + 1) << 16 | 0x13);
-		ret = write(fp_command,buf,sizeof(buf));
-		if(ret)
+		ret = ucsi_xfer(buf, sizeof(buf), buf, sizeof(buf));
+		if(ret > 0)
 		{
-			ret = get_ucsi_response(buf);
 			if(ret < 16)
 				ret = -1;
-			// Copy the entire buf into cap_data
-			memcpy(error_status, buf, ret);
+			else
+				memcpy(error_status, buf, UCSI_COPY_LEN(ret, *error_status));
 		}
 	}
     return ret;
@@ -574,10 +1208,9 @@ static int libtypec_dbgfs_set_new_cam_ops(unsigned char conn_num, unsigned char
 		setnewcamcmd.am_spec = am_spec;
 		snprintf(buf, sizeof(buf), "0x%lx", setnewcamcmd.newcam_cmd);
 		printf("===> %s\n", buf);
-		ret = write(fp_command,buf,sizeof(buf));
-		if(ret)
+		ret = ucsi_xfer(buf, sizeof(buf), buf, sizeof(buf));
+		if(ret > 0)
 		{
-			ret = get_ucsi_response(buf);
 			if(ret < 16)
 				ret = -1;
 		}
@@ -610,19 +1243,69 @@ static int libtypec_dbgfs_get_cam_cs_ops(unsigned char conn_num, unsigned char c
 		getcamcscmd.cam = cam;
 
 		snprintf(buf, sizeof(buf), "0x%x", getcamcscmd.camcs_cmd);
-		ret = write(fp_command,buf,sizeof(buf));
-		if(ret)
+		ret = ucsi_xfer(buf, sizeof(buf), buf, sizeof(buf));
+		if(ret > 0)
 		{
-			ret = get_ucsi_response(buf);
 			if(ret < 16)
 				ret = -1;
-			// Copy the entire buf into cap_data
-			memcpy(cam_cs, buf, ret);
+			else
+				memcpy(cam_cs, buf, UCSI_COPY_LEN(ret, *cam_cs));
 		}
 	}
     return ret;
 }
 
+/*
+ * Poll GET_CONNECTOR_STATUS on every connector and turn status changes into
+ * events. The interval doubles while nothing changes and drops back to the
+ * minimum on any change. The polls are background requests of the async
+ * engine while it runs. Returns when the backend is closed.
+ */
+static void libtypec_dbgfs_monitor_events(void)
+{
+	struct libtypec_connector_status prev[UCSI_MAX_CONNECTORS];
+	struct libtypec_capability_data cap;
+	unsigned char valid[UCSI_MAX_CONNECTORS] = {0};
+	unsigned int interval = UCSI_POLL_MIN_MS;
+	int num_conn, i;
+
+	if (libtypec_dbgfs_get_capability_ops(&cap) < 0)
+		return;
+
+	num_conn = cap.bNumConnectors;
+
+	while (fp_command > 0)
+	{
+		int changed = 0;
+
+		for (i = 0; i < num_conn; i++)
+		{
+			struct libtypec_event_info info = { .conn_num = i, .status_valid = 1 };
+
+			if (libtypec_get_connector_status_prio(i, &info.status, LIBTYPEC_ASYNC_PRIO_BACKGROUND) < 16)
+				continue;
+
+			if (valid[i])
+				info.changed.raw_conn_stschang = libtypec_status_diff(&prev[i], &info.status);
+			prev[i] = info.status;
+			valid[i] = 1;
+
+			if (info.changed.raw_conn_stschang)
+			{
+				changed = 1;
+				libtypec_notify_status_change(&info);
+			}
+		}
+
+		if (changed)
+			interval = UCSI_POLL_MIN_MS;
+		else if (interval < UCSI_POLL_MAX_MS)
+			interval = interval * 2 < UCSI_POLL_MAX_MS ? interval * 2 : UCSI_POLL_MAX_MS;
+
+		ucsi_sleep_us(interval * 1000L);
+	}
+}
+
 const struct libtypec_os_backend libtypec_lnx_dbgfs_backend = {
 	.init = libtypec_dbgfs_init,
 	.exit = libtypec_dbgfs_exit,
@@ -645,4 +1328,10 @@ const struct libtypec_os_backend libtypec_lnx_dbgfs_backend = {
 	.get_error_status_ops = libtypec_dbgfs_get_error_status_ops,
 	.set_new_cam_ops = libtypec_dbgfs_set_new_cam_ops,
 	.get_cam_cs_ops = libtypec_dbgfs_get_cam_cs_ops,
+	.set_cmd_arbitration_ops = libtypec_dbgfs_set_cmd_arbitration_ops,
+	.run_cmd_broker_ops = libtypec_dbgfs_run_cmd_broker_ops,
+	.set_cmd_timeout_ops = libtypec_dbgfs_set_cmd_timeout_ops,
+	.cancel_cmd_ops = libtypec_dbgfs_cancel_cmd_ops,
+	.monitor_events = libtypec_dbgfs_monitor_events,
+	.get_power_sample_ops = libtypec_dbgfs_get_power_sample_ops,
 };
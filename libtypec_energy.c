@@ -0,0 +1,396 @@
+/*
+MIT License
+
+Copyright (c) 2022 Rajaram Regupathy <rajaram.regupathy@gmail.com>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+// SPDX-License-Identifier: MIT
+/**
+ * @file libtypec_energy.c
+ * @author Rajaram Regupathy <rajaram.regupathy@gmail.com>
+ * @brief Cumulative per port and per partner energy accounting
+ *
+ * The telemetry sampler hands every sample to libtypec_energy_account(),
+ * which integrates power over time (trapezoidal rule) into counters kept in
+ * a small mmapped state file. Counters therefore survive restarts and can be
+ * read by other processes while one process does the accounting; the
+ * accounting process holds an exclusive flock() on the file.
+ *
+ * Partner counters are keyed by the USB VID:PID of the partner's Discover
+ * Identity response, looked up once per attach.
+ */
+
+#include "libtypec.h"
+#include "libtypec_ops.h"
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/file.h>
+
+#define ENERGY_MAGIC 0x4e455454	/* "TTEN" */
+#define ENERGY_VERSION 2
+#define ENERGY_MAX_PARTNERS 64
+/* Gaps longer than this are not integrated across */
+#define ENERGY_MAX_GAP_NS (5ull * 1000000000ull)
+/* Ask the kernel to write the counters back at most this often */
+#define ENERGY_SYNC_NS (10ull * 1000000000ull)
+
+struct energy_partner {
+	/* VID << 16 | PID, 0 for partners without a usable identity */
+	uint32_t key;
+	uint32_t reserved;
+	struct libtypec_energy e;
+};
+
+struct energy_state {
+	uint32_t magic;
+	uint32_t version;
+	uint32_t num_ports;
+	uint32_t num_partners;
+	struct libtypec_energy port[LIBTYPEC_TELEMETRY_MAX_PORTS];
+	/* partner[0] takes partners without an identity and those that do not fit */
+	struct energy_partner partner[ENERGY_MAX_PARTNERS];
+};
+
+/* In memory integration state of each port */
+struct energy_port {
+	int have_prev;
+	uint64_t prev_ns;
+	long long prev_mw;
+	/* energy below 1 uJ carried to the next sample, in nJ */
+	uint64_t rem_nj;
+	struct energy_partner *partner;
+};
+
+static struct {
+	pthread_mutex_t lock;
+	int fd;
+	int account;
+	struct energy_state *st;
+	uint64_t last_sync_ns;
+	struct energy_port port[LIBTYPEC_TELEMETRY_MAX_PORTS];
+} eng = {
+	.lock = PTHREAD_MUTEX_INITIALIZER,
+	.fd = -1,
+};
+
+static struct energy_partner *energy_partner_slot(uint32_t key)
+{
+	struct energy_state *st = eng.st;
+	unsigned int i;
+
+	for (i = 0; i < st->num_partners; i++)
+	{
+		if (st->partner[i].key == key)
+			return &st->partner[i];
+	}
+
+	/* Table full: account to the unknown partner entry, always slot 0 */
+	if (st->num_partners >= ENERGY_MAX_PARTNERS)
+		return &st->partner[0];
+
+	st->partner[st->num_partners].key = key;
+	return &st->partner[st->num_partners++];
+}
+
+static uint32_t energy_partner_key(int conn_num)
+{
+	union libtypec_discovered_identity id;
+
+	memset(&id, 0, sizeof(id));
+
+	if (libtypec_get_pd_message(AM_SOP, conn_num, sizeof(id), DISCOVER_ID_REQ, id.buf_disc_id) < 0)
+		return 0;
+
+	if (id.disc_id.id_header == 0xffffffff)
+		return 0;
+
+	return (id.disc_id.id_header & 0xffff) << 16 | id.disc_id.product >> 16;
+}
+
+/*
+ * Called from the telemetry sampler for every sample of a connector.
+ */
+void libtypec_energy_account(int conn_num, const struct libtypec_power_sample *sample)
+{
+	struct energy_port *p;
+	long long mw;
+	uint64_t nj;
+
+	if (conn_num < 0 || conn_num >= LIBTYPEC_TELEMETRY_MAX_PORTS)
+		return;
+
+	pthread_mutex_lock(&eng.lock);
+
+	if (!eng.st || !eng.account)
+		goto out;
+
+	p = &eng.port[conn_num];
+
+	if (!sample->connected)
+	{
+		p->have_prev = 0;
+		p->partner = NULL;
+		goto out;
+	}
+
+	if (!p->partner)
+		p->partner = energy_partner_slot(energy_partner_key(conn_num));
+
+	mw = ((long long)sample->voltage_mv * sample->current_ma) / 1000;
+	if (mw < 0)
+		mw = -mw;
+
+	if (p->have_prev && sample->ts_ns > p->prev_ns && sample->ts_ns - p->prev_ns <= ENERGY_MAX_GAP_NS)
+	{
+		struct libtypec_energy *pe = &eng.st->port[conn_num];
+		struct libtypec_energy *te = &p->partner->e;
+		uint64_t uj;
+
+		/* mW * ns = pJ, so the mean power times dt / 1000 is in nJ */
+		nj = (uint64_t)(mw + p->prev_mw) * (sample->ts_ns - p->prev_ns) / 2000 + p->rem_nj;
+		uj = nj / 1000;
+		p->rem_nj = nj % 1000;
+
+		if (sample->sourcing)
+		{
+			pe->delivered_uj += uj;
+			te->delivered_uj += uj;
+		}
+		else
+		{
+			pe->received_uj += uj;
+			te->received_uj += uj;
+		}
+	}
+
+	p->have_prev = 1;
+	p->prev_ns = sample->ts_ns;
+	p->prev_mw = mw;
+
+	if (sample->ts_ns - eng.last_sync_ns >= ENERGY_SYNC_NS)
+	{
+		msync(eng.st, sizeof(*eng.st), MS_ASYNC);
+		eng.last_sync_ns = sample->ts_ns;
+	}
+
+out:
+	pthread_mutex_unlock(&eng.lock);
+}
+
+/**
+ * This function shall be used to map the energy state file. With account
+ * set, samples of the telemetry sampler are integrated into it; only one
+ * process can account to a file at a time, and creates the file and its
+ * directory if needed.
+ *
+ * \param path State file, NULL for LIBTYPEC_ENERGY_STATE_FILE
+ * \param account Non zero to accumulate energy, 0 to only read counters
+ *
+ * \returns 0 on success, -EBUSY if another process is accounting
+ */
+int libtypec_energy_open(const char *path, int account)
+{
+	struct energy_state *st;
+	struct stat sb;
+	int fd, ret = 0;
+
+	if (!path)
+		path = LIBTYPEC_ENERGY_STATE_FILE;
+
+	pthread_mutex_lock(&eng.lock);
+
+	if (eng.st)
+	{
+		ret = -EALREADY;
+		goto out;
+	}
+
+	if (account)
+		libtypec_state_dir(path);
+
+	fd = open(path, account ? O_RDWR | O_CREAT : O_RDONLY, 0644);
+	if (fd < 0)
+	{
+		ret = -errno;
+		goto out;
+	}
+	fcntl(fd, F_SETFD, FD_CLOEXEC);
+
+	if (account && flock(fd, LOCK_EX | LOCK_NB) < 0)
+	{
+		ret = errno == EWOULDBLOCK ? -EBUSY : -errno;
+		goto err_close;
+	}
+
+	if (fstat(fd, &sb) < 0)
+	{
+		ret = -errno;
+		goto err_close;
+	}
+
+	if ((size_t)sb.st_size < sizeof(*st))
+	{
+		if (!account || ftruncate(fd, sizeof(*st)) < 0)
+		{
+			ret = account ? -errno : -ENODATA;
+			goto err_close;
+		}
+	}
+
+	st = mmap(NULL, sizeof(*st), account ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, fd, 0);
+	if (st == MAP_FAILED)
+	{
+		ret = -errno;
+		goto err_close;
+	}
+
+	if (st->magic != ENERGY_MAGIC || st->version != ENERGY_VERSION ||
+	    st->num_partners < 1 || st->num_partners > ENERGY_MAX_PARTNERS || st->partner[0].key)
+	{
+		if (!account)
+		{
+			munmap(st, sizeof(*st));
+			ret = -EINVAL;
+			goto err_close;
+		}
+
+		/* New, incompatible or corrupt file, start counting from zero */
+		memset(st, 0, sizeof(*st));
+		st->version = ENERGY_VERSION;
+		st->num_ports = LIBTYPEC_TELEMETRY_MAX_PORTS;
+		/* Slot 0 is the unknown partner, key 0 */
+		st->num_partners = 1;
+		__atomic_store_n(&st->magic, ENERGY_MAGIC, __ATOMIC_RELEASE);
+	}
+
+	memset(eng.port, 0, sizeof(eng.port));
+	eng.fd = fd;
+	eng.st = st;
+	eng.account = account;
+	eng.last_sync_ns = 0;
+	goto out;
+
+err_close:
+	close(fd);
+out:
+	pthread_mutex_unlock(&eng.lock);
+	return ret;
+}
+
+/**
+ * This function shall be used to unmap the energy state file, flushing the
+ * counters to disk.
+ *
+ * \returns 0 on success
+ */
+int libtypec_energy_close(void)
+{
+	pthread_mutex_lock(&eng.lock);
+
+	if (eng.st)
+	{
+		if (eng.account)
+			msync(eng.st, sizeof(*eng.st), MS_SYNC);
+		munmap(eng.st, sizeof(*eng.st));
+		close(eng.fd);
+		eng.st = NULL;
+		eng.fd = -1;
+	}
+
+	pthread_mutex_unlock(&eng.lock);
+
+	return 0;
+}
+
+/**
+ * This function shall be used to get the energy a connector has delivered
+ * and received
+ *
+ * \param conn_num connector number
+ * \param energy Filled with the counters
+ *
+ * \returns 0 on success, -ENODATA without a state file
+ */
+int libtypec_energy_get_port(int conn_num, struct libtypec_energy *energy)
+{
+	int ret = 0;
+
+	if (conn_num < 0 || conn_num >= LIBTYPEC_TELEMETRY_MAX_PORTS)
+		return -EINVAL;
+
+	pthread_mutex_lock(&eng.lock);
+
+	if (eng.st)
+		*energy = eng.st->port[conn_num];
+	else
+		ret = -ENODATA;
+
+	pthread_mutex_unlock(&eng.lock);
+
+	return ret;
+}
+
+/**
+ * This function shall be used to get the energy delivered to and received
+ * from a partner across all connectors
+ *
+ * \param vid USB vendor ID of the partner, 0 with pid 0 for unidentified
+ * partners and those that did not fit the table
+ * \param pid USB product ID of the partner
+ * \param energy Filled with the counters
+ *
+ * \returns 0 on success, -ENOENT for a partner never seen
+ */
+int libtypec_energy_get_partner(unsigned short vid, unsigned short pid, struct libtypec_energy *energy)
+{
+	uint32_t key = (uint32_t)vid << 16 | pid;
+	unsigned int i, n;
+	int ret = -ENOENT;
+
+	pthread_mutex_lock(&eng.lock);
+
+	if (!eng.st)
+	{
+		ret = -ENODATA;
+		goto out;
+	}
+
+	n = eng.st->num_partners < ENERGY_MAX_PARTNERS ? eng.st->num_partners : ENERGY_MAX_PARTNERS;
+	for (i = 0; i < n; i++)
+	{
+		if (eng.st->partner[i].key == key)
+		{
+			*energy = eng.st->partner[i].e;
+			ret = 0;
+			break;
+		}
+	}
+
+out:
+	pthread_mutex_unlock(&eng.lock);
+	return ret;
+}
@@ -0,0 +1,558 @@
+/*
+MIT License
+
+Copyright (c) 2022 Rajaram Regupathy <rajaram.regupathy@gmail.com>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+// SPDX-License-Identifier: MIT
+/**
+ * @file libtypec_journal.c
+ * @author Rajaram Regupathy <rajaram.regupathy@gmail.com>
+ * @brief Append only journal of connector state transitions
+ *
+ * Every event libtypec delivers is appended to a fixed size, mmapped ring
+ * file, so that state and PD contract changes can be looked at after the
+ * fact. The ring is made of 4 KiB blocks; each block starts with a wall
+ * clock time and holds variable length records:
+ *
+ *	len, event, connector + 1, varint time delta in us,
+ *	varint field mask, one varint per field in the mask,
+ *	for alerts: varint alert id, zigzag varint alert value
+ *
+ * The first record of a connector in a block carries its full state, later
+ * ones only the fields that changed, so any block can be decoded alone and
+ * the oldest block can be overwritten without losing more than it held.
+ * A record becomes visible when the block's used count is stored after it,
+ * so a crash never leaves a torn record behind. One process appends at a
+ * time, it holds an exclusive flock() on the file.
+ */
+
+#include "libtypec.h"
+#include "libtypec_ops.h"
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/file.h>
+
+#define JOURNAL_MAGIC 0x4e524a54	/* "TJRN" */
+#define JOURNAL_VERSION 1
+#define JOURNAL_BLOCK 4096
+#define JOURNAL_MIN_BLOCKS 4
+#define JOURNAL_MAX_REC 128
+/* Ask the kernel to write the ring back at most this often */
+#define JOURNAL_SYNC_NS (10ull * 1000000000ull)
+
+/* Connector state and contract, not the change bits or VBUS readings */
+#define JOURNAL_FIELDS (((1u << LIBTYPEC_FIELD_STATUS_POWER_READING_READY) - 1) & \
+			~(1u << LIBTYPEC_FIELD_STATUS_CHANGE))
+
+struct journal_hdr {
+	uint32_t magic;
+	uint32_t version;
+	uint32_t block_size;
+	uint32_t num_blocks;
+	/* Sequence number of the block being written, stored at seq % num_blocks */
+	uint64_t seq;
+	uint8_t reserved[JOURNAL_BLOCK - 24];
+};
+
+struct journal_block {
+	/* 0 while the block is being reset */
+	uint64_t seq;
+	/* Record times are offsets from this CLOCK_REALTIME time */
+	uint64_t ts_ns;
+	/* Bytes of committed records */
+	uint32_t used;
+	uint32_t reserved;
+	uint8_t data[JOURNAL_BLOCK - 24];
+};
+
+static struct {
+	pthread_mutex_t lock;
+	int fd;
+	size_t map_size;
+	struct journal_hdr *hdr;
+	struct journal_block *cur;
+	uint64_t prev_off_us;
+	uint64_t last_sync_ns;
+	/* Connectors whose full state is in the current block */
+	uint32_t in_block;
+	uint32_t state[LIBTYPEC_TELEMETRY_MAX_PORTS][LIBTYPEC_FIELD_STATUS_COUNT];
+} jrn = {
+	.lock = PTHREAD_MUTEX_INITIALIZER,
+	.fd = -1,
+};
+
+static int jrn_on;
+
+static uint64_t journal_now_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_REALTIME, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+static struct journal_block *journal_block(const struct journal_hdr *hdr, uint64_t seq)
+{
+	return (struct journal_block *)((uint8_t *)hdr + JOURNAL_BLOCK * (1 + seq % hdr->num_blocks));
+}
+
+static uint8_t *put_varint(uint8_t *p, uint64_t v)
+{
+	while (v >= 0x80)
+	{
+		*p++ = v | 0x80;
+		v >>= 7;
+	}
+	*p++ = v;
+
+	return p;
+}
+
+static const uint8_t *get_varint(const uint8_t *p, const uint8_t *end, uint64_t *v)
+{
+	int shift = 0;
+
+	*v = 0;
+	while (p < end && shift < 64)
+	{
+		*v |= (uint64_t)(*p & 0x7f) << shift;
+		if (!(*p++ & 0x80))
+			return p;
+		shift += 7;
+	}
+
+	return NULL;
+}
+
+static void journal_new_block(uint64_t now)
+{
+	uint64_t seq = jrn.hdr->seq + 1;
+	struct journal_block *b = journal_block(jrn.hdr, seq);
+
+	__atomic_store_n(&b->seq, 0, __ATOMIC_RELEASE);
+	b->used = 0;
+	b->ts_ns = now;
+	__atomic_store_n(&b->seq, seq, __ATOMIC_RELEASE);
+	__atomic_store_n(&jrn.hdr->seq, seq, __ATOMIC_RELEASE);
+
+	jrn.cur = b;
+	jrn.prev_off_us = 0;
+	jrn.in_block = 0;
+}
+
+/*
+ * Called for every event before the callbacks run. info carries the
+ * connector status when the backend or libtypec_notify() could read it.
+ */
+void libtypec_journal_event(enum usb_typec_event event, const struct libtypec_event_info *info)
+{
+	uint8_t rec[JOURNAL_MAX_REC], *p;
+	uint64_t now, off;
+	uint32_t mask = 0, value[LIBTYPEC_FIELD_STATUS_COUNT];
+	int conn = info->conn_num, f;
+
+	pthread_mutex_lock(&jrn.lock);
+
+	if (!jrn.hdr)
+		goto out;
+
+	now = journal_now_ns();
+	if (jrn.cur->used + JOURNAL_MAX_REC > sizeof(jrn.cur->data) || now < jrn.cur->ts_ns)
+		journal_new_block(now);
+
+	off = (now - jrn.cur->ts_ns) / 1000;
+	if (off < jrn.prev_off_us)
+		off = jrn.prev_off_us;
+
+	if (conn < 0 || conn >= LIBTYPEC_TELEMETRY_MAX_PORTS)
+		conn = -1;
+
+	if (conn >= 0 && info->status_valid)
+	{
+		for (f = 0; f < LIBTYPEC_FIELD_STATUS_COUNT; f++)
+		{
+			if (!(JOURNAL_FIELDS & (1u << f)))
+				continue;
+
+			value[f] = libtypec_status_field(&info->status, f);
+			if (!(jrn.in_block & (1u << conn)) || jrn.state[conn][f] != value[f])
+				mask |= 1u << f;
+			jrn.state[conn][f] = value[f];
+		}
+		jrn.in_block |= 1u << conn;
+	}
+
+	p = rec + 3;
+	p = put_varint(p, off - jrn.prev_off_us);
+	p = put_varint(p, mask);
+	for (f = 0; f < LIBTYPEC_FIELD_STATUS_COUNT; f++)
+		if (mask & (1u << f))
+			p = put_varint(p, value[f]);
+
+	if (event == USBC_ALERT || event == USBC_ALERT_CLEARED)
+	{
+		p = put_varint(p, (uint32_t)info->alert_id);
+		p = put_varint(p, ((uint32_t)info->alert_value << 1) ^ (uint32_t)(info->alert_value >> 31));
+	}
+
+	rec[0] = p - rec;
+	rec[1] = event;
+	rec[2] = conn + 1;
+
+	memcpy(jrn.cur->data + jrn.cur->used, rec, rec[0]);
+	__atomic_store_n(&jrn.cur->used, jrn.cur->used + rec[0], __ATOMIC_RELEASE);
+	jrn.prev_off_us = off;
+
+	if (now - jrn.last_sync_ns >= JOURNAL_SYNC_NS)
+	{
+		msync(jrn.hdr, jrn.map_size, MS_ASYNC);
+		jrn.last_sync_ns = now;
+	}
+
+out:
+	pthread_mutex_unlock(&jrn.lock);
+}
+
+int libtypec_journal_active(void)
+{
+	return __atomic_load_n(&jrn_on, __ATOMIC_RELAXED);
+}
+
+/**
+ * This function shall be used to start journaling events to a ring file.
+ * An existing journal is continued if it has the requested size, otherwise
+ * it is started over. Only one process can journal to a file at a time.
+ * The file and its directory are created if needed.
+ *
+ * \param path Journal file, NULL for LIBTYPEC_JOURNAL_FILE
+ * \param size Size of the ring in bytes, 0 for the size of an existing
+ * journal or LIBTYPEC_JOURNAL_SIZE
+ *
+ * \returns 0 on success, -EBUSY if another process is journaling
+ */
+int libtypec_journal_open(const char *path, size_t size)
+{
+	struct journal_hdr *hdr;
+	struct stat sb;
+	uint32_t num_blocks;
+	size_t map_size;
+	int fd, ret = 0;
+
+	if (!path)
+		path = LIBTYPEC_JOURNAL_FILE;
+
+	pthread_mutex_lock(&jrn.lock);
+
+	if (jrn.hdr)
+	{
+		ret = -EALREADY;
+		goto out;
+	}
+
+	libtypec_state_dir(path);
+
+	fd = open(path, O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+	if (fd < 0)
+	{
+		ret = -errno;
+		goto out;
+	}
+
+	if (flock(fd, LOCK_EX | LOCK_NB) < 0)
+	{
+		ret = errno == EWOULDBLOCK ? -EBUSY : -errno;
+		goto err_close;
+	}
+
+	if (fstat(fd, &sb) < 0)
+	{
+		ret = -errno;
+		goto err_close;
+	}
+
+	if (!size)
+		size = sb.st_size > JOURNAL_BLOCK ? sb.st_size - JOURNAL_BLOCK : LIBTYPEC_JOURNAL_SIZE;
+
+	num_blocks = size / JOURNAL_BLOCK;
+	if (num_blocks < JOURNAL_MIN_BLOCKS)
+		num_blocks = JOURNAL_MIN_BLOCKS;
+	map_size = (size_t)(1 + num_blocks) * JOURNAL_BLOCK;
+
+	if ((size_t)sb.st_size != map_size && ftruncate(fd, map_size) < 0)
+	{
+		ret = -errno;
+		goto err_close;
+	}
+
+	hdr = mmap(NULL, map_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	if (hdr == MAP_FAILED)
+	{
+		ret = -errno;
+		goto err_close;
+	}
+
+	if (hdr->magic != JOURNAL_MAGIC || hdr->version != JOURNAL_VERSION ||
+	    hdr->block_size != JOURNAL_BLOCK || hdr->num_blocks != num_blocks)
+	{
+		/* New, resized or incompatible journal, start over */
+		memset(hdr, 0, map_size);
+		hdr->version = JOURNAL_VERSION;
+		hdr->block_size = JOURNAL_BLOCK;
+		hdr->num_blocks = num_blocks;
+		__atomic_store_n(&hdr->magic, JOURNAL_MAGIC, __ATOMIC_RELEASE);
+	}
+
+	jrn.fd = fd;
+	jrn.hdr = hdr;
+	jrn.map_size = map_size;
+	jrn.last_sync_ns = 0;
+	/* Record times are relative to the block, so always start a fresh one */
+	journal_new_block(journal_now_ns());
+	__atomic_store_n(&jrn_on, 1, __ATOMIC_RELAXED);
+	goto out;
+
+err_close:
+	close(fd);
+out:
+	pthread_mutex_unlock(&jrn.lock);
+	return ret;
+}
+
+/**
+ * This function shall be used to stop journaling, flushing the ring to disk.
+ *
+ * \returns 0 on success
+ */
+int libtypec_journal_close(void)
+{
+	pthread_mutex_lock(&jrn.lock);
+
+	if (jrn.hdr)
+	{
+		__atomic_store_n(&jrn_on, 0, __ATOMIC_RELAXED);
+		msync(jrn.hdr, jrn.map_size, MS_SYNC);
+		munmap(jrn.hdr, jrn.map_size);
+		close(jrn.fd);
+		jrn.hdr = NULL;
+		jrn.cur = NULL;
+		jrn.fd = -1;
+	}
+
+	pthread_mutex_unlock(&jrn.lock);
+
+	return 0;
+}
+
+struct journal_order {
+	uint64_t seq;
+	uint32_t idx;
+};
+
+static int journal_order_cmp(const void *a, const void *b)
+{
+	const struct journal_order *x = a, *y = b;
+
+	return x->seq < y->seq ? -1 : x->seq > y->seq;
+}
+
+/* Decode the records of one block copy, calling cb for those in range */
+static int journal_decode(const struct journal_block *b, uint32_t used, uint64_t from_ns, uint64_t to_ns,
+			  struct libtypec_journal_entry *state, libtypec_journal_cb_t cb, void *data, int *num)
+{
+	const uint8_t *p = b->data, *end = b->data + used;
+	uint64_t off = 0, v;
+	int f, ret;
+
+	while (p + 3 <= end && p[0] >= 3 && p + p[0] <= end)
+	{
+		const uint8_t *rec_end = p + p[0];
+		struct libtypec_journal_entry *e;
+		int event = p[1], conn = p[2] - 1;
+		uint32_t mask;
+
+		if (conn >= LIBTYPEC_TELEMETRY_MAX_PORTS)
+			return -EINVAL;
+
+		/* Entries of unknown connectors share the last slot */
+		e = &state[conn >= 0 ? conn : LIBTYPEC_TELEMETRY_MAX_PORTS];
+
+		p = get_varint(p + 3, rec_end, &v);
+		if (!p)
+			return -EINVAL;
+		off += v;
+
+		p = get_varint(p, rec_end, &v);
+		if (!p)
+			return -EINVAL;
+		mask = v & JOURNAL_FIELDS;
+
+		for (f = 0; f < LIBTYPEC_FIELD_STATUS_COUNT; f++)
+		{
+			if (!(mask & (1u << f)))
+				continue;
+			p = get_varint(p, rec_end, &v);
+			if (!p)
+				return -EINVAL;
+			e->value[f] = v;
+		}
+
+		e->ts_ns = b->ts_ns + off * 1000;
+		e->conn_num = conn;
+		e->event = event;
+		e->changed = mask;
+		e->known |= mask;
+		e->alert_id = 0;
+		e->alert_value = 0;
+
+		if (event == USBC_ALERT || event == USBC_ALERT_CLEARED)
+		{
+			p = get_varint(p, rec_end, &v);
+			if (p)
+				e->alert_id = v;
+			if (p && (p = get_varint(p, rec_end, &v)))
+				e->alert_value = (int32_t)((uint32_t)v >> 1 ^ -(uint32_t)(v & 1));
+		}
+
+		p = rec_end;
+
+		if (e->ts_ns < from_ns || e->ts_ns > to_ns)
+			continue;
+
+		(*num)++;
+		ret = cb(e, data);
+		if (ret)
+			return ret;
+	}
+
+	return 0;
+}
+
+/**
+ * This function shall be used to read back the events of a journal that
+ * happened between two times, oldest first. It can run while another
+ * process appends to the journal.
+ *
+ * \param path Journal file, NULL for LIBTYPEC_JOURNAL_FILE
+ * \param from_ns Earliest CLOCK_REALTIME time, 0 for the oldest event
+ * \param to_ns Latest CLOCK_REALTIME time, UINT64_MAX for the newest event
+ * \param cb Called for every event in range
+ * \param data Passed to cb
+ *
+ * \returns number of events passed to cb, negative on failure
+ */
+int libtypec_journal_query(const char *path, uint64_t from_ns, uint64_t to_ns,
+			   libtypec_journal_cb_t cb, void *data)
+{
+	struct libtypec_journal_entry state[LIBTYPEC_TELEMETRY_MAX_PORTS + 1];
+	struct journal_order *order = NULL;
+	struct journal_block *copy = NULL;
+	const struct journal_hdr *hdr;
+	struct stat sb;
+	uint32_t i, n = 0;
+	int fd, ret = 0, num = 0;
+
+	if (!path)
+		path = LIBTYPEC_JOURNAL_FILE;
+
+	fd = open(path, O_RDONLY | O_CLOEXEC);
+	if (fd < 0)
+		return -errno;
+
+	if (fstat(fd, &sb) < 0)
+	{
+		ret = -errno;
+		close(fd);
+		return ret;
+	}
+
+	if ((size_t)sb.st_size < (1 + JOURNAL_MIN_BLOCKS) * JOURNAL_BLOCK)
+	{
+		close(fd);
+		return -ENODATA;
+	}
+
+	hdr = mmap(NULL, sb.st_size, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	if (hdr == MAP_FAILED)
+		return -errno;
+
+	if (__atomic_load_n(&hdr->magic, __ATOMIC_ACQUIRE) != JOURNAL_MAGIC || hdr->version != JOURNAL_VERSION ||
+	    hdr->block_size != JOURNAL_BLOCK || (uint64_t)(1 + hdr->num_blocks) * JOURNAL_BLOCK > (uint64_t)sb.st_size)
+	{
+		ret = -EINVAL;
+		goto out;
+	}
+
+	order = malloc(hdr->num_blocks * sizeof(*order));
+	copy = malloc(sizeof(*copy));
+	if (!order || !copy)
+	{
+		ret = -ENOMEM;
+		goto out;
+	}
+
+	for (i = 0; i < hdr->num_blocks; i++)
+	{
+		uint64_t seq = __atomic_load_n(&journal_block(hdr, i)->seq, __ATOMIC_ACQUIRE);
+
+		if (seq && seq % hdr->num_blocks == i)
+			order[n++] = (struct journal_order) { .seq = seq, .idx = i };
+	}
+	qsort(order, n, sizeof(*order), journal_order_cmp);
+
+	memset(state, 0, sizeof(state));
+
+	for (i = 0; i < n; i++)
+	{
+		const struct journal_block *b = journal_block(hdr, order[i].idx);
+		uint32_t used;
+
+		/* Copy the block, then make sure the writer did not reuse it meanwhile */
+		used = __atomic_load_n(&b->used, __ATOMIC_ACQUIRE);
+		if (used > sizeof(b->data))
+			continue;
+		memcpy(copy, b, offsetof(struct journal_block, data) + used);
+		if (__atomic_load_n(&b->seq, __ATOMIC_ACQUIRE) != order[i].seq || copy->seq != order[i].seq)
+			continue;
+
+		if (copy->ts_ns > to_ns)
+			break;
+
+		ret = journal_decode(copy, used, from_ns, to_ns, state, cb, data, &num);
+		if (ret)
+			break;
+	}
+
+out:
+	free(order);
+	free(copy);
+	munmap((void *)hdr, sb.st_size);
+
+	return ret < 0 ? ret : num;
+}
@@ -37,6 +37,7 @@ SOFTWARE.
 
 #define SYSFS_TYPEC_PATH "/sys/class/typec"
 #define SYSFS_PSY_PATH "/sys/class/power_supply"
+#define SYSFS_PD_PATH "/sys/class/usb_power_delivery"
 #define UCSI_DEBUGFS_PATH "/sys/kernel/debug/usb/ucsi/USBC000:00"
 
 /**
@@ -46,6 +47,47 @@ SOFTWARE.
 extern const struct libtypec_os_backend libtypec_lnx_dbgfs_backend;
 extern const struct libtypec_os_backend libtypec_lnx_sysfs_backend;
 extern libtypec_notification_list_t* registered_callbacks[USBC_EVENT_COUNT];
+extern enum libtypec_event_source libtypec_event_src;
+
+/* Internal op for libtypec_async_route(), buf is a struct libtypec_async_call */
+#define LIBTYPEC_ASYNC_CALL LIBTYPEC_ASYNC_OP_COUNT
+
+struct libtypec_async_call {
+    int (*fn)(void *arg);
+    void *arg;
+};
+
+int libtypec_async_route(struct libtypec_async_req *req, int *ret);
+int libtypec_get_connector_status_prio(int conn_num, struct libtypec_connector_status *conn_sts,
+                                       enum libtypec_async_prio prio);
+int libtypec_get_power_sample_prio(int conn_num, struct libtypec_power_sample *sample,
+                                   enum libtypec_async_prio prio);
+void libtypec_notify(enum usb_typec_event event, const struct libtypec_event_info *info);
+int libtypec_lnx_monitor_kernel_uevents(void);
+int libtypec_uevent_event(const char *action, const char *subsystem, const char *devpath,
+                          struct libtypec_event_info *info);
+
+#define LIBTYPEC_ATTR_LEN 64
+
+/* One sysfs attribute of a libtypec_read_attrs() batch */
+struct libtypec_attr {
+    const char *path;
+    char val[LIBTYPEC_ATTR_LEN];
+    int len;
+};
+
+int libtypec_read_attrs(struct libtypec_attr *attrs, int n);
+unsigned long libtypec_attr_ul(const struct libtypec_attr *a, int base, unsigned long dflt);
+void libtypec_alert_eval_status(int conn_num, const struct libtypec_connector_status *sts);
+void libtypec_alert_eval_sample(int conn_num, const struct libtypec_power_sample *sample);
+void libtypec_energy_account(int conn_num, const struct libtypec_power_sample *sample);
+int libtypec_journal_active(void);
+void libtypec_journal_event(enum usb_typec_event event, const struct libtypec_event_info *info);
+uint64_t libtypec_status_field(const struct libtypec_connector_status *sts, int field);
+void libtypec_notify_status_change(const struct libtypec_event_info *info);
+int libtypec_state_dir(const char *path);
+unsigned short libtypec_status_diff(const struct libtypec_connector_status *old,
+                                    const struct libtypec_connector_status *cur);
 
 struct libtypec_os_backend
 {
@@ -59,13 +101,15 @@ struct libtypec_os_backend
 
     int (*get_conn_capability_ops)(int conn_num, struct libtypec_connector_cap_data *conn_cap_data);
 
-    int (*get_alternate_modes)(int recipient, int conn_num, struct altmode_data *alt_mode_data);
+    /* Stores at most max modes, returns the number found */
+    int (*get_alternate_modes)(int recipient, int conn_num, struct altmode_data *alt_mode_data, int max);
 
     int (*get_cam_supported_ops)(int conn_num, char *cam_data);
 
     int (*get_current_cam_ops)(int conn_num, struct libtypec_current_cam *cur_cam);
 
-    int (*get_pdos_ops)(int conn_num, int partner, int offset, int *num_pdo, int src_snk, int type, struct libtypec_get_pdos *pdo_data);
+    /* Stores at most max PDOs starting at offset, returns the number stored */
+    int (*get_pdos_ops)(int conn_num, int partner, int offset, int *num_pdo, int src_snk, int type, unsigned int *pdo, int max);
 
     int (*get_cable_properties_ops)(int conn_num, struct libtypec_cable_property *cbl_prop_data);
 
@@ -92,6 +136,16 @@ struct libtypec_os_backend
     int (*set_new_cam_ops)(unsigned char conn_num, unsigned char entry_exit, unsigned char new_cam, unsigned int am_spec);
 
     int (*get_cam_cs_ops)(unsigned char conn_num, unsigned char cam, struct libtypec_get_cam_cs *cam_cs);
+
+    int (*set_cmd_arbitration_ops)(int mode, unsigned int max_wait_ms);
+
+    int (*run_cmd_broker_ops)(void);
+
+    int (*set_cmd_timeout_ops)(unsigned int timeout_ms);
+
+    int (*cancel_cmd_ops)(void);
+
+    int (*get_power_sample_ops)(int conn_num, struct libtypec_power_sample *sample);
 };
 
 #endif /*LIBTYPEC_OPS_H*/
@@ -0,0 +1,614 @@
+/*
+MIT License
+
+Copyright (c) 2022 Rajaram Regupathy <rajaram.regupathy@gmail.com>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+// SPDX-License-Identifier: MIT
+/**
+ * @file libtypec_profile.c
+ * @author Rajaram Regupathy <rajaram.regupathy@gmail.com>
+ * @brief Warm start cache of partner and cable profiles
+ *
+ * Reading what a partner or e-marked cable offers takes a command per PDO
+ * and alternate mode on some backends, although the same docks and cables
+ * come back again and again. Profiles are kept in a small mmapped file
+ * keyed by recipient and the full Discover Identity response, so a known
+ * device is described as soon as its identity has been read. The cached
+ * profile is then read again at background priority on the async engine
+ * and replaced if the device no longer matches it.
+ *
+ * Any number of processes can use the file. Slots are read lock free,
+ * a slot being written has an odd sequence count, and writers serialize
+ * on an exclusive flock() of the file.
+ */
+
+#include "libtypec.h"
+#include "libtypec_ops.h"
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/file.h>
+
+#define PROFILE_MAGIC 0x46525054	/* "TPRF" */
+#define PROFILE_VERSION 1
+#define PROFILE_READ_TRIES 100
+
+struct profile_slot {
+	/* Odd while the slot is being written */
+	uint32_t seq;
+	uint32_t in_use;
+	/* CLOCK_REALTIME time of the last hit or store, the oldest slot is reused */
+	uint64_t used_ns;
+	struct libtypec_profile p;
+};
+
+struct profile_file {
+	uint32_t magic;
+	uint32_t version;
+	uint32_t slot_size;
+	uint32_t num_slots;
+	struct profile_slot slot[LIBTYPEC_PROFILE_SLOTS];
+};
+
+/* Background check of a cached profile */
+struct profile_verify {
+	struct libtypec_async_req req;
+	int slot;
+	struct libtypec_profile cached;
+	struct libtypec_profile seen;
+};
+
+static struct {
+	pthread_mutex_t lock;
+	int fd;
+	int writable;
+	struct profile_file *f;
+	/* Slots with a verification queued by this process */
+	uint8_t verifying[LIBTYPEC_PROFILE_SLOTS];
+} prof = {
+	.lock = PTHREAD_MUTEX_INITIALIZER,
+	.fd = -1,
+};
+
+static uint64_t profile_now_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_REALTIME, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+/* Devices without PD or that did not answer Discover Identity have no key */
+static int profile_id_usable(const union libtypec_discovered_identity *id)
+{
+	return id->disc_id.id_header && id->disc_id.id_header != 0xffffffff;
+}
+
+static uint32_t profile_expected(int recipient)
+{
+	if (recipient == AM_SOP)
+		return LIBTYPEC_PROFILE_VALID_SRC | LIBTYPEC_PROFILE_VALID_SNK | LIBTYPEC_PROFILE_VALID_ALTMODES;
+
+	return LIBTYPEC_PROFILE_VALID_CABLE | LIBTYPEC_PROFILE_VALID_ALTMODES;
+}
+
+static int profile_same(const struct libtypec_profile *a, const struct libtypec_profile *b)
+{
+	uint32_t i;
+
+	if (a->valid != b->valid || a->num_src_pdos != b->num_src_pdos ||
+	    a->num_snk_pdos != b->num_snk_pdos || a->num_altmodes != b->num_altmodes ||
+	    memcmp(a->src_pdo, b->src_pdo, a->num_src_pdos * sizeof(a->src_pdo[0])) ||
+	    memcmp(a->snk_pdo, b->snk_pdo, a->num_snk_pdos * sizeof(a->snk_pdo[0])) ||
+	    memcmp(&a->cable, &b->cable, sizeof(a->cable)))
+		return 0;
+
+	for (i = 0; i < a->num_altmodes; i++)
+	{
+		if (a->altmode[i].svid != b->altmode[i].svid || a->altmode[i].vdo != b->altmode[i].vdo)
+			return 0;
+	}
+
+	return 1;
+}
+
+/* Copy a slot that may be written concurrently, 0 if the copy is consistent and sane */
+static int profile_slot_copy(struct profile_slot *s, struct libtypec_profile *p)
+{
+	uint32_t seq;
+	int i;
+
+	for (i = 0; i < PROFILE_READ_TRIES; i++)
+	{
+		seq = __atomic_load_n(&s->seq, __ATOMIC_ACQUIRE);
+		if (seq & 1)
+		{
+			sched_yield();
+			continue;
+		}
+
+		if (!__atomic_load_n(&s->in_use, __ATOMIC_RELAXED))
+			return -ENOENT;
+
+		memcpy(p, &s->p, sizeof(*p));
+		__atomic_thread_fence(__ATOMIC_ACQUIRE);
+		if (__atomic_load_n(&s->seq, __ATOMIC_RELAXED) != seq)
+			continue;
+
+		/* The file is shared, never trust its counts */
+		if (p->num_src_pdos > LIBTYPEC_MAX_PDOS || p->num_snk_pdos > LIBTYPEC_MAX_PDOS ||
+		    p->num_altmodes > LIBTYPEC_PROFILE_MAX_ALTMODES)
+			return -EINVAL;
+
+		return 0;
+	}
+
+	return -EAGAIN;
+}
+
+/* Called with prof.lock held */
+static int profile_find(int recipient, const union libtypec_discovered_identity *id,
+			struct libtypec_profile *p)
+{
+	int i;
+
+	for (i = 0; i < LIBTYPEC_PROFILE_SLOTS; i++)
+	{
+		struct profile_slot *s = &prof.f->slot[i];
+
+		if (s->p.recipient != (uint32_t)recipient || memcmp(&s->p.id, id, sizeof(*id)))
+			continue;
+
+		/* The slot may have been reused since the key was compared */
+		if (profile_slot_copy(s, p) < 0 || p->recipient != (uint32_t)recipient ||
+		    memcmp(&p->id, id, sizeof(*id)))
+			return -ENOENT;
+
+		if (prof.writable)
+			__atomic_store_n(&s->used_ns, profile_now_ns(), __ATOMIC_RELAXED);
+
+		return i;
+	}
+
+	return -ENOENT;
+}
+
+/**
+ * This function shall be used to start caching partner and cable profiles
+ * in a file. The file and its directory are created if needed; if it
+ * cannot be written the cache is used read only.
+ *
+ * \param path Cache file, NULL for LIBTYPEC_PROFILE_FILE
+ *
+ * \returns 0 on success, negative error code on failure
+ */
+int libtypec_profile_open(const char *path)
+{
+	struct profile_file *f;
+	struct stat sb;
+	int fd, writable = 1, ret = 0;
+
+	if (!path)
+		path = LIBTYPEC_PROFILE_FILE;
+
+	pthread_mutex_lock(&prof.lock);
+
+	if (prof.f)
+	{
+		ret = -EALREADY;
+		goto out;
+	}
+
+	libtypec_state_dir(path);
+
+	fd = open(path, O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+	if (fd < 0 && (errno == EACCES || errno == EROFS))
+	{
+		writable = 0;
+		fd = open(path, O_RDONLY | O_CLOEXEC);
+	}
+	if (fd < 0)
+	{
+		ret = -errno;
+		goto out;
+	}
+
+	if (writable && flock(fd, LOCK_EX) < 0)
+	{
+		ret = -errno;
+		goto err_close;
+	}
+
+	if (fstat(fd, &sb) < 0)
+	{
+		ret = -errno;
+		goto err_close;
+	}
+
+	if ((size_t)sb.st_size != sizeof(*f))
+	{
+		if (!writable)
+		{
+			ret = -EINVAL;
+			goto err_close;
+		}
+		if (ftruncate(fd, sizeof(*f)) < 0)
+		{
+			ret = -errno;
+			goto err_close;
+		}
+	}
+
+	f = mmap(NULL, sizeof(*f), writable ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, fd, 0);
+	if (f == MAP_FAILED)
+	{
+		ret = -errno;
+		goto err_close;
+	}
+
+	if (f->magic != PROFILE_MAGIC || f->version != PROFILE_VERSION ||
+	    f->slot_size != sizeof(struct profile_slot) || f->num_slots != LIBTYPEC_PROFILE_SLOTS)
+	{
+		if (!writable)
+		{
+			munmap(f, sizeof(*f));
+			ret = -EINVAL;
+			goto err_close;
+		}
+
+		/* New or incompatible cache, start over */
+		memset(f, 0, sizeof(*f));
+		f->version = PROFILE_VERSION;
+		f->slot_size = sizeof(struct profile_slot);
+		f->num_slots = LIBTYPEC_PROFILE_SLOTS;
+		__atomic_store_n(&f->magic, PROFILE_MAGIC, __ATOMIC_RELEASE);
+		msync(f, sizeof(*f), MS_ASYNC);
+	}
+
+	if (writable)
+		flock(fd, LOCK_UN);
+
+	prof.fd = fd;
+	prof.f = f;
+	prof.writable = writable;
+	memset(prof.verifying, 0, sizeof(prof.verifying));
+	goto out;
+
+err_close:
+	close(fd);
+out:
+	pthread_mutex_unlock(&prof.lock);
+	return ret;
+}
+
+/**
+ * This function shall be used to stop using the profile cache. Checks
+ * still queued on the async engine are not stored.
+ *
+ * \returns 0 on success
+ */
+int libtypec_profile_close(void)
+{
+	pthread_mutex_lock(&prof.lock);
+
+	if (prof.f)
+	{
+		munmap(prof.f, sizeof(*prof.f));
+		close(prof.fd);
+		prof.f = NULL;
+		prof.fd = -1;
+	}
+
+	pthread_mutex_unlock(&prof.lock);
+
+	return 0;
+}
+
+/**
+ * This function shall be used to look up the cached profile of a device
+ *
+ * \param recipient AM_SOP or AM_SOP_PR
+ * \param id Discover Identity response of the device
+ * \param profile Filled with the cached profile
+ *
+ * \returns 0 on success, -ENOENT if the device is not cached, -EIO if the
+ * cache is not open
+ */
+int libtypec_profile_lookup(int recipient, const union libtypec_discovered_identity *id,
+			    struct libtypec_profile *profile)
+{
+	int ret;
+
+	pthread_mutex_lock(&prof.lock);
+	ret = prof.f ? profile_find(recipient, id, profile) : -EIO;
+	pthread_mutex_unlock(&prof.lock);
+
+	return ret < 0 ? ret : 0;
+}
+
+/**
+ * This function shall be used to add or replace the cached profile of a
+ * device. The least recently used profile makes room when the cache is full.
+ *
+ * \param profile Profile to store, keyed by its recipient and id
+ *
+ * \returns 0 on success, -EINVAL for a profile without a usable identity
+ * or with counts beyond its arrays, -EIO if the cache is not open, -EROFS
+ * if it is read only
+ */
+int libtypec_profile_store(const struct libtypec_profile *profile)
+{
+	struct profile_slot *s, *victim = NULL;
+	uint32_t seq;
+	int i, ret = 0;
+
+	if ((profile->recipient != AM_SOP && profile->recipient != AM_SOP_PR) ||
+	    !profile_id_usable(&profile->id) || profile->num_src_pdos > LIBTYPEC_MAX_PDOS ||
+	    profile->num_snk_pdos > LIBTYPEC_MAX_PDOS || profile->num_altmodes > LIBTYPEC_PROFILE_MAX_ALTMODES)
+		return -EINVAL;
+
+	pthread_mutex_lock(&prof.lock);
+
+	if (!prof.f || !prof.writable)
+	{
+		ret = prof.f ? -EROFS : -EIO;
+		goto out;
+	}
+
+	flock(prof.fd, LOCK_EX);
+
+	for (i = 0; i < LIBTYPEC_PROFILE_SLOTS; i++)
+	{
+		s = &prof.f->slot[i];
+
+		if (s->in_use && s->p.recipient == profile->recipient &&
+		    !memcmp(&s->p.id, &profile->id, sizeof(profile->id)))
+		{
+			victim = s;
+			break;
+		}
+
+		if (!victim || (victim->in_use && (!s->in_use || s->used_ns < victim->used_ns)))
+			victim = s;
+	}
+
+	seq = victim->seq;
+	__atomic_store_n(&victim->seq, seq + 1, __ATOMIC_RELAXED);
+	__atomic_thread_fence(__ATOMIC_RELEASE);
+	victim->p = *profile;
+	victim->in_use = 1;
+	victim->used_ns = profile_now_ns();
+	__atomic_store_n(&victim->seq, seq + 2, __ATOMIC_RELEASE);
+
+	msync(prof.f, sizeof(*prof.f), MS_ASYNC);
+	flock(prof.fd, LOCK_UN);
+
+out:
+	pthread_mutex_unlock(&prof.lock);
+	return ret;
+}
+
+/* Read everything but the identity from the device */
+static void profile_read_data(int recipient, int conn_num, struct libtypec_profile *profile)
+{
+	struct libtypec_arena arena;
+	struct libtypec_pdo_view pdos;
+	struct libtypec_altmode_view modes;
+	int ret;
+
+	if (recipient == AM_SOP)
+	{
+		libtypec_arena_init(&arena, profile->src_pdo, sizeof(profile->src_pdo));
+		if (libtypec_get_pdos_view(conn_num, 1, 1, 0, &arena, &pdos) >= 0)
+		{
+			profile->num_src_pdos = pdos.num;
+			profile->valid |= LIBTYPEC_PROFILE_VALID_SRC;
+		}
+
+		libtypec_arena_init(&arena, profile->snk_pdo, sizeof(profile->snk_pdo));
+		if (libtypec_get_pdos_view(conn_num, 1, 0, 0, &arena, &pdos) >= 0)
+		{
+			profile->num_snk_pdos = pdos.num;
+			profile->valid |= LIBTYPEC_PROFILE_VALID_SNK;
+		}
+	}
+	else
+	{
+		profile->cable.cable_type = CABLE_TYPE_PASSIVE;
+		profile->cable.plug_end_type = PLUG_TYPE_OTH;
+		if (libtypec_get_cable_properties(conn_num, &profile->cable) >= 0)
+			profile->valid |= LIBTYPEC_PROFILE_VALID_CABLE;
+	}
+
+	/* Keep the first modes if there are more than a profile holds */
+	libtypec_arena_init(&arena, profile->altmode, sizeof(profile->altmode));
+	ret = libtypec_get_alternate_modes_view(recipient, conn_num, &arena, &modes);
+	if (ret >= 0 || ret == -ENOSPC)
+	{
+		profile->num_altmodes = modes.num;
+		profile->valid |= LIBTYPEC_PROFILE_VALID_ALTMODES;
+	}
+
+	profile->verified_ns = profile_now_ns();
+}
+
+/**
+ * This function shall be used to read the identity and profile of a partner
+ * or cable from the device, bypassing the cache
+ *
+ * \param recipient AM_SOP or AM_SOP_PR
+ * \param conn_num connector number
+ * \param profile Filled with what could be read, see profile->valid
+ *
+ * \returns 0 on success, -EINVAL for another recipient, negative error code
+ * if the identity could not be read
+ */
+int libtypec_profile_read(int recipient, int conn_num, struct libtypec_profile *profile)
+{
+	int ret;
+
+	if (recipient != AM_SOP && recipient != AM_SOP_PR)
+		return -EINVAL;
+
+	memset(profile, 0, sizeof(*profile));
+	profile->recipient = recipient;
+
+	ret = libtypec_get_pd_message(recipient, conn_num, sizeof(profile->id), DISCOVER_ID_REQ,
+				      profile->id.buf_disc_id);
+	if (ret < 0)
+		return ret;
+
+	profile_read_data(recipient, conn_num, profile);
+
+	return 0;
+}
+
+static void profile_verify_done(struct libtypec_async_req *req, void *data)
+{
+	struct profile_verify *v = data;
+	struct libtypec_event_info info;
+	uint32_t expected = profile_expected(v->cached.recipient);
+
+	/* A different device may have been attached meanwhile, its own connect events cover it */
+	if (req->ret >= 0 && (v->seen.valid & expected) == expected &&
+	    !memcmp(&v->seen.id, &v->cached.id, sizeof(v->seen.id)) &&
+	    libtypec_profile_store(&v->seen) == 0 && !profile_same(&v->cached, &v->seen))
+	{
+		memset(&info, 0, sizeof(info));
+		info.conn_num = req->conn_num;
+		info.changed.ConnectorPartnerChanged = 1;
+		libtypec_notify(USBC_PARTNER_CHANGED, &info);
+	}
+
+	pthread_mutex_lock(&prof.lock);
+	prof.verifying[v->slot] = 0;
+	pthread_mutex_unlock(&prof.lock);
+
+	free(v);
+}
+
+/* Called with prof.lock held */
+static int profile_verify(int slot, int conn_num, const struct libtypec_profile *cached)
+{
+	struct profile_verify *v;
+	int ret;
+
+	if (prof.verifying[slot])
+		return 0;
+
+	v = calloc(1, sizeof(*v));
+	if (!v)
+		return -ENOMEM;
+
+	v->slot = slot;
+	v->cached = *cached;
+	v->req.op = LIBTYPEC_ASYNC_READ_PROFILE;
+	v->req.prio = LIBTYPEC_ASYNC_PRIO_BACKGROUND;
+	v->req.conn_num = conn_num;
+	v->req.arg[0] = cached->recipient;
+	v->req.buf = &v->seen;
+	v->req.cb = profile_verify_done;
+	v->req.cb_data = v;
+
+	ret = libtypec_async_submit(&v->req);
+	if (ret < 0)
+	{
+		free(v);
+		return ret;
+	}
+
+	prof.verifying[slot] = 1;
+
+	return 0;
+}
+
+/**
+ * This function shall be used to get the profile of the partner or cable
+ * whose identity was just read. A device found in the cache is described
+ * from it right away, and if its profile was not read for
+ * LIBTYPEC_PROFILE_VERIFY_S it is read again at background priority on the
+ * async engine; a changed profile replaces the cached one and is reported
+ * as USBC_PARTNER_CHANGED. Without the async engine cached profiles are
+ * trusted for LIBTYPEC_PROFILE_MAX_AGE_S. Other devices are read from the
+ * device, and cached if their identity is usable and everything could be
+ * read.
+ *
+ * \param recipient AM_SOP or AM_SOP_PR
+ * \param conn_num connector number
+ * \param id Discover Identity response of the device, NULL if there is none
+ * \param profile Filled with the profile, see profile->valid
+ *
+ * \returns 1 if the profile came from the cache, 0 if it was read from the
+ * device, -EINVAL for another recipient
+ */
+int libtypec_get_profile(int recipient, int conn_num, const union libtypec_discovered_identity *id,
+			 struct libtypec_profile *profile)
+{
+	uint64_t now, age;
+	int slot = -ENOENT;
+
+	if (recipient != AM_SOP && recipient != AM_SOP_PR)
+		return -EINVAL;
+
+	if (id && profile_id_usable(id))
+	{
+		pthread_mutex_lock(&prof.lock);
+
+		if (prof.f)
+			slot = profile_find(recipient, id, profile);
+
+		if (slot >= 0)
+		{
+			now = profile_now_ns();
+			age = now > profile->verified_ns ? now - profile->verified_ns : 0;
+
+			if (age >= LIBTYPEC_PROFILE_VERIFY_S * 1000000000ull &&
+			    profile_verify(slot, conn_num, profile) < 0 &&
+			    age >= LIBTYPEC_PROFILE_MAX_AGE_S * 1000000000ull)
+				slot = -ESTALE;
+		}
+
+		pthread_mutex_unlock(&prof.lock);
+
+		if (slot >= 0)
+			return 1;
+	}
+
+	memset(profile, 0, sizeof(*profile));
+	profile->recipient = recipient;
+	if (id)
+		profile->id = *id;
+
+	profile_read_data(recipient, conn_num, profile);
+
+	if (id && (profile->valid & profile_expected(recipient)) == profile_expected(recipient))
+		libtypec_profile_store(profile);
+
+	return 0;
+}
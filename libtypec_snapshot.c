@@ -0,0 +1,579 @@
+/*
+MIT License
+
+Copyright (c) 2022 Rajaram Regupathy <rajaram.regupathy@gmail.com>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+// SPDX-License-Identifier: MIT
+/**
+ * @file libtypec_snapshot.c
+ * @author Rajaram Regupathy <rajaram.regupathy@gmail.com>
+ * @brief Structured snapshots of the PPM and its connectors
+ *
+ * A snapshot gathers everything lstypec shows into plain structures, read
+ * once, so that any number of output formats can be produced from it. The
+ * binary encoding is a flat list of 8 byte aligned records holding the
+ * libtypec.h objects as is; it can be mapped and read back without parsing.
+ */
+
+#include "libtypec.h"
+#include "libtypec_ops.h"
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+
+#define SNAP_MIN(a, b) ((a) < (b) ? (a) : (b))
+#define SNAP_ALIGN(n) (((n) + LIBTYPEC_SNAPSHOT_ALIGN - 1) & ~(size_t)(LIBTYPEC_SNAPSHOT_ALIGN - 1))
+
+/**
+ * This function shall be used to take a snapshot of one connector. Partner
+ * and cable objects are only read while a partner is attached, or when the
+ * backend cannot tell, and come from the profile cache for known devices,
+ * see libtypec_get_profile().
+ *
+ * \param conn_num connector number
+ * \param port Filled with the connector state
+ *
+ * \returns 0 on success, -EINVAL for a connector number a snapshot cannot hold
+ */
+int libtypec_snapshot_port(int conn_num, struct libtypec_port_snapshot *port)
+{
+	struct libtypec_arena arena;
+	struct libtypec_pdo_view pdos;
+	struct libtypec_altmode_view modes;
+	struct libtypec_profile profile;
+	int i, ret, attached = 1;
+
+	if (conn_num < 0 || conn_num >= LIBTYPEC_SNAPSHOT_MAX_PORTS)
+		return -EINVAL;
+
+	memset(port, 0, sizeof(*port));
+	port->conn_num = conn_num;
+
+	if (libtypec_get_conn_capability(conn_num, &port->cap) >= 0)
+		port->valid |= LIBTYPEC_SNAP_VALID_CAP;
+
+	if (libtypec_get_connector_status(conn_num, &port->status) >= 0)
+	{
+		port->valid |= LIBTYPEC_SNAP_VALID_STATUS;
+		attached = port->status.ConnectStatus;
+	}
+
+	for (i = LIBTYPEC_SNAP_PORT_SRC; i <= LIBTYPEC_SNAP_PORT_SNK; i++)
+	{
+		libtypec_arena_init(&arena, port->pdo[i], sizeof(port->pdo[i]));
+		if (libtypec_get_pdos_view(conn_num, 0, i == LIBTYPEC_SNAP_PORT_SRC, 0, &arena, &pdos) > 0)
+			port->num_pdos[i] = pdos.num;
+	}
+
+	/* Keep the first modes if there are more than the snapshot holds */
+	libtypec_arena_init(&arena, port->altmode[LIBTYPEC_SNAP_AM_PORT], sizeof(port->altmode[LIBTYPEC_SNAP_AM_PORT]));
+	ret = libtypec_get_alternate_modes_view(AM_CONNECTOR, conn_num, &arena, &modes);
+	if (ret >= 0 || ret == -ENOSPC)
+		port->num_altmodes[LIBTYPEC_SNAP_AM_PORT] = modes.num;
+
+	if (!attached)
+		return 0;
+
+	if (libtypec_get_pd_message(AM_SOP, conn_num, sizeof(port->partner_id),
+				    DISCOVER_ID_REQ, port->partner_id.buf_disc_id) >= 0)
+		port->valid |= LIBTYPEC_SNAP_VALID_PARTNER_ID;
+
+	if (libtypec_get_pd_message(AM_SOP_PR, conn_num, sizeof(port->cable_id),
+				    DISCOVER_ID_REQ, port->cable_id.buf_disc_id) >= 0)
+		port->valid |= LIBTYPEC_SNAP_VALID_CABLE_ID;
+
+	/* Known partners and cables are described from the profile cache */
+	libtypec_get_profile(AM_SOP, conn_num, port->valid & LIBTYPEC_SNAP_VALID_PARTNER_ID ?
+			     &port->partner_id : NULL, &profile);
+
+	port->num_pdos[LIBTYPEC_SNAP_PARTNER_SRC] = SNAP_MIN(profile.num_src_pdos, LIBTYPEC_MAX_PDOS);
+	memcpy(port->pdo[LIBTYPEC_SNAP_PARTNER_SRC], profile.src_pdo, sizeof(profile.src_pdo));
+	port->num_pdos[LIBTYPEC_SNAP_PARTNER_SNK] = SNAP_MIN(profile.num_snk_pdos, LIBTYPEC_MAX_PDOS);
+	memcpy(port->pdo[LIBTYPEC_SNAP_PARTNER_SNK], profile.snk_pdo, sizeof(profile.snk_pdo));
+	port->num_altmodes[LIBTYPEC_SNAP_AM_PARTNER] = SNAP_MIN(profile.num_altmodes, LIBTYPEC_SNAPSHOT_MAX_ALTMODES);
+	memcpy(port->altmode[LIBTYPEC_SNAP_AM_PARTNER], profile.altmode, sizeof(profile.altmode));
+
+	libtypec_get_profile(AM_SOP_PR, conn_num, port->valid & LIBTYPEC_SNAP_VALID_CABLE_ID ?
+			     &port->cable_id : NULL, &profile);
+
+	port->cable = profile.cable;
+	if (profile.valid & LIBTYPEC_PROFILE_VALID_CABLE)
+		port->valid |= LIBTYPEC_SNAP_VALID_CABLE;
+	port->num_altmodes[LIBTYPEC_SNAP_AM_CABLE] = SNAP_MIN(profile.num_altmodes, LIBTYPEC_SNAPSHOT_MAX_ALTMODES);
+	memcpy(port->altmode[LIBTYPEC_SNAP_AM_CABLE], profile.altmode, sizeof(profile.altmode));
+
+	return 0;
+}
+
+/**
+ * This function shall be used to take a snapshot of the PPM and all of its
+ * connectors, up to LIBTYPEC_SNAPSHOT_MAX_PORTS.
+ *
+ * \param snap Filled with the snapshot
+ *
+ * \returns number of connectors in the snapshot, negative on failure
+ */
+int libtypec_snapshot_take(struct libtypec_snapshot *snap)
+{
+	struct timespec ts;
+	int i, ret;
+
+	clock_gettime(CLOCK_REALTIME, &ts);
+	snap->ts_ns = (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+
+	ret = libtypec_get_capability(&snap->ppm);
+	if (ret < 0)
+		return ret;
+
+	snap->num_ports = snap->ppm.bNumConnectors;
+	if (snap->num_ports > LIBTYPEC_SNAPSHOT_MAX_PORTS)
+		snap->num_ports = LIBTYPEC_SNAPSHOT_MAX_PORTS;
+
+	for (i = 0; i < snap->num_ports; i++)
+		libtypec_snapshot_port(i, &snap->port[i]);
+
+	return snap->num_ports;
+}
+
+struct snap_writer {
+	unsigned char *buf;
+	size_t len;
+	size_t off;
+	uint32_t num;
+};
+
+static void snap_put(struct snap_writer *w, int type, int port, int list, const void *data, size_t size)
+{
+	struct libtypec_snapshot_rec rec = {
+		.type = type,
+		.port = port,
+		.list = list,
+		.len = size,
+	};
+	size_t need = sizeof(rec) + SNAP_ALIGN(size);
+
+	if (w->off + need <= w->len)
+	{
+		memcpy(w->buf + w->off, &rec, sizeof(rec));
+		memcpy(w->buf + w->off + sizeof(rec), data, size);
+		memset(w->buf + w->off + sizeof(rec) + size, 0, need - sizeof(rec) - size);
+	}
+
+	w->off += need;
+	w->num++;
+}
+
+/**
+ * This function shall be used to encode a snapshot into the binary record
+ * format described in libtypec.h. Empty lists and objects that could not be
+ * read are left out.
+ *
+ * \param snap Snapshot to encode
+ * \param buf Output buffer, 8 byte aligned
+ * \param len Size of buf; 0 to only get the size needed
+ *
+ * \returns size of the encoding. buf holds it only when that is not more
+ * than len
+ */
+int libtypec_snapshot_encode(const struct libtypec_snapshot *snap, void *buf, size_t len)
+{
+	struct snap_writer w = {
+		.buf = buf,
+		.len = len,
+		.off = SNAP_ALIGN(sizeof(struct libtypec_snapshot_hdr)),
+	};
+	int i, j;
+
+	snap_put(&w, LIBTYPEC_SNAP_REC_PPM, 0, 0, &snap->ppm, sizeof(snap->ppm));
+
+	for (i = 0; i < snap->num_ports; i++)
+	{
+		const struct libtypec_port_snapshot *port = &snap->port[i];
+
+		if (port->valid & LIBTYPEC_SNAP_VALID_CAP)
+			snap_put(&w, LIBTYPEC_SNAP_REC_PORT_CAP, i, 0, &port->cap, sizeof(port->cap));
+		if (port->valid & LIBTYPEC_SNAP_VALID_STATUS)
+			snap_put(&w, LIBTYPEC_SNAP_REC_PORT_STATUS, i, 0, &port->status, sizeof(port->status));
+		if (port->valid & LIBTYPEC_SNAP_VALID_CABLE)
+			snap_put(&w, LIBTYPEC_SNAP_REC_CABLE, i, 0, &port->cable, sizeof(port->cable));
+		if (port->valid & LIBTYPEC_SNAP_VALID_PARTNER_ID)
+			snap_put(&w, LIBTYPEC_SNAP_REC_PARTNER_ID, i, 0, &port->partner_id, sizeof(port->partner_id));
+		if (port->valid & LIBTYPEC_SNAP_VALID_CABLE_ID)
+			snap_put(&w, LIBTYPEC_SNAP_REC_CABLE_ID, i, 0, &port->cable_id, sizeof(port->cable_id));
+
+		for (j = 0; j < LIBTYPEC_SNAP_PDO_LISTS; j++)
+			if (port->num_pdos[j])
+				snap_put(&w, LIBTYPEC_SNAP_REC_PDOS, i, j, port->pdo[j],
+					 port->num_pdos[j] * sizeof(port->pdo[j][0]));
+
+		for (j = 0; j < LIBTYPEC_SNAP_AM_LISTS; j++)
+			if (port->num_altmodes[j])
+				snap_put(&w, LIBTYPEC_SNAP_REC_ALTMODES, i, j, port->altmode[j],
+					 port->num_altmodes[j] * sizeof(port->altmode[j][0]));
+	}
+
+	if (w.off <= len)
+	{
+		struct libtypec_snapshot_hdr hdr = {
+			.magic = LIBTYPEC_SNAPSHOT_MAGIC,
+			.version = LIBTYPEC_SNAPSHOT_VERSION,
+			.hdr_size = SNAP_ALIGN(sizeof(hdr)),
+			.total_len = w.off,
+			.num_records = w.num,
+			.ts_ns = snap->ts_ns,
+		};
+
+		memset(buf, 0, hdr.hdr_size);
+		memcpy(buf, &hdr, sizeof(hdr));
+	}
+
+	return w.off;
+}
+
+/**
+ * This function shall be used to walk the records of an encoded snapshot,
+ * typically a mapped file. The payload of a record follows it directly.
+ *
+ * \param buf Encoded snapshot, 8 byte aligned
+ * \param len Size of buf
+ * \param rec Previous record, NULL to get the first one
+ *
+ * \returns next record, NULL at the end or when buf is not a snapshot of a
+ * known version
+ */
+const struct libtypec_snapshot_rec *libtypec_snapshot_next(const void *buf, size_t len,
+							   const struct libtypec_snapshot_rec *rec)
+{
+	const struct libtypec_snapshot_hdr *hdr = buf;
+	size_t off;
+
+	if (len < sizeof(*hdr) || memcmp(hdr->magic, LIBTYPEC_SNAPSHOT_MAGIC, sizeof(hdr->magic)) ||
+	    hdr->version != LIBTYPEC_SNAPSHOT_VERSION || hdr->total_len > len)
+		return NULL;
+
+	len = hdr->total_len;
+	if (!rec)
+		off = hdr->hdr_size;
+	else
+		off = (const unsigned char *)rec - (const unsigned char *)buf + sizeof(*rec) + SNAP_ALIGN(rec->len);
+
+	if (off % LIBTYPEC_SNAPSHOT_ALIGN || off > len || len - off < sizeof(*rec))
+		return NULL;
+
+	rec = (const struct libtypec_snapshot_rec *)((const unsigned char *)buf + off);
+	if (rec->len > len - off - sizeof(*rec))
+		return NULL;
+
+	return rec;
+}
+
+/*
+ * Field getters. Each list is X(field id, name, value) with the object in s;
+ * the bitfields are read one by one so packing and reserved bits never
+ * show up as differences.
+ */
+#define PPM_FIELDS(X) \
+	X(LIBTYPEC_FIELD_PPM_ATTRIBUTES, "attributes", s->bmAttributes.raw_attrs) \
+	X(LIBTYPEC_FIELD_PPM_NUM_CONNECTORS, "num_connectors", s->bNumConnectors) \
+	X(LIBTYPEC_FIELD_PPM_OPTIONAL_FEATURES, "optional_features", \
+	  s->bmOptionalFeatures.raw_optfeas[0] | s->bmOptionalFeatures.raw_optfeas[1] << 8 | \
+	  s->bmOptionalFeatures.raw_optfeas[2] << 16) \
+	X(LIBTYPEC_FIELD_PPM_NUM_ALT_MODES, "num_alt_modes", s->bNumAltModes) \
+	X(LIBTYPEC_FIELD_PPM_BC_VERSION, "bc_version", s->bcdBCVersion) \
+	X(LIBTYPEC_FIELD_PPM_PD_VERSION, "pd_version", s->bcdPDVersion) \
+	X(LIBTYPEC_FIELD_PPM_TYPEC_VERSION, "typec_version", s->bcdTypeCVersion)
+
+#define CAP_FIELDS(X) \
+	X(LIBTYPEC_FIELD_CAP_OPERATION_MODE, "operation_mode", s->opr_mode.raw_operationmode) \
+	X(LIBTYPEC_FIELD_CAP_PROVIDER, "provider", s->provider) \
+	X(LIBTYPEC_FIELD_CAP_CONSUMER, "consumer", s->consumer) \
+	X(LIBTYPEC_FIELD_CAP_SWAP_TO_DFP, "swap_to_dfp", s->swap2dfp) \
+	X(LIBTYPEC_FIELD_CAP_SWAP_TO_UFP, "swap_to_ufp", s->swap2ufp) \
+	X(LIBTYPEC_FIELD_CAP_SWAP_TO_SRC, "swap_to_src", s->swap2src) \
+	X(LIBTYPEC_FIELD_CAP_SWAP_TO_SNK, "swap_to_snk", s->swap2snk) \
+	X(LIBTYPEC_FIELD_CAP_EXTENDED_OPERATION_MODE, "extended_operation_mode", s->extended_operation_mode) \
+	X(LIBTYPEC_FIELD_CAP_MISCELLANEOUS, "miscellaneous_capabilities", s->miscellaneous_capabilities) \
+	X(LIBTYPEC_FIELD_CAP_REVERSE_CURRENT_PROTECTION, "reverse_current_protection", \
+	  s->reverse_current_protection_support) \
+	X(LIBTYPEC_FIELD_CAP_PARTNER_PD_REV, "partner_pd_revision", s->partner_pd_rev)
+
+#define STATUS_FIELDS(X) \
+	X(LIBTYPEC_FIELD_STATUS_CHANGE, "change", s->ConnectorStatusChange.raw_conn_stschang) \
+	X(LIBTYPEC_FIELD_STATUS_POWER_OPERATION_MODE, "power_operation_mode", s->PowerOperationMode) \
+	X(LIBTYPEC_FIELD_STATUS_CONNECT, "connected", s->ConnectStatus) \
+	X(LIBTYPEC_FIELD_STATUS_POWER_DIRECTION, "power_direction", s->PowerDirection) \
+	X(LIBTYPEC_FIELD_STATUS_PARTNER_FLAGS, "partner_flags", s->ConnectorPartnerFlags) \
+	X(LIBTYPEC_FIELD_STATUS_PARTNER_TYPE, "partner_type", s->ConnectorPartnerType) \
+	X(LIBTYPEC_FIELD_STATUS_RDO, "rdo", s->RequestDataObject) \
+	X(LIBTYPEC_FIELD_STATUS_BATTERY_CHARGING, "battery_charging", s->BatteryChargingCapabilityStatus) \
+	X(LIBTYPEC_FIELD_STATUS_LIMITED_REASON, "limited_reason", s->ProviderCapabilitiesLimitedReason) \
+	X(LIBTYPEC_FIELD_STATUS_PD_VERSION, "pd_version", s->bcdPDVersionOperationMode) \
+	X(LIBTYPEC_FIELD_STATUS_ORIENTATION, "orientation", s->Orientation) \
+	X(LIBTYPEC_FIELD_STATUS_SINK_PATH, "sink_path", s->SinkPathStatus) \
+	X(LIBTYPEC_FIELD_STATUS_REVERSE_CURRENT_PROTECTION, "reverse_current_protection", \
+	  s->ReverseCurrentProtectionStatus) \
+	X(LIBTYPEC_FIELD_STATUS_POWER_READING_READY, "power_reading_ready", s->PowerReadingReady) \
+	X(LIBTYPEC_FIELD_STATUS_CURRENT_SCALE, "current_scale", s->CurrentScale) \
+	X(LIBTYPEC_FIELD_STATUS_PEAK_CURRENT, "peak_current", s->PeakCurrent) \
+	X(LIBTYPEC_FIELD_STATUS_AVERAGE_CURRENT, "average_current", s->AverageCurrent) \
+	X(LIBTYPEC_FIELD_STATUS_VOLTAGE_SCALE, "voltage_scale", s->VoltageScale) \
+	X(LIBTYPEC_FIELD_STATUS_VOLTAGE_READING, "voltage_reading", s->VoltageReading)
+
+#define CABLE_FIELDS(X) \
+	X(LIBTYPEC_FIELD_CABLE_SPEED, "speed_supported", s->speed_supported) \
+	X(LIBTYPEC_FIELD_CABLE_CURRENT, "current_capability", s->current_capability) \
+	X(LIBTYPEC_FIELD_CABLE_VBUS_SUPPORT, "vbus_support", s->vbus_support) \
+	X(LIBTYPEC_FIELD_CABLE_TYPE, "cable_type", s->cable_type) \
+	X(LIBTYPEC_FIELD_CABLE_DIRECTIONALITY, "directionality", s->directionality) \
+	X(LIBTYPEC_FIELD_CABLE_PLUG_END_TYPE, "plug_end_type", s->plug_end_type) \
+	X(LIBTYPEC_FIELD_CABLE_MODE_SUPPORT, "mode_support", s->mode_support) \
+	X(LIBTYPEC_FIELD_CABLE_PD_REVISION, "pd_revision", s->cable_pd_revision) \
+	X(LIBTYPEC_FIELD_CABLE_LATENCY, "latency", s->latency)
+
+#define ID_FIELDS(X) \
+	X(LIBTYPEC_FIELD_ID_CERT_STAT, "cert_stat", s->disc_id.cert_stat) \
+	X(LIBTYPEC_FIELD_ID_HEADER, "id_header", s->disc_id.id_header) \
+	X(LIBTYPEC_FIELD_ID_PRODUCT, "product", s->disc_id.product) \
+	X(LIBTYPEC_FIELD_ID_PRODUCT_TYPE_VDO1, "product_type_vdo1", s->disc_id.product_type_vdo1) \
+	X(LIBTYPEC_FIELD_ID_PRODUCT_TYPE_VDO2, "product_type_vdo2", s->disc_id.product_type_vdo2) \
+	X(LIBTYPEC_FIELD_ID_PRODUCT_TYPE_VDO3, "product_type_vdo3", s->disc_id.product_type_vdo3)
+
+#define FIELD_CASE(id, name, value) case id: return value;
+#define FIELD_NAME(id, name, value) [id] = name,
+
+static uint64_t ppm_field(const struct libtypec_capability_data *s, int field)
+{
+	switch (field) { PPM_FIELDS(FIELD_CASE) }
+	return 0;
+}
+
+static uint64_t cap_field(const struct libtypec_connector_cap_data *s, int field)
+{
+	switch (field) { CAP_FIELDS(FIELD_CASE) }
+	return 0;
+}
+
+static uint64_t status_field(const struct libtypec_connector_status *s, int field)
+{
+	switch (field) { STATUS_FIELDS(FIELD_CASE) }
+	return 0;
+}
+
+static uint64_t cable_field(const struct libtypec_cable_property *s, int field)
+{
+	switch (field) { CABLE_FIELDS(FIELD_CASE) }
+	return 0;
+}
+
+static uint64_t id_field(const union libtypec_discovered_identity *s, int field)
+{
+	switch (field) { ID_FIELDS(FIELD_CASE) }
+	return 0;
+}
+
+/* For the journal, which keeps connector status as snapshot fields */
+uint64_t libtypec_status_field(const struct libtypec_connector_status *sts, int field)
+{
+	return status_field(sts, field);
+}
+
+static const char *const ppm_field_names[LIBTYPEC_FIELD_PPM_COUNT] = { PPM_FIELDS(FIELD_NAME) };
+static const char *const cap_field_names[LIBTYPEC_FIELD_CAP_COUNT] = { CAP_FIELDS(FIELD_NAME) };
+static const char *const status_field_names[LIBTYPEC_FIELD_STATUS_COUNT] = { STATUS_FIELDS(FIELD_NAME) };
+static const char *const cable_field_names[LIBTYPEC_FIELD_CABLE_COUNT] = { CABLE_FIELDS(FIELD_NAME) };
+static const char *const id_field_names[LIBTYPEC_FIELD_ID_COUNT] = { ID_FIELDS(FIELD_NAME) };
+
+struct diff_out {
+	struct libtypec_snapshot_change *change;
+	int max;
+	int num;
+};
+
+static void diff_put(struct diff_out *d, int port, int object, int list, int field, uint64_t prev, uint64_t cur)
+{
+	if (d->num < d->max)
+		d->change[d->num] = (struct libtypec_snapshot_change) {
+			.port = port,
+			.object = object,
+			.list = list,
+			.field = field,
+			.old_value = prev,
+			.new_value = cur,
+		};
+	d->num++;
+}
+
+/* Report a change of presence, then what differs from an all zero object */
+static int diff_valid(struct diff_out *d, int port, int object, uint32_t prev, uint32_t cur, uint32_t bit)
+{
+	if ((prev ^ cur) & bit)
+		diff_put(d, port, object, 0, LIBTYPEC_FIELD_PRESENT, !!(prev & bit), !!(cur & bit));
+
+	return (prev | cur) & bit;
+}
+
+#define DIFF_FIELDS(d, port, object, count, get, prev, cur) \
+	for (int f = 0; f < (count); f++) \
+	{ \
+		uint64_t a = get(prev, f), b = get(cur, f); \
+		if (a != b) \
+			diff_put(d, port, object, 0, f, a, b); \
+	}
+
+/* An object of p and c guarded by a LIBTYPEC_SNAP_VALID_* bit */
+#define DIFF_OBJECT(d, port, object, bit, count, get, member) \
+	if (diff_valid(d, port, object, p->valid, c->valid, bit)) \
+		DIFF_FIELDS(d, port, object, count, get, \
+			    p->valid & (bit) ? &p->member : &zero.member, \
+			    c->valid & (bit) ? &c->member : &zero.member)
+
+static void diff_port(struct diff_out *d, int port, const struct libtypec_port_snapshot *prev,
+		      const struct libtypec_port_snapshot *cur)
+{
+	static const struct libtypec_port_snapshot zero;
+	const struct libtypec_port_snapshot *p = prev ? prev : &zero;
+	const struct libtypec_port_snapshot *c = cur ? cur : &zero;
+	int i, n;
+
+	DIFF_OBJECT(d, port, LIBTYPEC_SNAP_REC_PORT_CAP, LIBTYPEC_SNAP_VALID_CAP,
+		    LIBTYPEC_FIELD_CAP_COUNT, cap_field, cap);
+	DIFF_OBJECT(d, port, LIBTYPEC_SNAP_REC_PORT_STATUS, LIBTYPEC_SNAP_VALID_STATUS,
+		    LIBTYPEC_FIELD_STATUS_COUNT, status_field, status);
+	DIFF_OBJECT(d, port, LIBTYPEC_SNAP_REC_CABLE, LIBTYPEC_SNAP_VALID_CABLE,
+		    LIBTYPEC_FIELD_CABLE_COUNT, cable_field, cable);
+	DIFF_OBJECT(d, port, LIBTYPEC_SNAP_REC_PARTNER_ID, LIBTYPEC_SNAP_VALID_PARTNER_ID,
+		    LIBTYPEC_FIELD_ID_COUNT, id_field, partner_id);
+	DIFF_OBJECT(d, port, LIBTYPEC_SNAP_REC_CABLE_ID, LIBTYPEC_SNAP_VALID_CABLE_ID,
+		    LIBTYPEC_FIELD_ID_COUNT, id_field, cable_id);
+
+	for (int list = 0; list < LIBTYPEC_SNAP_PDO_LISTS; list++)
+	{
+		n = p->num_pdos[list] > c->num_pdos[list] ? p->num_pdos[list] : c->num_pdos[list];
+		for (i = 0; i < n; i++)
+		{
+			uint32_t a = i < p->num_pdos[list] ? p->pdo[list][i] : 0;
+			uint32_t b = i < c->num_pdos[list] ? c->pdo[list][i] : 0;
+
+			if (a != b)
+				diff_put(d, port, LIBTYPEC_SNAP_REC_PDOS, list, i, a, b);
+		}
+	}
+
+	for (int list = 0; list < LIBTYPEC_SNAP_AM_LISTS; list++)
+	{
+		n = p->num_altmodes[list] > c->num_altmodes[list] ? p->num_altmodes[list] : c->num_altmodes[list];
+		for (i = 0; i < n; i++)
+		{
+			const struct altmode_data *a = i < p->num_altmodes[list] ? &p->altmode[list][i] : NULL;
+			const struct altmode_data *b = i < c->num_altmodes[list] ? &c->altmode[list][i] : NULL;
+			uint64_t va = a ? (uint64_t)a->svid << 32 | a->vdo : 0;
+			uint64_t vb = b ? (uint64_t)b->svid << 32 | b->vdo : 0;
+
+			if (va != vb)
+				diff_put(d, port, LIBTYPEC_SNAP_REC_ALTMODES, list, i, va, vb);
+		}
+	}
+}
+
+/**
+ * This function shall be used to find the fields that differ between two
+ * snapshots of the same connector, e.g. to send only what changed.
+ *
+ * \param prev Earlier snapshot
+ * \param cur Later snapshot
+ * \param out Filled with up to max changes, in libtypec.h field order
+ * \param max Size of out; 0 to only count the changes
+ *
+ * \returns number of changes, which may be more than max
+ */
+int libtypec_snapshot_port_diff(const struct libtypec_port_snapshot *prev, const struct libtypec_port_snapshot *cur,
+				struct libtypec_snapshot_change *out, int max)
+{
+	struct diff_out d = { .change = out, .max = max };
+
+	diff_port(&d, cur->conn_num, prev, cur);
+
+	return d.num;
+}
+
+/**
+ * This function shall be used to find the fields that differ between two
+ * snapshots of the system. PPM changes are reported with port 0; a
+ * connector only one of the snapshots holds compares against an empty one.
+ *
+ * \param prev Earlier snapshot
+ * \param cur Later snapshot
+ * \param out Filled with up to max changes
+ * \param max Size of out; 0 to only count the changes
+ *
+ * \returns number of changes, which may be more than max
+ */
+int libtypec_snapshot_diff(const struct libtypec_snapshot *prev, const struct libtypec_snapshot *cur,
+			   struct libtypec_snapshot_change *out, int max)
+{
+	struct diff_out d = { .change = out, .max = max };
+	int num_ports = prev->num_ports > cur->num_ports ? prev->num_ports : cur->num_ports;
+
+	DIFF_FIELDS(&d, 0, LIBTYPEC_SNAP_REC_PPM, LIBTYPEC_FIELD_PPM_COUNT, ppm_field, &prev->ppm, &cur->ppm);
+
+	for (int i = 0; i < num_ports; i++)
+		diff_port(&d, i, i < prev->num_ports ? &prev->port[i] : NULL,
+			  i < cur->num_ports ? &cur->port[i] : NULL);
+
+	return d.num;
+}
+
+/**
+ * This function shall be used to name a field of a snapshot change
+ *
+ * \param object LIBTYPEC_SNAP_REC_* type of the object
+ * \param field Field of the object
+ *
+ * \returns name of the field, "present" for LIBTYPEC_FIELD_PRESENT, "pdo"
+ * and "alt_mode" for list entries, NULL when unknown
+ */
+const char *libtypec_snapshot_field_name(int object, int field)
+{
+	if (field == LIBTYPEC_FIELD_PRESENT)
+		return "present";
+
+	switch (object)
+	{
+	case LIBTYPEC_SNAP_REC_PPM:
+		return field >= 0 && field < LIBTYPEC_FIELD_PPM_COUNT ? ppm_field_names[field] : NULL;
+	case LIBTYPEC_SNAP_REC_PORT_CAP:
+		return field >= 0 && field < LIBTYPEC_FIELD_CAP_COUNT ? cap_field_names[field] : NULL;
+	case LIBTYPEC_SNAP_REC_PORT_STATUS:
+		return field >= 0 && field < LIBTYPEC_FIELD_STATUS_COUNT ? status_field_names[field] : NULL;
+	case LIBTYPEC_SNAP_REC_CABLE:
+		return field >= 0 && field < LIBTYPEC_FIELD_CABLE_COUNT ? cable_field_names[field] : NULL;
+	case LIBTYPEC_SNAP_REC_PARTNER_ID:
+	case LIBTYPEC_SNAP_REC_CABLE_ID:
+		return field >= 0 && field < LIBTYPEC_FIELD_ID_COUNT ? id_field_names[field] : NULL;
+	case LIBTYPEC_SNAP_REC_PDOS:
+		return field >= 0 && field < LIBTYPEC_MAX_PDOS ? "pdo" : NULL;
+	case LIBTYPEC_SNAP_REC_ALTMODES:
+		return field >= 0 && field < LIBTYPEC_SNAPSHOT_MAX_ALTMODES ? "alt_mode" : NULL;
+	}
+
+	return NULL;
+}
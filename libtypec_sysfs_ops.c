@@ -30,9 +30,11 @@ SOFTWARE.
  */
 
 /**
- *  required for enalbing nftw(), which is part of SUSv1.
+ *  required for enalbing nftw(), which is part of SUSv1. POSIX.1-2008 for
+ *  O_CLOEXEC, _DEFAULT_SOURCE for getdtablesize().
  */
-#define _XOPEN_SOURCE 500
+#define _DEFAULT_SOURCE
+#define _XOPEN_SOURCE 700
 
 #include "libtypec_ops.h"
 #include <dirent.h>
@@ -49,6 +51,9 @@ SOFTWARE.
 #include <fcntl.h>
 #include <unistd.h>
 #include <libudev.h>
+#include <limits.h>
+#include <pthread.h>
+#include <poll.h>
 
 #define MAX_PORT_STR 7		/* port%d with 7 bit numPorts */
 #define MAX_PORT_MODE_STR 7 /* port%d with 5+2 bit numPorts */
@@ -104,28 +109,6 @@ static unsigned long get_hex_dword_from_path(char *path)
 	return dword;
 }
 
-static unsigned long get_dword_from_path(char *path)
-{
-	char buf[64];
-	unsigned long dword=0;
-
-	FILE *fp = fopen(path, "r");
-
-	if (fp)
-	{
-		if (fgets(buf, 64, fp) == NULL)
-                {
-		        fclose(fp);
-			return -1;
-                }
-		dword = strtoul(buf, NULL, 10);
-
-		fclose(fp);
-	}
-
-	return dword;
-}
-
 unsigned char get_opr_mode(char *path)
 {
 	char buf[64];
@@ -306,106 +289,88 @@ static int get_cable_mode_support(char *path)
 
 	return ret;
 }
-static unsigned int get_variable_supply_pdo(char *path, int src_snk)
-{
-	char port_content[1024];
-	union libtypec_variable_supply_src var_src;
-	unsigned int tmp;
+/*
+ * Attributes of each PDO type, indexed by src_snk. The decoders take the
+ * values in this order, so all PDOs of a port are read in a single batch.
+ */
+#define PDO_ATTR_MAX 8
+#define SYSFS_ATTR_PATH_LEN 160
+
+static const char *const fixed_pdo_attrs[2][PDO_ATTR_MAX] = {
+	{ "dual_role_power", "higher_capability", "unconstrained_power", "usb_communication_capable",
+	  "dual_role_data", "fast_role_swap_current", "voltage", "operational_current" },
+	{ "dual_role_power", "usb_suspend_supported", "unconstrained_power", "usb_communication_capable",
+	  "dual_role_data", "unchunked_extended_messages_supported", "voltage", "maximum_current" },
+};
 
-	var_src.obj_var_sply.type = PDO_VARIABLE;
-	
-	snprintf(port_content, sizeof(port_content), "%s/%s", path, "maximum_voltage");
-	tmp = get_dword_from_path(port_content);
-	var_src.obj_var_sply.max_volt = tmp/50;
+static const char *const variable_pdo_attrs[2][PDO_ATTR_MAX] = {
+	{ "maximum_voltage", "minimum_voltage", "operational_current" },
+	{ "maximum_voltage", "minimum_voltage", "maximum_current" },
+};
 
-	snprintf(port_content, sizeof(port_content), "%s/%s", path, "minimum_voltage");
-	tmp = get_dword_from_path(port_content);
-	var_src.obj_var_sply.min_volt = tmp/50;
+static const char *const battery_pdo_attrs[2][PDO_ATTR_MAX] = {
+	{ "maximum_voltage", "minimum_voltage", "operational_power" },
+	{ "maximum_voltage", "minimum_voltage", "maximum_power" },
+};
 
-	if(src_snk)
-	{
-		snprintf(port_content, sizeof(port_content), "%s/%s", path, "maximum_current");
-		tmp = get_dword_from_path(port_content);
-		var_src.obj_var_sply.max_cur = tmp/10;
-	}
-	else
-	{
-		snprintf(port_content, sizeof(port_content), "%s/%s", path, "operational_current");
-		tmp = get_dword_from_path(port_content);
-		var_src.obj_var_sply.max_cur = tmp/10;		
-	}
-	return var_src.variable_supply;
+static const char *const pps_pdo_attrs[2][PDO_ATTR_MAX] = {
+	{ "maximum_voltage", "minimum_voltage", "maximum_current" },
+	{ "maximum_voltage", "minimum_voltage", "maximum_current", "pps_power_limited" },
+};
 
-}
-static unsigned int get_battery_supply_pdo(char *path, int src_snk)
+static const char *const epr_avs_pdo_attrs[2][PDO_ATTR_MAX] = {
+	{ "maximum_voltage", "minimum_voltage", "pdp" },
+	{ "maximum_voltage", "minimum_voltage", "pdp", "peak_current" },
+};
+
+static const char *const spr_avs_pdo_attrs[2][PDO_ATTR_MAX] = {
+	{ "maximum_current_15V", "maximum_current_20V" },
+	{ "maximum_current_15V", "maximum_current_20V", "peak_current" },
+};
+
+static unsigned int get_variable_supply_pdo(const unsigned long *v, int src_snk)
 {
-	char port_content[512 + 512];
-	union libtypec_battery_supply_src bat_src;
-	unsigned int tmp;
+	union libtypec_variable_supply_src var_src = {0};
 
-	bat_src.obj_bat_sply.type = 2;
+	var_src.obj_var_sply.type = PDO_VARIABLE;
+	var_src.obj_var_sply.max_volt = v[0]/50;
+	var_src.obj_var_sply.min_volt = v[1]/50;
+	var_src.obj_var_sply.max_cur = v[2]/10;
 
-	snprintf(port_content, sizeof(port_content), "%s/%s", path, "maximum_voltage");
-	tmp = get_dword_from_path(port_content);
-	bat_src.obj_bat_sply.max_volt = tmp/50;
+	return var_src.variable_supply;
+}
 
-	snprintf(port_content, sizeof(port_content), "%s/%s", path, "minimum_voltage");
-	tmp = get_dword_from_path(port_content);
-	bat_src.obj_bat_sply.min_volt = tmp/50;
-	
-	if(src_snk)
-	{
-		snprintf(port_content, sizeof(port_content), "%s/%s", path, "maximum_power");
-		tmp = get_dword_from_path(port_content);
-		bat_src.obj_bat_sply.max_pwr = tmp/250;
-	}
-	else
-	{
-		snprintf(port_content, sizeof(port_content), "%s/%s", path, "operational_power");
-		tmp = get_dword_from_path(port_content);
-		bat_src.obj_bat_sply.max_pwr = tmp/250;
+static unsigned int get_battery_supply_pdo(const unsigned long *v, int src_snk)
+{
+	union libtypec_battery_supply_src bat_src = {0};
 
+	bat_src.obj_bat_sply.type = PDO_BATTERY;
+	bat_src.obj_bat_sply.max_volt = v[0]/50;
+	bat_src.obj_bat_sply.min_volt = v[1]/50;
+	bat_src.obj_bat_sply.max_pwr = v[2]/250;
 
-	}
 	return bat_src.battery_supply;
-
 }
-static unsigned int get_programmable_supply_pdo(char *path, int src_snk)
+
+static unsigned int get_programmable_supply_pdo(const unsigned long *v, int src_snk)
 {
-	char port_content[512 + 512];
-	union libtypec_pps_src pps_src={0};
-	unsigned int tmp;
+	union libtypec_pps_src pps_src = {0};
 
-	pps_src.obj_pps_sply.type = 3;
+	pps_src.obj_pps_sply.type = PDO_AUGMENTED;
+	pps_src.obj_pps_sply.pps_type = APDO_SPR_PPS;
 	if(src_snk)
-	{
-		snprintf(port_content, sizeof(port_content), "%s/%s", path, "pps_power_limited");
-		pps_src.obj_pps_sply.pwr_ltd = get_dword_from_path(port_content);
-	}
-
-	snprintf(port_content, sizeof(port_content), "%s/%s", path, "maximum_voltage");
-	tmp = get_dword_from_path(port_content);
-	pps_src.obj_pps_sply.max_volt = tmp/100;
-
-	snprintf(port_content, sizeof(port_content), "%s/%s", path, "minimum_voltage");
-	tmp = get_dword_from_path(port_content);
-	pps_src.obj_pps_sply.min_volt = tmp/100;
-
-	snprintf(port_content, sizeof(port_content), "%s/%s", path, "maximum_current");
-	tmp = get_dword_from_path(port_content);
-	pps_src.obj_pps_sply.max_cur = tmp/50;
-
+		pps_src.obj_pps_sply.pwr_ltd = v[3];
+	pps_src.obj_pps_sply.max_volt = v[0]/100;
+	pps_src.obj_pps_sply.min_volt = v[1]/100;
+	pps_src.obj_pps_sply.max_cur = v[2]/50;
 
 	return pps_src.spr_pps_supply;
-
 }
-static unsigned int get_fixed_supply_pdo(char *path, int src_snk)
+
+static unsigned int get_fixed_supply_pdo(const unsigned long *v, int src_snk)
 {
-	char port_content[512 + 512];
 	union libtypec_fixed_supply_src fxd_src;
 	union libtypec_fixed_supply_snk fxd_snk;
-	
-	unsigned int tmp;
 
 	memset(&fxd_src, 0, sizeof(fxd_src));
 	memset(&fxd_snk, 0, sizeof(fxd_snk));
@@ -413,73 +378,101 @@ static unsigned int get_fixed_supply_pdo(char *path, int src_snk)
 	if(src_snk)
 	{
 		fxd_src.obj_fixed_sply.type = 0;
-		
-		snprintf(port_content, sizeof(port_content), "%s/%s", path, "dual_role_power");
-		fxd_src.obj_fixed_sply.dual_pwr = get_dword_from_path(port_content);
-		
-		snprintf(port_content, sizeof(port_content), "%s/%s", path, "usb_suspend_supported");
-		fxd_src.obj_fixed_sply.usb_suspend = get_dword_from_path(port_content);
-		
-		snprintf(port_content, sizeof(port_content), "%s/%s", path, "unconstrained_power");
-		fxd_src.obj_fixed_sply.uncons_pwr = get_dword_from_path(port_content);
-		
-		snprintf(port_content, sizeof(port_content), "%s/%s", path, "usb_communication_capable");
-		fxd_src.obj_fixed_sply.usb_comm = get_dword_from_path(port_content);
-		
-		snprintf(port_content, sizeof(port_content), "%s/%s", path, "dual_role_data");
-		fxd_src.obj_fixed_sply.drd = get_dword_from_path(port_content);
-		
-		snprintf(port_content, sizeof(port_content), "%s/%s", path, "unchunked_extended_messages_supported");
-		fxd_src.obj_fixed_sply.unchunked = get_dword_from_path(port_content);
-		
+		fxd_src.obj_fixed_sply.dual_pwr = v[0];
+		fxd_src.obj_fixed_sply.usb_suspend = v[1];
+		fxd_src.obj_fixed_sply.uncons_pwr = v[2];
+		fxd_src.obj_fixed_sply.usb_comm = v[3];
+		fxd_src.obj_fixed_sply.drd = v[4];
+		fxd_src.obj_fixed_sply.unchunked = v[5];
 		fxd_src.obj_fixed_sply.epr = 0;
-		
 		fxd_src.obj_fixed_sply.peak_cur = 0;
-		
-		snprintf(port_content, sizeof(port_content), "%s/%s", path, "voltage");
-		tmp = get_dword_from_path(port_content);
-		fxd_src.obj_fixed_sply.volt = tmp/50;
-		
-		snprintf(port_content, sizeof(port_content), "%s/%s", path, "maximum_current");
-		tmp = get_dword_from_path(port_content);
-		fxd_src.obj_fixed_sply.max_cur = tmp/10;
+		fxd_src.obj_fixed_sply.volt = v[6]/50;
+		fxd_src.obj_fixed_sply.max_cur = v[7]/10;
 
 		return fxd_src.fixed_supply;
 	}
 	else
 	{
 		fxd_snk.obj_fixed_supply.type = 0;
-		
-		snprintf(port_content, sizeof(port_content), "%s/%s", path, "dual_role_power");
-		fxd_snk.obj_fixed_supply.drp = get_dword_from_path(port_content);
-
-		snprintf(port_content, sizeof(port_content), "%s/%s", path, "higher_capability");
-		fxd_snk.obj_fixed_supply.higher_caps = get_dword_from_path(port_content);
-		
-		snprintf(port_content, sizeof(port_content), "%s/%s", path, "unconstrained_power");
-		fxd_snk.obj_fixed_supply.uncons_pwr = get_dword_from_path(port_content);
-		
-		snprintf(port_content, sizeof(port_content), "%s/%s", path, "usb_communication_capable");
-		fxd_snk.obj_fixed_supply.usb_comm_cap = get_dword_from_path(port_content);
-		
-		snprintf(port_content, sizeof(port_content), "%s/%s", path, "dual_role_data");
-		fxd_snk.obj_fixed_supply.drd = get_dword_from_path(port_content);
-		
-		snprintf(port_content, sizeof(port_content), "%s/%s", path, "fast_role_swap_current");
-		fxd_snk.obj_fixed_supply.fr_swp = get_dword_from_path(port_content);
-		
-		snprintf(port_content, sizeof(port_content), "%s/%s", path, "voltage");
-		tmp = get_dword_from_path(port_content);
-		fxd_snk.obj_fixed_supply.volt = tmp/50;
-		
-		snprintf(port_content, sizeof(port_content), "%s/%s", path, "operational_current");
-		tmp = get_dword_from_path(port_content);
-		fxd_snk.obj_fixed_supply.opr_cur = tmp/10;
+		fxd_snk.obj_fixed_supply.drp = v[0];
+		fxd_snk.obj_fixed_supply.higher_caps = v[1];
+		fxd_snk.obj_fixed_supply.uncons_pwr = v[2];
+		fxd_snk.obj_fixed_supply.usb_comm_cap = v[3];
+		fxd_snk.obj_fixed_supply.drd = v[4];
+		fxd_snk.obj_fixed_supply.fr_swp = v[5];
+		fxd_snk.obj_fixed_supply.volt = v[6]/50;
+		fxd_snk.obj_fixed_supply.opr_cur = v[7]/10;
 
 		return fxd_snk.fixed_supply;
+	}
+}
+
+static unsigned int get_epr_avs_pdo(const unsigned long *v, int src_snk)
+{
+	union libtypec_epr_avs avs = {0};
+
+	avs.obj_epr_avs.type = PDO_AUGMENTED;
+	avs.obj_epr_avs.apdo_type = APDO_EPR_AVS;
+	if(src_snk)
+		avs.obj_epr_avs.peak_cur = v[3];
+	avs.obj_epr_avs.max_volt = v[0]/100;
+	avs.obj_epr_avs.min_volt = v[1]/100;
+	avs.obj_epr_avs.pdp = v[2]/1000;
+
+	return avs.epr_avs;
+}
+
+static unsigned int get_spr_avs_pdo(const unsigned long *v, int src_snk)
+{
+	union libtypec_spr_avs avs = {0};
+
+	avs.obj_spr_avs.type = PDO_AUGMENTED;
+	avs.obj_spr_avs.apdo_type = APDO_SPR_AVS;
+	if(src_snk)
+		avs.obj_spr_avs.peak_cur = v[2];
+	avs.obj_spr_avs.max_cur_15v = v[0]/10;
+	avs.obj_spr_avs.max_cur_20v = v[1]/10;
+
+	return avs.spr_avs;
+}
+
+/*
+ * PDO directories are named "<position>:<type>", with the type taken from
+ * the kernel's device type name. Fixed PDOs in positions 8 and up are the
+ * EPR fixed supplies and share the SPR decoder.
+ */
+static const struct pdo_type_desc {
+	const char *name;
+	const char *const (*attrs)[PDO_ATTR_MAX];
+	unsigned int (*decode)(const unsigned long *v, int src_snk);
+} pdo_types[] = {
+	{ "fixed_supply", fixed_pdo_attrs, get_fixed_supply_pdo },
+	{ "variable_supply", variable_pdo_attrs, get_variable_supply_pdo },
+	{ "battery", battery_pdo_attrs, get_battery_supply_pdo },
+	{ "programmable_supply", pps_pdo_attrs, get_programmable_supply_pdo },
+	{ "epr_adjustable_voltage_supply", epr_avs_pdo_attrs, get_epr_avs_pdo },
+	{ "spr_adjustable_voltage_supply", spr_avs_pdo_attrs, get_spr_avs_pdo },
+};
+
+static const struct pdo_type_desc *pdo_type_lookup(const char *d_name, int *position)
+{
+	unsigned int t;
+	char *end;
+	unsigned long pos = strtoul(d_name, &end, 10);
+
+	if (end == d_name || *end != ':' || pos < 1 || pos > LIBTYPEC_MAX_PDOS)
+		return NULL;
 
+	for (t = 0; t < sizeof(pdo_types) / sizeof(pdo_types[0]); t++)
+	{
+		if (!strcmp(end + 1, pdo_types[t].name))
+		{
+			*position = pos;
+			return &pdo_types[t];
+		}
 	}
 
+	return NULL;
 }
 
 static int count_billbrd_if(const char *usb_path, const struct stat *sb, int typeflag, struct FTW *ftw)
@@ -574,8 +567,190 @@ static int libtypec_sysfs_init(char **session_info)
 	return 0;
 }
 
+/*
+ * Power supply of each port, found once through the sysfs device links and
+ * kept as an open uevent fd: 0 = not looked up yet, -1 = no PSY was found.
+ * A PSY may be registered late, so a port without one is looked up again
+ * when a partner attaches.
+ */
+#define PSY_CACHE_MAX 128
+#define PSY_UEVENT_LEN 2048
+
+static pthread_mutex_t psy_lock = PTHREAD_MUTEX_INITIALIZER;
+static int psy_uevent_fd[PSY_CACHE_MAX];
+static unsigned char psy_connected[PSY_CACHE_MAX];
+
+enum { PSY_ONLINE, PSY_CURRENT_NOW, PSY_VOLTAGE_NOW, PSY_CURRENT_MAX, PSY_VOLTAGE_MAX, PSY_NUM_KEYS };
+
+static const char *const psy_keys[PSY_NUM_KEYS] = {
+	[PSY_ONLINE] = "ONLINE",
+	[PSY_CURRENT_NOW] = "CURRENT_NOW",
+	[PSY_VOLTAGE_NOW] = "VOLTAGE_NOW",
+	[PSY_CURRENT_MAX] = "CURRENT_MAX",
+	[PSY_VOLTAGE_MAX] = "VOLTAGE_MAX",
+};
+
+/*
+ * A power supply belongs to the port when both hang off the same parent
+ * device. UCSI registers one PSY per connector on the same parent and
+ * suffixes its name with the 1-based connector number; with several PSYs
+ * on the parent only that number matches, so a port without its own PSY
+ * never reports a sibling's.
+ */
+static int psy_open_uevent(int conn_num)
+{
+	char path_str[512], port_dev[PATH_MAX], psy_dev[PATH_MAX];
+	char match[256] = "", only[256] = "";
+	DIR *psy_path;
+	struct dirent *psy_entry;
+	int siblings = 0;
+
+	snprintf(path_str, sizeof(path_str), SYSFS_TYPEC_PATH "/port%d/device", conn_num);
+
+	if (!realpath(path_str, port_dev))
+		return -1;
+
+	psy_path = opendir(SYSFS_PSY_PATH);
+	if (psy_path == NULL)
+		return -1;
+
+	while ((psy_entry = readdir(psy_path)))
+	{
+		size_t len = strlen(psy_entry->d_name);
+
+		if (psy_entry->d_name[0] == '.')
+			continue;
+
+		snprintf(path_str, sizeof(path_str), SYSFS_PSY_PATH "/%s/device", psy_entry->d_name);
+
+		if (!realpath(path_str, psy_dev) || strcmp(psy_dev, port_dev))
+			continue;
+
+		if (!siblings++)
+			snprintf(only, sizeof(only), "%s", psy_entry->d_name);
+
+		while (len && isdigit((unsigned char)psy_entry->d_name[len - 1]))
+			len--;
+
+		if (psy_entry->d_name[len] && atoi(psy_entry->d_name + len) == conn_num + 1)
+			snprintf(match, sizeof(match), "%s", psy_entry->d_name);
+	}
+	closedir(psy_path);
+
+	if (!match[0] && siblings == 1)
+		snprintf(match, sizeof(match), "%s", only);
+	if (!match[0])
+		return -1;
+
+	snprintf(path_str, sizeof(path_str), SYSFS_PSY_PATH "/%s/uevent", match);
+
+	return open(path_str, O_RDONLY | O_CLOEXEC);
+}
+
+/*
+ * Read the POWER_SUPPLY_* keys of a port's PSY with a single pread of its
+ * uevent attribute. Keys absent from the file read as 0. connected is the
+ * current attach state of the port.
+ *
+ * Returns 0, or -1 when the port has no power supply.
+ */
+static int psy_read_keys(int conn_num, int connected, unsigned long *val)
+{
+	char buf[PSY_UEVENT_LEN], *line, *next;
+	int fd, retry = 1;
+	ssize_t len;
+
+	if (conn_num < 0 || conn_num >= PSY_CACHE_MAX)
+		return -1;
+
+	pthread_mutex_lock(&psy_lock);
+
+	/* Look for a PSY again on attach, it may have been registered since */
+	if (psy_uevent_fd[conn_num] < 0 && connected && !psy_connected[conn_num])
+		psy_uevent_fd[conn_num] = 0;
+	psy_connected[conn_num] = connected;
+
+	do
+	{
+		if (psy_uevent_fd[conn_num] == 0)
+			psy_uevent_fd[conn_num] = psy_open_uevent(conn_num);
+
+		fd = psy_uevent_fd[conn_num];
+		if (fd < 0)
+		{
+			len = -1;
+			break;
+		}
+
+		len = pread(fd, buf, sizeof(buf) - 1, 0);
+		if (len < 0)
+		{
+			/* PSY went away, e.g. driver rebind; look it up again */
+			close(fd);
+			psy_uevent_fd[conn_num] = 0;
+		}
+	} while (len < 0 && retry--);
+	pthread_mutex_unlock(&psy_lock);
+
+	if (len < 0)
+		return -1;
+
+	buf[len] = '\0';
+	memset(val, 0, PSY_NUM_KEYS * sizeof(*val));
+
+	for (line = buf; line && *line; line = next)
+	{
+		char *eq;
+		int i;
+
+		next = strchr(line, '\n');
+		if (next)
+			*next++ = '\0';
+
+		if (strncmp(line, "POWER_SUPPLY_", 13))
+			continue;
+		line += 13;
+
+		eq = strchr(line, '=');
+		if (!eq)
+			continue;
+		*eq = '\0';
+
+		for (i = 0; i < PSY_NUM_KEYS; i++)
+		{
+			if (!strcmp(line, psy_keys[i]))
+			{
+				val[i] = strtoul(eq + 1, NULL, 10);
+				break;
+			}
+		}
+	}
+
+	return 0;
+}
+
+static void psy_cache_flush(void)
+{
+	int i;
+
+	pthread_mutex_lock(&psy_lock);
+	for (i = 0; i < PSY_CACHE_MAX; i++)
+	{
+		if (psy_uevent_fd[i] > 0)
+			close(psy_uevent_fd[i]);
+		psy_uevent_fd[i] = 0;
+		psy_connected[i] = 0;
+	}
+	pthread_mutex_unlock(&psy_lock);
+}
+
+static void pd_cache_flush(void);
+
 static int libtypec_sysfs_exit(void)
 {
+	psy_cache_flush();
+	pd_cache_flush();
+
 	return 0;
 }
 
@@ -676,7 +851,11 @@ static int libtypec_sysfs_get_conn_capability_ops(int conn_num, struct libtypec_
 	return 0;
 }
 
-static int libtypec_sysfs_get_alternate_modes(int recipient, int conn_num, struct altmode_data *alt_mode_data)
+/*
+ * Stores at most max modes but keeps counting, so a short buffer is
+ * detected by a return value above max.
+ */
+static int libtypec_sysfs_get_alternate_modes(int recipient, int conn_num, struct altmode_data *alt_mode_data, int max)
 {
 	struct stat sb;
 	int num_alt_mode = 0;
@@ -690,96 +869,35 @@ static int libtypec_sysfs_get_alternate_modes(int recipient, int conn_num, struc
 		return -1;
 	}
 
-	if (recipient == AM_CONNECTOR)
-	{
-
-		do
-		{
-
-			snprintf(path_str, sizeof(path_str), SYSFS_TYPEC_PATH "/port%d/port%d.%d", conn_num, conn_num, num_alt_mode);
-
-			if (lstat(path_str, &sb) == -1)
-				break;
-
-			snprintf(port_content, sizeof(port_content), "%s/%s", path_str, "svid");
-
-			alt_mode_data[num_alt_mode].svid = get_hex_dword_from_path(port_content);
-
-			memset(port_content, 0, sizeof(port_content));
-
-			snprintf(port_content, sizeof(port_content), "%s/%s", path_str, "vdo");
-
-			alt_mode_data[num_alt_mode].vdo = get_hex_dword_from_path(port_content);
-
-			memset(port_content, 0, sizeof(port_content));
-
-			memset(path_str, 0, sizeof(path_str));
-
-			num_alt_mode++;
+	if (recipient != AM_CONNECTOR && recipient != AM_SOP && recipient != AM_SOP_PR)
+		return 0;
 
-		} while (1);
-	}
-	else if (recipient == AM_SOP)
+	do
 	{
-
-		do
-		{
-
+		if (recipient == AM_CONNECTOR)
+			snprintf(path_str, sizeof(path_str), SYSFS_TYPEC_PATH "/port%d/port%d.%d", conn_num, conn_num, num_alt_mode);
+		else if (recipient == AM_SOP)
 			snprintf(path_str, sizeof(path_str), SYSFS_TYPEC_PATH "/port%d/port%d-partner/port%d-partner.%d", conn_num, conn_num, conn_num, num_alt_mode);
-
-			if (lstat(path_str, &sb) == -1)
-				break;
-
-			snprintf(port_content, sizeof(port_content), "%s/%s", path_str, "svid");
-
-			alt_mode_data[num_alt_mode].svid = get_hex_dword_from_path(port_content);
-
-			memset(port_content, 0, sizeof(port_content));
-
-			snprintf(port_content, sizeof(port_content), "%s/%s", path_str, "vdo");
-
-			alt_mode_data[num_alt_mode].vdo = get_hex_dword_from_path(port_content);
-
-			memset(port_content, 0, sizeof(port_content));
-
-			memset(path_str, 0, sizeof(path_str));
-
-			num_alt_mode++;
-
-		} while (1);
-	}
-	else if (recipient == AM_SOP_PR)
-	{
-
-		do
-		{
-
+		else
 			snprintf(path_str, sizeof(path_str), SYSFS_TYPEC_PATH "/port%d-cable/port%d-plug0/port%d-plug0.%d", conn_num, conn_num, conn_num, num_alt_mode);
 
-			if (lstat(path_str, &sb) == -1)
-				break;
+		if (lstat(path_str, &sb) == -1)
+			break;
 
+		if (num_alt_mode < max)
+		{
 			snprintf(port_content, sizeof(port_content), "%s/%s", path_str, "svid");
 
 			alt_mode_data[num_alt_mode].svid = get_hex_dword_from_path(port_content);
 
-			memset(port_content, 0, sizeof(port_content));
-
 			snprintf(port_content, sizeof(port_content), "%s/%s", path_str, "vdo");
 
 			alt_mode_data[num_alt_mode].vdo = get_hex_dword_from_path(port_content);
+		}
 
-			memset(port_content, 0, sizeof(port_content));
-
-			memset(path_str, 0, sizeof(path_str));
-
-			num_alt_mode++;
+		num_alt_mode++;
 
-		} while (1);
-	}
-	else
-	{
-	}
+	} while (1);
 
 	return num_alt_mode;
 }
@@ -817,8 +935,8 @@ static int libtypec_sysfs_get_cable_properties_ops(int conn_num, struct libtypec
 static int libtypec_sysfs_get_connector_status_ops(int conn_num, struct libtypec_connector_status *conn_sts)
 {
 	struct stat sb;
-	char path_str[512], port_content[512 + 64];
-	int ret;
+	char path_str[512];
+	unsigned long psy[PSY_NUM_KEYS];
 
 	snprintf(path_str, sizeof(path_str), SYSFS_TYPEC_PATH "/port%d", conn_num);
 
@@ -832,54 +950,59 @@ static int libtypec_sysfs_get_connector_status_ops(int conn_num, struct libtypec
 
 	conn_sts->ConnectStatus = (lstat(path_str, &sb) == -1) ? 0 : 1;
 
-	snprintf(path_str, sizeof(path_str), SYSFS_PSY_PATH "/ucsi-source-psy-USBC000:00%d", conn_num + 1);
-
-	if (lstat(path_str, &sb) == -1)
-	{
-		printf("Non UCSI based Type-C connector Class - PSY not supported\n:%s\n", path_str);
+	/* Not every Type-C class driver registers a PSY for its ports */
+	if (psy_read_keys(conn_num, conn_sts->ConnectStatus, psy) < 0)
 		return 0;
-	}
-	else
-	{
-		snprintf(port_content, sizeof(port_content), "%s/%s", path_str, "online");
-
-		ret = get_hex_dword_from_path(port_content);
-
-		if (ret)
-		{
-			unsigned long cur, volt, op_mw, max_mw;
-
-			snprintf(port_content, sizeof(port_content), "%s/%s", path_str, "current_now");
-
-			cur = get_dword_from_path(port_content) / 1000;
 
-			snprintf(port_content, sizeof(port_content), "%s/%s", path_str, "voltage_now");
+	if (psy[PSY_ONLINE])
+	{
+		unsigned long cur, volt, op_mw, max_mw;
 
-			volt = get_dword_from_path(port_content) / 1000;
+		cur = psy[PSY_CURRENT_NOW] / 1000;
+		volt = psy[PSY_VOLTAGE_NOW] / 1000;
+		op_mw = (cur * volt) / (250 * 1000);
 
-			op_mw = (cur * volt) / (250 * 1000);
+		cur = psy[PSY_CURRENT_MAX] / 1000;
+		volt = psy[PSY_VOLTAGE_MAX] / 1000;
+		max_mw = (cur * volt) / (250 * 1000);
 
-			snprintf(port_content, sizeof(port_content), "%s/%s", path_str, "current_max");
+		conn_sts->RequestDataObject = ((op_mw << 10)) | ((max_mw)&0x3FF);
+	}
+	return 0;
+}
 
-			cur = get_dword_from_path(port_content) / 1000;
+static int libtypec_sysfs_get_power_sample_ops(int conn_num, struct libtypec_power_sample *sample)
+{
+	unsigned long psy[PSY_NUM_KEYS];
+	char path_str[64];
+	struct stat sb;
 
-			snprintf(port_content, sizeof(port_content), "%s/%s", path_str, "voltage_max");
+	snprintf(path_str, sizeof(path_str), SYSFS_TYPEC_PATH "/port%d-partner", conn_num);
 
-			volt = get_dword_from_path(port_content) / 1000;
+	sample->connected = lstat(path_str, &sb) == 0;
+	if (psy_read_keys(conn_num, sample->connected, psy) < 0)
+		return -ENODATA;
 
-			max_mw = (cur * volt) / (250 * 1000);
+	sample->voltage_mv = psy[PSY_VOLTAGE_NOW] / 1000;
+	sample->current_ma = psy[PSY_CURRENT_NOW] / 1000;
+	sample->peak_ma = 0;
+	/* A port PSY is online only while the port is sinking from its partner */
+	sample->sourcing = sample->connected && !psy[PSY_ONLINE];
 
-			conn_sts->RequestDataObject = ((op_mw << 10)) | ((max_mw)&0x3FF);
-		}
-	}
 	return 0;
 }
 
 static int libtypec_sysfs_get_discovered_identity_ops(int recipient, int conn_num, char *pd_resp_data)
 {
+	static const char *const id_attrs[6] = {
+		"cert_stat", "id_header", "product",
+		"product_type_vdo1", "product_type_vdo2", "product_type_vdo3",
+	};
 	struct stat sb;
-	char path_str[512], port_content[512 + 64];
+	char path_str[512], port_content[6][512 + 64];
+	struct libtypec_attr attrs[6];
 	union libtypec_discovered_identity *id = (void *)pd_resp_data;
+	int i;
 
 	snprintf(path_str, sizeof(path_str), SYSFS_TYPEC_PATH "/port%d", conn_num);
 
@@ -890,89 +1013,30 @@ static int libtypec_sysfs_get_discovered_identity_ops(int recipient, int conn_nu
 	}
 
 	if (recipient == AM_SOP)
-	{
-
 		snprintf(path_str, sizeof(path_str), SYSFS_TYPEC_PATH "/port%d-partner/identity", conn_num);
-
-		if (lstat(path_str, &sb) == -1)
-			return -1;
-
-		snprintf(port_content, sizeof(port_content), "%s/%s", path_str, "cert_stat");
-
-		id->disc_id.cert_stat = get_hex_dword_from_path(port_content);
-
-		memset(port_content, 0, sizeof(port_content));
-
-		snprintf(port_content, sizeof(port_content), "%s/%s", path_str, "id_header");
-
-		id->disc_id.id_header = get_hex_dword_from_path(port_content);
-
-		memset(port_content, 0, sizeof(port_content));
-
-		snprintf(port_content, sizeof(port_content), "%s/%s", path_str, "product");
-
-		id->disc_id.product = get_hex_dword_from_path(port_content);
-
-		memset(port_content, 0, sizeof(port_content));
-
-		snprintf(port_content, sizeof(port_content), "%s/%s", path_str, "product_type_vdo1");
-
-		id->disc_id.product_type_vdo1 = get_hex_dword_from_path(port_content);
-
-		memset(port_content, 0, sizeof(port_content));
-
-		snprintf(port_content, sizeof(port_content), "%s/%s", path_str, "product_type_vdo2");
-
-		id->disc_id.product_type_vdo2 = get_hex_dword_from_path(port_content);
-
-		memset(port_content, 0, sizeof(port_content));
-
-		snprintf(port_content, sizeof(port_content), "%s/%s", path_str, "product_type_vdo3");
-
-		id->disc_id.product_type_vdo3 = get_hex_dword_from_path(port_content);
-	}
 	else if (recipient == AM_SOP_PR)
-	{
-
 		snprintf(path_str, sizeof(path_str), SYSFS_TYPEC_PATH "/port%d-cable/identity", conn_num);
+	else
+		return 0;
 
-		if (lstat(path_str, &sb) == -1)
-			return -1;
-
-		snprintf(port_content, sizeof(port_content), "%s/%s", path_str, "cert_stat");
-
-		id->disc_id.cert_stat = get_hex_dword_from_path(port_content);
-
-		memset(port_content, 0, sizeof(port_content));
-
-		snprintf(port_content, sizeof(port_content), "%s/%s", path_str, "id_header");
-
-		id->disc_id.id_header = get_hex_dword_from_path(port_content);
-
-		memset(port_content, 0, sizeof(port_content));
-
-		snprintf(port_content, sizeof(port_content), "%s/%s", path_str, "product");
-
-		id->disc_id.product = get_hex_dword_from_path(port_content);
-
-		memset(port_content, 0, sizeof(port_content));
-
-		snprintf(port_content, sizeof(port_content), "%s/%s", path_str, "product_type_vdo1");
-
-		id->disc_id.product_type_vdo1 = get_hex_dword_from_path(port_content);
-
-		memset(port_content, 0, sizeof(port_content));
-
-		snprintf(port_content, sizeof(port_content), "%s/%s", path_str, "product_type_vdo2");
+	if (lstat(path_str, &sb) == -1)
+		return -1;
 
-		id->disc_id.product_type_vdo2 = get_hex_dword_from_path(port_content);
+	for (i = 0; i < 6; i++)
+	{
+		snprintf(port_content[i], sizeof(port_content[i]), "%s/%s", path_str, id_attrs[i]);
+		attrs[i].path = port_content[i];
+	}
 
-		memset(port_content, 0, sizeof(port_content));
+	libtypec_read_attrs(attrs, 6);
 
-		snprintf(port_content, sizeof(port_content), "%s/%s", path_str, "product_type_vdo3");
+	id->disc_id.cert_stat = libtypec_attr_ul(&attrs[0], 16, -1);
+	id->disc_id.id_header = libtypec_attr_ul(&attrs[1], 16, -1);
+	id->disc_id.product = libtypec_attr_ul(&attrs[2], 16, -1);
+	id->disc_id.product_type_vdo1 = libtypec_attr_ul(&attrs[3], 16, -1);
+	id->disc_id.product_type_vdo2 = libtypec_attr_ul(&attrs[4], 16, -1);
+	id->disc_id.product_type_vdo3 = libtypec_attr_ul(&attrs[5], 16, -1);
 
-		id->disc_id.product_type_vdo3 = get_hex_dword_from_path(port_content);
-	}
 	return 0;
 }
 
@@ -986,70 +1050,172 @@ static int libtypec_sysfs_get_pd_message_ops(int recipient, int conn_num, int nu
 	return 0;
 }
 
-static int libtypec_sysfs_get_pdos_ops(int conn_num, int partner, int offset, int *num_pdo, int src_snk, int type, struct libtypec_get_pdos *pdo_data)
+/*
+ * Reads the PDO directory of one capability set into pdo[], each PDO at its
+ * spec position (1-based directory prefix) minus one. Positions without a
+ * PDO, e.g. the zero padding between SPR and EPR objects, are left as 0.
+ */
+static int sysfs_read_pdo_dir(const char *path_str, int src_snk, unsigned int *pdo)
 {
-	int num_pdos_read = 0;
-	char path_str[512], port_content[512 + 256];
+	int num_pdos_read = 0, num_attrs = 0, n, i, pos;
+	const struct pdo_type_desc *slot[LIBTYPEC_MAX_PDOS] = {0};
+	int first[LIBTYPEC_MAX_PDOS];
+	char attr_path[LIBTYPEC_MAX_PDOS * PDO_ATTR_MAX][SYSFS_ATTR_PATH_LEN];
+	struct libtypec_attr attr[LIBTYPEC_MAX_PDOS * PDO_ATTR_MAX];
 	DIR *typec_path;
 	struct dirent *typec_entry;
 
-	snprintf(path_str, sizeof(path_str), SYSFS_TYPEC_PATH "/port%d", conn_num);
-
 	typec_path = opendir(path_str);
-    if (typec_path == NULL)
+	if (typec_path == NULL)
+		return 0; /*No PDOs*/
+
+	/* One directory pass: queue the attributes of every PDO */
+	while ((typec_entry = readdir(typec_path)))
 	{
-		printf("Incorrect connector number : failed to open, %s\n", path_str);
-		return -1;
+		const struct pdo_type_desc *desc = pdo_type_lookup(typec_entry->d_name, &pos);
+		const char *const *names;
+
+		if (!desc || slot[pos - 1])
+			continue;
+
+		n = pos - 1;
+		slot[n] = desc;
+		first[n] = num_attrs;
+		names = desc->attrs[src_snk ? 1 : 0];
+		for (i = 0; i < PDO_ATTR_MAX && names[i]; i++, num_attrs++)
+		{
+			attr_path[num_attrs][0] = '\0';
+			if (snprintf(attr_path[num_attrs], sizeof(attr_path[num_attrs]), "%s/%s/%s",
+					path_str, typec_entry->d_name, names[i]) >= SYSFS_ATTR_PATH_LEN)
+				attr_path[num_attrs][0] = '\0';
+			attr[num_attrs].path = attr_path[num_attrs];
+		}
+
+		if (n + 1 > num_pdos_read)
+			num_pdos_read = n + 1;
 	}
-    closedir(typec_path);
+	closedir(typec_path);
 
-	if (partner == 0)
+	libtypec_read_attrs(attr, num_attrs);
+
+	for (n = 0; n < num_pdos_read; n++)
 	{
-		if(src_snk)
-			snprintf(path_str, sizeof(path_str), SYSFS_TYPEC_PATH "/port%d/usb_power_delivery/source-capabilities", conn_num);
-		else
-			snprintf(path_str, sizeof(path_str), SYSFS_TYPEC_PATH "/port%d/usb_power_delivery/sink-capabilities", conn_num);
+		unsigned long v[PDO_ATTR_MAX] = {0};
+		const char *const *names;
+
+		if (!slot[n])
+		{
+			pdo[n] = 0;
+			continue;
+		}
+
+		names = slot[n]->attrs[src_snk ? 1 : 0];
+		for (i = 0; i < PDO_ATTR_MAX && names[i]; i++)
+			v[i] = libtypec_attr_ul(&attr[first[n] + i], 10, 0);
+
+		pdo[n] = slot[n]->decode(v, src_snk);
 	}
-	else
+
+	return num_pdos_read;
+}
+
+/*
+ * Capabilities of a usb_power_delivery object only change when the kernel
+ * registers its source-capabilities or sink-capabilities directory again,
+ * e.g. when a source re-advertises or enters EPR, or when a pdN id is
+ * recycled. Decoded capabilities are therefore cached per object name, each
+ * list keyed by the kernfs inode of its own directory.
+ */
+#define PD_CACHE_MAX 16
+
+static pthread_mutex_t pd_cache_lock = PTHREAD_MUTEX_INITIALIZER;
+static unsigned int pd_cache_next;
+
+static struct pd_caps_cache {
+	char name[16];
+	ino_t ino[2];
+	unsigned char valid[2];
+	int num_pdo[2];
+	unsigned int pdo[2][LIBTYPEC_MAX_PDOS];
+} pd_cache[PD_CACHE_MAX];
+
+static struct pd_caps_cache *pd_cache_lookup(const char *name)
+{
+	struct pd_caps_cache *ent;
+	int i;
+
+	for (i = 0; i < PD_CACHE_MAX; i++)
 	{
-		if(src_snk)
-			snprintf(path_str, sizeof(path_str), SYSFS_TYPEC_PATH "/port%d-partner/usb_power_delivery/source-capabilities", conn_num);
-		else
-			snprintf(path_str, sizeof(path_str), SYSFS_TYPEC_PATH "/port%d-partner/usb_power_delivery/sink-capabilities", conn_num);		
+		if (!strcmp(pd_cache[i].name, name))
+			return &pd_cache[i];
 	}
 
-	typec_path = opendir(path_str);
+	/* Round robin: a stale object is never looked up again */
+	ent = &pd_cache[pd_cache_next++ % PD_CACHE_MAX];
+	memset(ent, 0, sizeof(*ent));
+	strcpy(ent->name, name);
 
-	if (typec_path == NULL)
-		goto finalize; /*No PDOs*/
+	return ent;
+}
 
-	while ((typec_entry = readdir(typec_path)))
+static void pd_cache_flush(void)
+{
+	pthread_mutex_lock(&pd_cache_lock);
+	memset(pd_cache, 0, sizeof(pd_cache));
+	pthread_mutex_unlock(&pd_cache_lock);
+}
+
+static int libtypec_sysfs_get_pdos_ops(int conn_num, int partner, int offset, int *num_pdo, int src_snk, int type, unsigned int *pdo, int max)
+{
+	int num_pdos_read = 0, n;
+	char path_str[512], target[256];
+	const char *name;
+	struct pd_caps_cache *ent;
+	struct stat st;
+	ssize_t len;
+
+	snprintf(path_str, sizeof(path_str), SYSFS_TYPEC_PATH "/port%d%s/usb_power_delivery",
+		conn_num, partner ? "-partner" : "");
+
+	len = readlink(path_str, target, sizeof(target) - 1);
+	if (len < 0)
 	{
-		memset(port_content, 0, sizeof(port_content));
-		snprintf(port_content, sizeof(port_content), "%s/%s", path_str,typec_entry->d_name);
-		if(strstr(typec_entry->d_name, "fixed"))
+		snprintf(path_str, sizeof(path_str), SYSFS_TYPEC_PATH "/port%d", conn_num);
+		if (access(path_str, F_OK))
 		{
-			pdo_data->pdo[num_pdos_read++] = get_fixed_supply_pdo(port_content,src_snk);
-
+			printf("Incorrect connector number : failed to open, %s\n", path_str);
+			return -1;
 		}
-		else if(strstr(typec_entry->d_name, "variable"))
-		{
-			pdo_data->pdo[num_pdos_read++] = get_variable_supply_pdo(port_content,src_snk);
+		goto finalize; /*No PD object*/
+	}
+	target[len] = '\0';
 
-		}
-		else if(strstr(typec_entry->d_name, "battery"))
-		{
-			pdo_data->pdo[num_pdos_read++] = get_battery_supply_pdo(port_content,src_snk);
+	name = strrchr(target, '/');
+	name = name ? name + 1 : target;
 
-		}
-		else if(strstr(typec_entry->d_name, "programmable"))
-		{
-			pdo_data->pdo[num_pdos_read++] = get_programmable_supply_pdo(port_content,src_snk);
+	src_snk = src_snk ? 1 : 0;
+	if (offset < 0)
+		offset = 0;
 
-		}
-		
+	snprintf(path_str, sizeof(path_str), SYSFS_PD_PATH "/%s/%s", name,
+		src_snk ? "source-capabilities" : "sink-capabilities");
+	if (strlen(name) >= sizeof(ent->name) || stat(path_str, &st))
+		goto finalize;
+
+	pthread_mutex_lock(&pd_cache_lock);
+
+	ent = pd_cache_lookup(name);
+	if (!ent->valid[src_snk] || ent->ino[src_snk] != st.st_ino)
+	{
+		ent->num_pdo[src_snk] = sysfs_read_pdo_dir(path_str, src_snk, ent->pdo[src_snk]);
+		ent->ino[src_snk] = st.st_ino;
+		ent->valid[src_snk] = 1;
 	}
-	closedir(typec_path);
+
+	for (n = offset; n < ent->num_pdo[src_snk] && num_pdos_read < max; n++)
+		pdo[num_pdos_read++] = ent->pdo[src_snk][n];
+
+	pthread_mutex_unlock(&pd_cache_lock);
 
 finalize:
 	*num_pdo = num_pdos_read;
@@ -1089,37 +1255,53 @@ static int libtypec_sysfs_get_bb_data(int num_billboards,char* bb_data)
 }
 
 void libtypec_lnx_monitor_udev_events() {
+    struct stat sb;
+
+    /* Without udevd nothing is rebroadcast on the "udev" group */
+    if (libtypec_event_src == LIBTYPEC_EVENT_SRC_KERNEL ||
+        (libtypec_event_src == LIBTYPEC_EVENT_SRC_AUTO && stat("/run/udev/control", &sb) < 0)) {
+        libtypec_lnx_monitor_kernel_uevents();
+        return;
+    }
+
     struct udev *udev = udev_new();
     struct udev_monitor *mon = udev_monitor_new_from_netlink(udev, "udev");
 
     udev_monitor_filter_add_match_subsystem_devtype(mon, "typec", NULL);
+    udev_monitor_filter_add_match_subsystem_devtype(mon, "usb_power_delivery", NULL);
+    udev_monitor_filter_add_match_subsystem_devtype(mon, "power_supply", NULL);
     udev_monitor_enable_receiving(mon);
 
+    struct pollfd pfd = { .fd = udev_monitor_get_fd(mon), .events = POLLIN };
+
     while (1) {
+        /* The monitor socket is non-blocking, sleep until it has data */
+        if (poll(&pfd, 1, -1) < 0) {
+            if (errno == EINTR)
+                continue;
+            break;
+        }
+
         struct udev_device *dev = udev_monitor_receive_device(mon);
         if (dev) {
             const char *subsystem = udev_device_get_subsystem(dev);
-            enum usb_typec_event event;
-            if (strcmp(subsystem, "typec") == 0) {
-                // typec event
-                const char *action = udev_device_get_action(dev);
-                if (strcmp(action, "add") == 0) {
-                    event = USBC_DEVICE_CONNECTED;
-                } else if (strcmp(action, "remove") == 0) {
-                    event = USBC_DEVICE_DISCONNECTED;
-                }
-            }
+            const char *action = udev_device_get_action(dev);
+            const char *devpath = udev_device_get_devpath(dev);
+            struct libtypec_event_info info = { .conn_num = -1 };
+            int event = -1;
+
+            if (subsystem && action && devpath)
+                event = libtypec_uevent_event(action, subsystem, devpath, &info);
+
             udev_device_unref(dev);
 
             // call all callbacks for this event
-            libtypec_notification_list_t* node = registered_callbacks[event];
-            while (node) {
-                node->cb_func(event, node->data);
-                node = node->next;
-            }
+            if (event >= 0)
+                libtypec_notify(event, &info);
         }
     }
 
+    udev_monitor_unref(mon);
     udev_unref(udev);
 }
 libtypec_notification_list_t* registered_callbacks[USBC_EVENT_COUNT] = {0};
@@ -1138,5 +1320,6 @@ const struct libtypec_os_backend libtypec_lnx_sysfs_backend = {
 	.get_pd_message_ops = libtypec_sysfs_get_pd_message_ops,
 	.get_bb_status = libtypec_sysfs_get_bb_status,
 	.get_bb_data = libtypec_sysfs_get_bb_data,
-	.monitor_events = libtypec_lnx_monitor_udev_events
+	.monitor_events = libtypec_lnx_monitor_udev_events,
+	.get_power_sample_ops = libtypec_sysfs_get_power_sample_ops,
 };
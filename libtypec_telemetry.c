@@ -0,0 +1,328 @@
+/*
+MIT License
+
+Copyright (c) 2022 Rajaram Regupathy <rajaram.regupathy@gmail.com>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+// SPDX-License-Identifier: MIT
+/**
+ * @file libtypec_telemetry.c
+ * @author Rajaram Regupathy <rajaram.regupathy@gmail.com>
+ * @brief VBUS power telemetry sampler for libtypec
+ *
+ * A sampler thread reads voltage and current of the selected connectors at
+ * a fixed CLOCK_MONOTONIC period into one preallocated ring per connector.
+ * The backend keeps its file descriptors open between samples, so a sample
+ * costs one read on sysfs or one GET_CONNECTOR_STATUS on UCSI.
+ *
+ * Statistics are computed in place over the ring under its lock; samples are
+ * never copied out.
+ */
+
+#include "libtypec.h"
+#include "libtypec_ops.h"
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <pthread.h>
+#include <time.h>
+
+#define TELEMETRY_HIST_BINS 256
+
+struct telemetry_ring {
+	pthread_mutex_t lock;
+	/* samples written so far, the newest is at (head - 1) % RING */
+	uint64_t head;
+	struct libtypec_power_sample s[LIBTYPEC_TELEMETRY_RING];
+};
+
+static struct {
+	/* serializes start, stop and stats against each other */
+	pthread_mutex_t lock;
+	pthread_t sampler;
+	int running;
+	unsigned int conn_mask;
+	unsigned int period_us;
+	struct telemetry_ring *ring[LIBTYPEC_TELEMETRY_MAX_PORTS];
+} tel = {
+	.lock = PTHREAD_MUTEX_INITIALIZER,
+};
+
+static void *telemetry_sampler(void *arg)
+{
+	struct timespec next;
+	int i;
+
+	(void)arg;
+
+	clock_gettime(CLOCK_MONOTONIC, &next);
+
+	while (__atomic_load_n(&tel.running, __ATOMIC_ACQUIRE))
+	{
+		struct timespec now;
+
+		for (i = 0; i < LIBTYPEC_TELEMETRY_MAX_PORTS; i++)
+		{
+			struct telemetry_ring *r = tel.ring[i];
+			struct libtypec_power_sample s;
+
+			if (!(tel.conn_mask & (1u << i)) || libtypec_get_power_sample_prio(i, &s, LIBTYPEC_ASYNC_PRIO_BACKGROUND) < 0)
+				continue;
+
+			pthread_mutex_lock(&r->lock);
+			r->s[r->head % LIBTYPEC_TELEMETRY_RING] = s;
+			r->head++;
+			pthread_mutex_unlock(&r->lock);
+
+			libtypec_energy_account(i, &s);
+			libtypec_alert_eval_sample(i, &s);
+		}
+
+		next.tv_nsec += (long)tel.period_us * 1000;
+		while (next.tv_nsec >= 1000000000L)
+		{
+			next.tv_nsec -= 1000000000L;
+			next.tv_sec++;
+		}
+
+		/* Overran the period: drop the missed ticks instead of bursting */
+		clock_gettime(CLOCK_MONOTONIC, &now);
+		if (now.tv_sec > next.tv_sec || (now.tv_sec == next.tv_sec && now.tv_nsec > next.tv_nsec))
+			next = now;
+
+		clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, NULL);
+	}
+
+	return NULL;
+}
+
+static void telemetry_free_rings(void)
+{
+	int i;
+
+	for (i = 0; i < LIBTYPEC_TELEMETRY_MAX_PORTS; i++)
+	{
+		if (tel.ring[i])
+		{
+			pthread_mutex_destroy(&tel.ring[i]->lock);
+			free(tel.ring[i]);
+			tel.ring[i] = NULL;
+		}
+	}
+}
+
+/**
+ * This function shall be used to start sampling VBUS voltage and current of
+ * the selected connectors. Each connector gets a ring of the last
+ * LIBTYPEC_TELEMETRY_RING samples. While the async engine runs, samples are
+ * taken as background requests and so are bound by its rate limit.
+ *
+ * \param conn_mask Bit n selects connector n
+ * \param period_us Sampling period in microseconds
+ *
+ * \returns 0 on success, -EBUSY if already running
+ */
+int libtypec_telemetry_start(unsigned int conn_mask, unsigned int period_us)
+{
+	int i, ret = 0;
+
+	if (!conn_mask || !period_us)
+		return -EINVAL;
+
+	pthread_mutex_lock(&tel.lock);
+
+	if (tel.running)
+	{
+		ret = -EBUSY;
+		goto out;
+	}
+
+	for (i = 0; i < LIBTYPEC_TELEMETRY_MAX_PORTS; i++)
+	{
+		if (!(conn_mask & (1u << i)))
+			continue;
+
+		tel.ring[i] = calloc(1, sizeof(*tel.ring[i]));
+		if (!tel.ring[i])
+		{
+			telemetry_free_rings();
+			ret = -ENOMEM;
+			goto out;
+		}
+		pthread_mutex_init(&tel.ring[i]->lock, NULL);
+	}
+
+	tel.conn_mask = conn_mask;
+	tel.period_us = period_us;
+	tel.running = 1;
+
+	ret = -pthread_create(&tel.sampler, NULL, telemetry_sampler, NULL);
+	if (ret)
+	{
+		tel.running = 0;
+		telemetry_free_rings();
+	}
+
+out:
+	pthread_mutex_unlock(&tel.lock);
+	return ret;
+}
+
+/**
+ * This function shall be used to stop the telemetry sampler and release
+ * its rings.
+ *
+ * \returns 0 on success
+ */
+int libtypec_telemetry_stop(void)
+{
+	pthread_mutex_lock(&tel.lock);
+
+	if (tel.running)
+	{
+		__atomic_store_n(&tel.running, 0, __ATOMIC_RELEASE);
+		pthread_join(tel.sampler, NULL);
+	}
+	telemetry_free_rings();
+	tel.conn_mask = 0;
+
+	pthread_mutex_unlock(&tel.lock);
+
+	return 0;
+}
+
+static int hist_percentile(const unsigned int *hist, unsigned int count, int pct, int min, int max)
+{
+	unsigned int rank = (count * pct + 99) / 100, seen = 0;
+	int bin;
+
+	for (bin = 0; bin < TELEMETRY_HIST_BINS; bin++)
+	{
+		seen += hist[bin];
+		if (seen >= rank)
+			break;
+	}
+
+	/* upper edge of the bin */
+	return min + (int)(((long long)(max - min) * (bin + 1)) / TELEMETRY_HIST_BINS);
+}
+
+/**
+ * This function shall be used to get statistics over the most recent
+ * telemetry samples of a connector
+ *
+ * \param conn_num connector number
+ * \param window_ms Only samples this recent relative to the newest, 0 for the whole ring
+ * \param stats Filled with the statistics
+ *
+ * \returns 0 on success, -ENODATA if the window holds no samples
+ */
+int libtypec_telemetry_stats(int conn_num, unsigned int window_ms, struct libtypec_power_stats *stats)
+{
+	struct telemetry_ring *r;
+	unsigned int hist[TELEMETRY_HIST_BINS];
+	uint64_t from_ns, n, i;
+	long long sum_mv = 0, sum_ma = 0, sum_mw = 0;
+	int ret = 0;
+
+	if (conn_num < 0 || conn_num >= LIBTYPEC_TELEMETRY_MAX_PORTS)
+		return -EINVAL;
+
+	pthread_mutex_lock(&tel.lock);
+
+	r = tel.ring[conn_num];
+	if (!r)
+	{
+		pthread_mutex_unlock(&tel.lock);
+		return -ENODATA;
+	}
+
+	pthread_mutex_lock(&r->lock);
+
+	if (!r->head)
+	{
+		ret = -ENODATA;
+		goto out;
+	}
+
+	memset(stats, 0, sizeof(*stats));
+	stats->last_ns = r->s[(r->head - 1) % LIBTYPEC_TELEMETRY_RING].ts_ns;
+	from_ns = window_ms ? stats->last_ns - (uint64_t)window_ms * 1000000 : 0;
+
+	/* Walk back from the newest sample to the window start */
+	n = r->head < LIBTYPEC_TELEMETRY_RING ? r->head : LIBTYPEC_TELEMETRY_RING;
+	for (i = 0; i < n; i++)
+	{
+		const struct libtypec_power_sample *s = &r->s[(r->head - 1 - i) % LIBTYPEC_TELEMETRY_RING];
+		int mw = (int)(((long long)s->voltage_mv * s->current_ma) / 1000);
+
+		if (s->ts_ns < from_ns)
+			break;
+
+		if (!i || s->voltage_mv < stats->min_mv)
+			stats->min_mv = s->voltage_mv;
+		if (!i || s->voltage_mv > stats->max_mv)
+			stats->max_mv = s->voltage_mv;
+		if (!i || s->current_ma < stats->min_ma)
+			stats->min_ma = s->current_ma;
+		if (!i || s->current_ma > stats->max_ma)
+			stats->max_ma = s->current_ma;
+		if (!i || mw < stats->min_mw)
+			stats->min_mw = mw;
+		if (!i || mw > stats->max_mw)
+			stats->max_mw = mw;
+
+		sum_mv += s->voltage_mv;
+		sum_ma += s->current_ma;
+		sum_mw += mw;
+		stats->first_ns = s->ts_ns;
+	}
+	n = i;
+
+	stats->count = n;
+	stats->mean_mv = sum_mv / (long long)n;
+	stats->mean_ma = sum_ma / (long long)n;
+	stats->mean_mw = sum_mw / (long long)n;
+
+	/* Second pass over the same window for the power distribution */
+	memset(hist, 0, sizeof(hist));
+	for (i = 0; i < n; i++)
+	{
+		const struct libtypec_power_sample *s = &r->s[(r->head - 1 - i) % LIBTYPEC_TELEMETRY_RING];
+		int mw = (int)(((long long)s->voltage_mv * s->current_ma) / 1000);
+		long long bin = 0;
+
+		if (stats->max_mw > stats->min_mw)
+			bin = ((long long)(mw - stats->min_mw) * TELEMETRY_HIST_BINS) / (stats->max_mw - stats->min_mw);
+		if (bin >= TELEMETRY_HIST_BINS)
+			bin = TELEMETRY_HIST_BINS - 1;
+		hist[bin]++;
+	}
+
+	stats->p50_mw = hist_percentile(hist, n, 50, stats->min_mw, stats->max_mw);
+	stats->p90_mw = hist_percentile(hist, n, 90, stats->min_mw, stats->max_mw);
+	stats->p99_mw = hist_percentile(hist, n, 99, stats->min_mw, stats->max_mw);
+
+out:
+	pthread_mutex_unlock(&r->lock);
+	pthread_mutex_unlock(&tel.lock);
+	return ret;
+}
@@ -0,0 +1,387 @@
+/*
+MIT License
+
+Copyright (c) 2022 Rajaram Regupathy <rajaram.regupathy@gmail.com>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+// SPDX-License-Identifier: MIT
+/**
+ * @file libtypec_uevent.c
+ * @author Rajaram Regupathy <rajaram.regupathy@gmail.com>
+ * @brief Kernel uevent listener for libtypec
+ *
+ * Listens on the kernel NETLINK_KOBJECT_UEVENT group directly, so events
+ * arrive without udevd. A classic BPF filter attached to the socket drops
+ * everything but typec, usb_power_delivery and power_supply messages in the
+ * kernel, and the payload is parsed in place in a stack buffer.
+ */
+
+#include "libtypec_ops.h"
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <sys/socket.h>
+#include <linux/netlink.h>
+#include <linux/filter.h>
+
+#define UEVENT_GROUP_KERNEL 1
+#define UEVENT_BUF_SIZE 8192
+#define UEVENT_RCVBUF (1024 * 1024)
+#define UEVENT_PD_MAP_MAX 16
+
+/*
+ * Classic BPF has no loops, so the search for "SUBSYSTEM=" is unrolled: one
+ * 4 instruction block per payload offset, each jumping to a shared verify
+ * block with the offset in X. Loads past the end of the message abort the
+ * filter, which drops the message, so a short message without a match costs
+ * nothing either.
+ *
+ * The program is charged against the socket option memory limit, so the scan
+ * window is halved until the kernel accepts it. SUBSYSTEM= normally sits
+ * within the first few hundred bytes (header, ACTION and DEVPATH).
+ */
+#define UEVENT_SCAN_LEN 1000
+#define UEVENT_SCAN_MIN 128
+#define UEVENT_VERIFY_LEN 28
+#define UEVENT_PROG_LEN (UEVENT_SCAN_LEN * 4 + 1 + UEVENT_VERIFY_LEN)
+
+#define UEV_W(a, b, c, d) ((unsigned)(a) << 24 | (unsigned)(b) << 16 | (unsigned)(c) << 8 | (unsigned)(d))
+
+_Static_assert(UEVENT_PROG_LEN <= BPF_MAXINSNS, "uevent filter exceeds BPF_MAXINSNS");
+
+/* X holds the offset of "SUBS", matches SUBSYSTEM={typec,usb_power_delivery,power_supply}\0 */
+static const struct sock_filter uevent_verify[UEVENT_VERIFY_LEN] = {
+	/* 0 */  BPF_STMT(BPF_LD | BPF_W | BPF_IND, 4),
+	/* 1 */  BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, UEV_W('Y', 'S', 'T', 'E'), 0, 25),
+	/* 2 */  BPF_STMT(BPF_LD | BPF_W | BPF_IND, 8),
+	/* 3 */  BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, UEV_W('M', '=', 't', 'y'), 2, 0),
+	/* 4 */  BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, UEV_W('M', '=', 'u', 's'), 3, 0),
+	/* 5 */  BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, UEV_W('M', '=', 'p', 'o'), 12, 21),
+	/* 6: typec */
+	BPF_STMT(BPF_LD | BPF_W | BPF_IND, 12),
+	/* 7 */  BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, UEV_W('p', 'e', 'c', 0), 18, 19),
+	/* 8: usb_power_delivery */
+	BPF_STMT(BPF_LD | BPF_W | BPF_IND, 12),
+	/* 9 */  BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, UEV_W('b', '_', 'p', 'o'), 0, 17),
+	/* 10 */ BPF_STMT(BPF_LD | BPF_W | BPF_IND, 16),
+	/* 11 */ BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, UEV_W('w', 'e', 'r', '_'), 0, 15),
+	/* 12 */ BPF_STMT(BPF_LD | BPF_W | BPF_IND, 20),
+	/* 13 */ BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, UEV_W('d', 'e', 'l', 'i'), 0, 13),
+	/* 14 */ BPF_STMT(BPF_LD | BPF_W | BPF_IND, 24),
+	/* 15 */ BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, UEV_W('v', 'e', 'r', 'y'), 0, 11),
+	/* 16 */ BPF_STMT(BPF_LD | BPF_B | BPF_IND, 28),
+	/* 17 */ BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, 0, 8, 9),
+	/* 18: power_supply */
+	BPF_STMT(BPF_LD | BPF_W | BPF_IND, 12),
+	/* 19 */ BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, UEV_W('w', 'e', 'r', '_'), 0, 7),
+	/* 20 */ BPF_STMT(BPF_LD | BPF_W | BPF_IND, 16),
+	/* 21 */ BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, UEV_W('s', 'u', 'p', 'p'), 0, 5),
+	/* 22 */ BPF_STMT(BPF_LD | BPF_H | BPF_IND, 20),
+	/* 23 */ BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, ('l' << 8) | 'y', 0, 3),
+	/* 24 */ BPF_STMT(BPF_LD | BPF_B | BPF_IND, 22),
+	/* 25 */ BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, 0, 0, 1),
+	/* 26: accept */
+	BPF_STMT(BPF_RET | BPF_K, 0xffffffff),
+	/* 27: drop */
+	BPF_STMT(BPF_RET | BPF_K, 0),
+};
+
+static struct sock_filter uevent_prog[UEVENT_PROG_LEN];
+
+static unsigned int uevent_build_filter(unsigned int scan_len)
+{
+	unsigned int verify = scan_len * 4 + 1;
+	unsigned int k, pc = 0;
+
+	for (k = 0; k < scan_len; k++, pc += 4)
+	{
+		uevent_prog[pc] = (struct sock_filter)BPF_STMT(BPF_LD | BPF_W | BPF_ABS, k);
+		uevent_prog[pc + 1] = (struct sock_filter)BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, UEV_W('S', 'U', 'B', 'S'), 0, 2);
+		uevent_prog[pc + 2] = (struct sock_filter)BPF_STMT(BPF_LDX | BPF_W | BPF_IMM, k);
+		uevent_prog[pc + 3] = (struct sock_filter)BPF_JUMP(BPF_JMP | BPF_JA, verify - (pc + 4), 0, 0);
+	}
+
+	/* No SUBSYSTEM= within the scanned window */
+	uevent_prog[pc++] = (struct sock_filter)BPF_STMT(BPF_RET | BPF_K, 0);
+
+	memcpy(&uevent_prog[pc], uevent_verify, sizeof(uevent_verify));
+
+	return pc + UEVENT_VERIFY_LEN;
+}
+
+/*
+ * Attach the largest filter the kernel accepts. Without any filter the
+ * listener still works, subsystems are then only filtered while parsing.
+ */
+static void uevent_attach_filter(int fd)
+{
+	unsigned int scan_len;
+
+	for (scan_len = UEVENT_SCAN_LEN; scan_len >= UEVENT_SCAN_MIN; scan_len /= 2)
+	{
+		struct sock_fprog fprog = {
+			.len = uevent_build_filter(scan_len),
+			.filter = uevent_prog,
+		};
+
+		if (setsockopt(fd, SOL_SOCKET, SO_ATTACH_FILTER, &fprog, sizeof(fprog)) == 0 ||
+		    errno != ENOMEM)
+			return;
+	}
+}
+
+/* Connector number from the first "portN" path component, -1 if none */
+static int uevent_port_num(const char *devpath)
+{
+	const char *p = devpath;
+	int port;
+
+	while ((p = strstr(p, "/port")) != NULL)
+	{
+		if (sscanf(p, "/port%d", &port) == 1)
+			return port;
+		p++;
+	}
+
+	return -1;
+}
+
+/*
+ * UCSI and TCPM register pdN objects under the controller, not the port, so
+ * the connector comes from the usb_power_delivery links of portN and
+ * portN-partner. The links are gone by the time an object is removed, so the
+ * connector seen when it was added is remembered. Only the monitor thread
+ * maps events.
+ */
+static struct {
+	char name[16];
+	int conn_num;
+} uevent_pd_map[UEVENT_PD_MAP_MAX];
+static unsigned int uevent_pd_map_next;
+
+static int uevent_pd_link_port(const char *name)
+{
+	char path[512], target[256];
+	struct dirent *de;
+	const char *base;
+	DIR *dir;
+	ssize_t len;
+	int port, end, conn_num = -1;
+
+	dir = opendir(SYSFS_TYPEC_PATH);
+	if (!dir)
+		return -1;
+
+	while (conn_num < 0 && (de = readdir(dir)) != NULL)
+	{
+		end = 0;
+		if (sscanf(de->d_name, "port%d%n", &port, &end) != 1 ||
+		    (de->d_name[end] && strcmp(de->d_name + end, "-partner")))
+			continue;
+
+		snprintf(path, sizeof(path), SYSFS_TYPEC_PATH "/%s/usb_power_delivery", de->d_name);
+		len = readlink(path, target, sizeof(target) - 1);
+		if (len < 0)
+			continue;
+		target[len] = '\0';
+
+		base = strrchr(target, '/');
+		base = base ? base + 1 : target;
+		if (!strcmp(base, name))
+			conn_num = port;
+	}
+
+	closedir(dir);
+
+	return conn_num;
+}
+
+static int uevent_pd_port_num(const char *action, const char *name)
+{
+	int i, conn_num;
+
+	if (strlen(name) >= sizeof(uevent_pd_map[0].name))
+		return -1;
+
+	for (i = 0; i < UEVENT_PD_MAP_MAX; i++)
+	{
+		if (strcmp(uevent_pd_map[i].name, name))
+			continue;
+
+		conn_num = uevent_pd_map[i].conn_num;
+		if (!strcmp(action, "remove"))
+			uevent_pd_map[i].name[0] = '\0';
+		else if (conn_num < 0)
+			conn_num = uevent_pd_map[i].conn_num = uevent_pd_link_port(name);
+
+		return conn_num;
+	}
+
+	if (!strcmp(action, "remove"))
+		return -1;
+
+	conn_num = uevent_pd_link_port(name);
+
+	/* Round robin like the capabilities cache, pdN ids are recycled */
+	i = uevent_pd_map_next++ % UEVENT_PD_MAP_MAX;
+	strcpy(uevent_pd_map[i].name, name);
+	uevent_pd_map[i].conn_num = conn_num;
+
+	return conn_num;
+}
+
+/*
+ * Map a uevent to a libtypec event and fill the connector and change bits of
+ * info. Shared by the raw kernel listener and the udev monitor.
+ *
+ * Returns the event, or -1 if the uevent is of no interest.
+ */
+int libtypec_uevent_event(const char *action, const char *subsystem, const char *devpath,
+			  struct libtypec_event_info *info)
+{
+	const char *name;
+	int event = -1;
+
+	name = strrchr(devpath, '/');
+	name = name ? name + 1 : devpath;
+
+	if (!strcmp(subsystem, "typec"))
+	{
+		if (!strcmp(action, "add"))
+			event = USBC_DEVICE_CONNECTED;
+		else if (!strcmp(action, "remove"))
+			event = USBC_DEVICE_DISCONNECTED;
+		info->changed.ConnectChange = 1;
+		sscanf(name, "port%d", &info->conn_num);
+	}
+	else if (!strcmp(subsystem, "usb_power_delivery"))
+	{
+		if (!strcmp(action, "add") || !strcmp(action, "remove"))
+			event = USBC_PROVIDER_CAPS_CHANGED;
+		info->changed.SupportedProviderCapabilitiesChange = 1;
+		info->conn_num = uevent_port_num(devpath);
+		if (info->conn_num < 0)
+			info->conn_num = uevent_pd_port_num(action, name);
+	}
+	else if (!strcmp(subsystem, "power_supply"))
+	{
+		const char *colon = strrchr(name, ':');
+
+		/* Only Type-C port supplies, not batteries or chargers */
+		if (strncmp(name, "ucsi-source-psy-", 16) && strncmp(name, "tcpm-source-psy-", 16))
+			return -1;
+
+		if (!strcmp(action, "change"))
+			event = USBC_POWER_LEVEL_CHANGED;
+		info->changed.NegotiatedPowerLevelChange = 1;
+		if (!strncmp(name, "ucsi", 4) && colon)
+			info->conn_num = atoi(colon + 1) - 1;
+	}
+
+	return event;
+}
+
+static void uevent_dispatch(char *buf, int len)
+{
+	const char *action = NULL, *devpath = NULL, *subsystem = NULL;
+	struct libtypec_event_info info = { .conn_num = -1 };
+	int event, i;
+
+	/* Skip the "action@devpath" header, then walk KEY=value\0 pairs */
+	for (i = strnlen(buf, len) + 1; i < len; i += strnlen(buf + i, len - i) + 1)
+	{
+		char *kv = buf + i;
+
+		if (!strncmp(kv, "ACTION=", 7))
+			action = kv + 7;
+		else if (!strncmp(kv, "DEVPATH=", 8))
+			devpath = kv + 8;
+		else if (!strncmp(kv, "SUBSYSTEM=", 10))
+			subsystem = kv + 10;
+	}
+
+	if (!action || !devpath || !subsystem)
+		return;
+
+	event = libtypec_uevent_event(action, subsystem, devpath, &info);
+	if (event >= 0)
+		libtypec_notify(event, &info);
+}
+
+/*
+ * Event loop on the raw kernel uevent socket. Returns only if the socket
+ * could not be set up or fails.
+ */
+int libtypec_lnx_monitor_kernel_uevents(void)
+{
+	struct sockaddr_nl addr = {
+		.nl_family = AF_NETLINK,
+		.nl_groups = UEVENT_GROUP_KERNEL,
+	};
+	char buf[UEVENT_BUF_SIZE];
+	int fd, rcvbuf = UEVENT_RCVBUF, ret = 0;
+
+	fd = socket(AF_NETLINK, SOCK_DGRAM | SOCK_CLOEXEC, NETLINK_KOBJECT_UEVENT);
+	if (fd < 0)
+		return -errno;
+
+	setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+
+	/* Attach before bind so nothing unfiltered is queued */
+	uevent_attach_filter(fd);
+
+	if (bind(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0)
+	{
+		ret = -errno;
+		close(fd);
+		return ret;
+	}
+
+	while (1)
+	{
+		struct sockaddr_nl src;
+		socklen_t slen = sizeof(src);
+		ssize_t len;
+
+		len = recvfrom(fd, buf, sizeof(buf) - 1, 0, (struct sockaddr *)&src, &slen);
+		if (len < 0)
+		{
+			if (errno == EINTR || errno == ENOBUFS)
+				continue;
+			ret = -errno;
+			break;
+		}
+
+		/* Only trust messages sent by the kernel */
+		if (slen != sizeof(src) || src.nl_pid != 0)
+			continue;
+
+		buf[len] = '\0';
+		uevent_dispatch(buf, len);
+	}
+
+	close(fd);
+
+	return ret;
+}
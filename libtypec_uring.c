@@ -0,0 +1,387 @@
+/*
+MIT License
+
+Copyright (c) 2022 Rajaram Regupathy <rajaram.regupathy@gmail.com>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+// SPDX-License-Identifier: MIT
+/**
+ * @file libtypec_uring.c
+ * @author Rajaram Regupathy <rajaram.regupathy@gmail.com>
+ * @brief Batched sysfs attribute reads for libtypec
+ *
+ * A batch of attribute files is read with io_uring in three submissions:
+ * all OPENATs, then READ_FIXED into a registered buffer, then all CLOSEs.
+ * Kernels or builds without io_uring support use plain open/read/close.
+ */
+
+#include "libtypec_ops.h"
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+
+#ifdef LIBTYPEC_HAVE_IO_URING
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <linux/io_uring.h>
+
+#define URING_ENTRIES 256
+#define URING_PROBE_OPS 64
+
+struct uring {
+	int fd;
+	unsigned int *sq_tail, *sq_mask, *sq_array;
+	unsigned int *cq_head, *cq_tail, *cq_mask;
+	struct io_uring_sqe *sqes;
+	struct io_uring_cqe *cqes;
+	void *sq_ptr, *cq_ptr;
+	size_t sq_len, cq_len;
+	/* registered buffer, one LIBTYPEC_ATTR_LEN slot per ring entry */
+	char *bufs;
+};
+
+static struct uring ring = { .fd = -1 };
+static int ring_state;	/* 0 not tried, 1 ready, -1 unavailable */
+#endif
+
+static pthread_mutex_t attr_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static void attr_read_sync(struct libtypec_attr *a)
+{
+	int fd = open(a->path, O_RDONLY | O_CLOEXEC);
+
+	if (fd < 0)
+	{
+		a->len = -errno;
+		return;
+	}
+
+	a->len = read(fd, a->val, LIBTYPEC_ATTR_LEN - 1);
+	if (a->len < 0)
+		a->len = -errno;
+	else
+		a->val[a->len] = '\0';
+
+	close(fd);
+}
+
+#ifdef LIBTYPEC_HAVE_IO_URING
+static int uring_ops_supported(int fd)
+{
+	static const unsigned char needed[] = { IORING_OP_OPENAT, IORING_OP_READ_FIXED, IORING_OP_CLOSE };
+	struct io_uring_probe *probe;
+	unsigned int i;
+	int ok = 0;
+
+	probe = calloc(1, sizeof(*probe) + URING_PROBE_OPS * sizeof(struct io_uring_probe_op));
+	if (!probe)
+		return 0;
+
+	if (syscall(__NR_io_uring_register, fd, IORING_REGISTER_PROBE, probe, URING_PROBE_OPS) == 0)
+	{
+		ok = 1;
+		for (i = 0; i < sizeof(needed); i++)
+		{
+			if (needed[i] > probe->last_op || !(probe->ops[needed[i]].flags & IO_URING_OP_SUPPORTED))
+				ok = 0;
+		}
+	}
+
+	free(probe);
+
+	return ok;
+}
+
+static void uring_teardown(void)
+{
+	if (ring.bufs)
+		free(ring.bufs);
+	if (ring.cq_ptr && ring.cq_ptr != ring.sq_ptr)
+		munmap(ring.cq_ptr, ring.cq_len);
+	if (ring.sq_ptr)
+		munmap(ring.sq_ptr, ring.sq_len);
+	if (ring.sqes)
+		munmap(ring.sqes, URING_ENTRIES * sizeof(struct io_uring_sqe));
+	if (ring.fd >= 0)
+		close(ring.fd);
+
+	memset(&ring, 0, sizeof(ring));
+	ring.fd = -1;
+}
+
+static int uring_setup(void)
+{
+	struct io_uring_params p;
+	struct iovec iov;
+	char *sq, *cq;
+
+	memset(&p, 0, sizeof(p));
+
+	ring.fd = syscall(__NR_io_uring_setup, URING_ENTRIES, &p);
+	if (ring.fd < 0 || !uring_ops_supported(ring.fd))
+		goto fail;
+
+	ring.sq_len = p.sq_off.array + p.sq_entries * sizeof(unsigned int);
+	ring.cq_len = p.cq_off.cqes + p.cq_entries * sizeof(struct io_uring_cqe);
+	if ((p.features & IORING_FEAT_SINGLE_MMAP) && ring.cq_len > ring.sq_len)
+		ring.sq_len = ring.cq_len;
+
+	ring.sq_ptr = mmap(NULL, ring.sq_len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+			   ring.fd, IORING_OFF_SQ_RING);
+	if (ring.sq_ptr == MAP_FAILED)
+	{
+		ring.sq_ptr = NULL;
+		goto fail;
+	}
+
+	if (p.features & IORING_FEAT_SINGLE_MMAP)
+		ring.cq_ptr = ring.sq_ptr;
+	else
+	{
+		ring.cq_ptr = mmap(NULL, ring.cq_len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+				   ring.fd, IORING_OFF_CQ_RING);
+		if (ring.cq_ptr == MAP_FAILED)
+		{
+			ring.cq_ptr = NULL;
+			goto fail;
+		}
+	}
+
+	ring.sqes = mmap(NULL, URING_ENTRIES * sizeof(struct io_uring_sqe), PROT_READ | PROT_WRITE,
+			 MAP_SHARED | MAP_POPULATE, ring.fd, IORING_OFF_SQES);
+	if (ring.sqes == MAP_FAILED)
+	{
+		ring.sqes = NULL;
+		goto fail;
+	}
+
+	sq = ring.sq_ptr;
+	cq = ring.cq_ptr;
+	ring.sq_tail = (unsigned int *)(sq + p.sq_off.tail);
+	ring.sq_mask = (unsigned int *)(sq + p.sq_off.ring_mask);
+	ring.sq_array = (unsigned int *)(sq + p.sq_off.array);
+	ring.cq_head = (unsigned int *)(cq + p.cq_off.head);
+	ring.cq_tail = (unsigned int *)(cq + p.cq_off.tail);
+	ring.cq_mask = (unsigned int *)(cq + p.cq_off.ring_mask);
+	ring.cqes = (struct io_uring_cqe *)(cq + p.cq_off.cqes);
+
+	if (posix_memalign((void **)&ring.bufs, 4096, URING_ENTRIES * LIBTYPEC_ATTR_LEN))
+	{
+		ring.bufs = NULL;
+		goto fail;
+	}
+
+	iov.iov_base = ring.bufs;
+	iov.iov_len = URING_ENTRIES * LIBTYPEC_ATTR_LEN;
+	if (syscall(__NR_io_uring_register, ring.fd, IORING_REGISTER_BUFFERS, &iov, 1) < 0)
+		goto fail;
+
+	return 0;
+
+fail:
+	uring_teardown();
+	return -1;
+}
+
+static struct io_uring_sqe *uring_sqe(unsigned int idx)
+{
+	struct io_uring_sqe *sqe = &ring.sqes[idx];
+
+	memset(sqe, 0, sizeof(*sqe));
+
+	return sqe;
+}
+
+/*
+ * Submit the nr SQEs prepared in slots 0..nr-1 and wait for all of them.
+ * res[user_data] receives each completion result.
+ */
+static int uring_run(unsigned int nr, int *res)
+{
+	unsigned int tail = *ring.sq_tail, done = 0, submit = nr, i;
+
+	for (i = 0; i < nr; i++)
+		ring.sq_array[(tail + i) & *ring.sq_mask] = i;
+	__atomic_store_n(ring.sq_tail, tail + nr, __ATOMIC_RELEASE);
+
+	while (done < nr)
+	{
+		unsigned int head, ctail;
+		long ret;
+
+		ret = syscall(__NR_io_uring_enter, ring.fd, submit, nr - done, IORING_ENTER_GETEVENTS, NULL, 0);
+		if (ret < 0)
+		{
+			if (errno == EINTR)
+				continue;
+			return -errno;
+		}
+		submit -= ret;
+
+		head = *ring.cq_head;
+		ctail = __atomic_load_n(ring.cq_tail, __ATOMIC_ACQUIRE);
+		for (; head != ctail; head++, done++)
+		{
+			struct io_uring_cqe *cqe = &ring.cqes[head & *ring.cq_mask];
+
+			res[cqe->user_data] = cqe->res;
+		}
+		__atomic_store_n(ring.cq_head, head, __ATOMIC_RELEASE);
+	}
+
+	return 0;
+}
+
+static int attr_read_uring(struct libtypec_attr *attrs, int n)
+{
+	int fds[URING_ENTRIES], res[URING_ENTRIES], closed[URING_ENTRIES];
+	unsigned int nr = 0;
+	int i;
+
+	/* Phase 1: open everything */
+	for (i = 0; i < n; i++)
+	{
+		struct io_uring_sqe *sqe = uring_sqe(i);
+
+		/* Opens that never complete leave nothing to close */
+		fds[i] = -1;
+		closed[i] = 1;
+
+		sqe->opcode = IORING_OP_OPENAT;
+		sqe->fd = AT_FDCWD;
+		sqe->addr = (unsigned long)attrs[i].path;
+		sqe->open_flags = O_RDONLY | O_CLOEXEC;
+		sqe->user_data = i;
+	}
+	if (uring_run(n, fds) < 0)
+		goto close_fds;
+
+	/* Phase 2: read into the registered buffer */
+	for (i = 0; i < n; i++)
+	{
+		struct io_uring_sqe *sqe;
+
+		res[i] = fds[i];
+		if (fds[i] < 0)
+			continue;
+
+		sqe = uring_sqe(nr++);
+		sqe->opcode = IORING_OP_READ_FIXED;
+		sqe->fd = fds[i];
+		sqe->addr = (unsigned long)(ring.bufs + i * LIBTYPEC_ATTR_LEN);
+		sqe->len = LIBTYPEC_ATTR_LEN - 1;
+		sqe->buf_index = 0;
+		sqe->user_data = i;
+	}
+	if (nr && uring_run(nr, res) < 0)
+		goto close_fds;
+
+	/* Phase 3: close */
+	nr = 0;
+	for (i = 0; i < n; i++)
+	{
+		struct io_uring_sqe *sqe;
+
+		if (fds[i] < 0)
+			continue;
+
+		sqe = uring_sqe(nr++);
+		sqe->opcode = IORING_OP_CLOSE;
+		sqe->fd = fds[i];
+		sqe->user_data = i;
+	}
+	/* closed[i] drops from 1 to the close result once it completes */
+	if (nr && uring_run(nr, closed) < 0)
+		goto close_fds;
+
+	for (i = 0; i < n; i++)
+	{
+		attrs[i].len = res[i];
+		if (res[i] >= 0)
+		{
+			memcpy(attrs[i].val, ring.bufs + i * LIBTYPEC_ATTR_LEN, res[i]);
+			attrs[i].val[res[i]] = '\0';
+		}
+	}
+
+	return 0;
+
+close_fds:
+	for (i = 0; i < n; i++)
+	{
+		if (fds[i] >= 0 && closed[i] > 0)
+			close(fds[i]);
+	}
+	return -1;
+}
+#endif
+
+/*
+ * Read a batch of sysfs attributes. Each attrs[i].len receives the number of
+ * bytes read or a negative errno, attrs[i].val the NUL terminated content.
+ *
+ * Returns 0, individual failures are reported per attribute.
+ */
+int libtypec_read_attrs(struct libtypec_attr *attrs, int n)
+{
+	int i = 0;
+
+	pthread_mutex_lock(&attr_lock);
+
+#ifdef LIBTYPEC_HAVE_IO_URING
+	if (ring_state == 0)
+		ring_state = uring_setup() == 0 ? 1 : -1;
+
+	while (ring_state > 0 && i < n)
+	{
+		int chunk = n - i < URING_ENTRIES ? n - i : URING_ENTRIES;
+
+		if (attr_read_uring(attrs + i, chunk) < 0)
+		{
+			uring_teardown();
+			ring_state = -1;
+			break;
+		}
+		i += chunk;
+	}
+#endif
+
+	for (; i < n; i++)
+		attr_read_sync(&attrs[i]);
+
+	pthread_mutex_unlock(&attr_lock);
+
+	return 0;
+}
+
+/* Numeric value of an attribute, dflt if it could not be read */
+unsigned long libtypec_attr_ul(const struct libtypec_attr *a, int base, unsigned long dflt)
+{
+	if (a->len <= 0)
+		return dflt;
+
+	return strtoul(a->val, NULL, base);
+}
@@ -0,0 +1,79 @@
+/*
+MIT License
+
+Copyright (c) 2022 Rajaram Regupathy <rajaram.regupathy@gmail.com>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+// SPDX-License-Identifier: MIT
+/**
+ * @file libtypec_vdo.c
+ * @author Rajaram Regupathy <rajaram.regupathy@gmail.com>
+ * @brief Decoding of identity, alternate mode VDOs and PDOs into fields
+ */
+
+#include "libtypec.h"
+#include <errno.h>
+#include <stddef.h>
+#include "libtypec_vdo_tables.h"
+
+/**
+ * Splits a VDO or PDO into the fields of the given layout. Reserved bits are
+ * skipped.
+ *
+ * \param layout Field layout to decode with, chosen by the caller from the
+ *	PD revision and product type
+ *
+ * \param vdo Object to decode
+ *
+ * \param field Output array; LIBTYPEC_VDO_MAX_FIELDS entries always suffice
+ *
+ * \param max Number of entries in field
+ *
+ * \returns Number of fields decoded, -EINVAL on an unknown layout
+ */
+int libtypec_decode_vdo(enum libtypec_vdo_layout layout, uint32_t vdo, struct libtypec_vdo_field *field, int max)
+{
+	const struct vdo_field_desc *d;
+	unsigned int i, n;
+
+	if ((unsigned int)layout >= LIBTYPEC_VDO_LAYOUT_COUNT || !field || max < 0)
+		return -EINVAL;
+
+	d = vdo_layouts[layout].fields;
+	n = vdo_layouts[layout].num;
+	if (n > (unsigned int)max)
+		n = max;
+
+	for (i = 0; i < n; i++, d++)
+	{
+		uint32_t raw = (vdo >> d->shift) & d->mask;
+
+		field[i].name = d->name;
+		field[i].name_len = d->name_len;
+		field[i].flags = d->flags;
+		field[i].raw = raw;
+		field[i].value = raw * d->scale;
+		field[i].unit = d->unit;
+		field[i].desc = raw < d->num_enums ? d->enums[raw] : NULL;
+	}
+
+	return n;
+}
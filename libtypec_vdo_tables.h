@@ -0,0 +1,808 @@
+/*
+MIT License
+
+Copyright (c) 2022 Rajaram Regupathy <rajaram.regupathy@gmail.com>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+// SPDX-License-Identifier: MIT
+/**
+ * @file libtypec_vdo_tables.h
+ * @author Rajaram Regupathy <rajaram.regupathy@gmail.com>
+ * @brief Field layouts of USB PD VDOs and PDOs, included by libtypec_vdo.c
+ *
+ * Only fields worth showing are listed; reserved bits are left out. Units,
+ * scales and name lengths are resolved here so decoding never looks at the
+ * field names.
+ */
+
+#ifndef LIBTYPEC_VDO_TABLES_H
+#define LIBTYPEC_VDO_TABLES_H
+
+struct vdo_field_desc {
+	const char *name;
+	const char *unit;
+	const char *const *enums;
+	uint32_t mask;
+	uint16_t scale;
+	uint8_t shift;
+	uint8_t num_enums;
+	uint8_t name_len;
+	uint8_t flags;
+};
+
+#define VDO_FIELD(n, s, m) { n, NULL, NULL, m, 1, s, 0, sizeof(n) - 1, 0 }
+#define VDO_VID(n, s, m) { n, NULL, NULL, m, 1, s, 0, sizeof(n) - 1, LIBTYPEC_VDO_FIELD_VID }
+#define VDO_UNIT(n, s, m, scale, unit) { n, unit, NULL, m, scale, s, 0, sizeof(n) - 1, 0 }
+#define VDO_ENUM(n, s, m, e) { n, NULL, e, m, 1, s, sizeof(e) / sizeof(e[0]), sizeof(n) - 1, 0 }
+
+static const char *const vdo_enum_no_yes[] = { "No", "Yes" };
+static const char *const pd2p0_partner_id_header_product_type_ufp[] = {
+	"Undefined", "PDUSB Hub", "PDUSB Peripheral", "Reserved", "Reserved", "Alternate Mode Adapter",
+	"Reserved", "Reserved"
+};
+static const char *const pd2p0_cable_id_header_product_type_ufp[] = {
+	"Undefined", "Reserved", "Reserved", "Passive Cable", "Active Cable", "Reserved", "Reserved",
+	"Reserved"
+};
+static const char *const pd2p0_passive_cable_usb_superspeed_support[] = {
+	"USB 2.0 Only", "USB 3.1 Gen1", "USB 3.1 Gen1 and Gen2", "Reserved", "Reserved", "Reserved",
+	"Reserved", "Reserved"
+};
+static const char *const pd2p0_passive_cable_vbus_current_handling[] = { "Reserved", "3A", "5A", "Reserved" };
+static const char *const vdo_enum_fixed_configurable[] = { "Fixed", "Configurable" };
+static const char *const pd2p0_passive_cable_cable_termination_type[] = {
+	"Vconn Not Required", "Vconn Required", "Reserved", "Reserved"
+};
+static const char *const pd2p0_passive_cable_cable_latency[] = {
+	"Reserved", "<10ns (~1m)", "10ns to 20ns (~2m)", "20ns to 30ns (~3m)", "30ns to 40ns (~4m)",
+	"40ns to 50ns (~5m)", "50ns to 60ns (~6m)", "60ns to 70ns (~7m)", " 70ns (>~7m)", "Reserved",
+	"Reserved", "Reserved", "Reserved", "Reserved", "Reserved", "Reserved"
+};
+static const char *const pd2p0_passive_cable_usb_type_c_plug_to[] = {
+	"USB Type-A", "USB Type-B", "USB Type-C", "Captive"
+};
+static const char *const pd2p0_ama_vconn_power[] = { "1W", "1.5W", "2W", "3W", "4W", "5W", "6W", "Reserved" };
+static const char *const pd3p0_partner_id_header_product_type_dfp[] = {
+	"Undefined", "PDUSB Hub", "PDUSB Host", "Power Brick", "Alternate Mode Controller", "Reserved",
+	"Reserved", "Reserved"
+};
+static const char *const pd3p0_partner_id_header_product_type_ufp[] = {
+	"Undefined", "PDUSB Hub", "PDUSB Peripheral", "PSD", "Reserved", "Alternate Mode Adapter",
+	"Vconn Powered USB Device", "Reserved"
+};
+static const char *const pd3p0_passive_cable_usb_highest_speed[] = {
+	"USB 2.0 Only", "USB 3.2 Gen1", "USB 3.2/USB4 Gen2", "USB4 Gen3", "Reserved", "Reserved",
+	"Reserved", "Reserved"
+};
+static const char *const pd3p0_passive_cable_maximum_vbus_voltage[] = { "20V", "30V", "40V", "50V" };
+static const char *const pd3p0_passive_cable_connector_type[] = {
+	"Reserved", "Reserved", "USB Type-C", "Captive"
+};
+static const char *const pd3p0_passive_cable_vdo_version[] = {
+	"Version 1.0", "Reserved", "Reserved", "Reserved", "Reserved", "Reserved", "Reserved", "Reserved"
+};
+static const char *const pd3p0_active_cable_vdo1_vbus_current_handling[] = {
+	"USB Type-C Default Current", "3A", "5A", "Reserved"
+};
+static const char *const pd3p0_active_cable_vdo1_sbu_type[] = { "SBU is passive", "SBU is active" };
+static const char *const pd3p0_active_cable_vdo1_sbu_supported[] = {
+	"SBU connections supported", "SBU connections are not supported"
+};
+static const char *const pd3p0_active_cable_vdo1_cable_termination_type[] = {
+	"Reserved", "Reserved", "One end active, one end passive, Vconn required",
+	"Both ends active, Vconn required"
+};
+static const char *const pd3p0_active_cable_vdo1_cable_latency[] = {
+	"Reserved", "<10ns (~1m)", "10ns to 20ns (~2m)", "20ns to 30ns (~3m)", "30ns to 40ns (~4m)",
+	"40ns to 50ns (~5m)", "50ns to 60ns (~6m)", "60ns to 70ns (~7m)", "1000b –1000ns (~100m)",
+	"1001b –2000ns (~200m)", "1010b – 3000ns (~300m)", "Reserved", "Reserved", "Reserved", "Reserved",
+	"Reserved"
+};
+static const char *const pd3p0_active_cable_vdo1_vdo_version[] = {
+	"Reserved", "Reserved", "Reserved", "Version 1.3", "Reserved", "Reserved", "Reserved", "Reserved"
+};
+static const char *const vdo_enum_gen_1_gen_2_or_higher[] = { "Gen 1", "Gen 2 or higher" };
+static const char *const vdo_enum_one_lane_two_lanes[] = { "One Lane", "Two Lanes" };
+static const char *const pd3p0_active_cable_vdo2_usb_3_2_supported[] = {
+	"USB 3.2 SuperSpeed supported", "USB 3.2 SuperSpeed not supported"
+};
+static const char *const pd3p0_active_cable_vdo2_usb_2_0_supported[] = {
+	"USB 2.0 supported", "USB 2.0 not supported"
+};
+static const char *const pd3p0_active_cable_vdo2_usb4_supported[] = {
+	"USB4 Supported", "USB4 Not Supported"
+};
+static const char *const pd3p0_active_cable_vdo2_active_element[] = { "Active Redriver", "Active Retimer" };
+static const char *const vdo_enum_copper_optical[] = { "Copper", "Optical" };
+static const char *const pd3p0_active_cable_vdo2_u3_to_u0_transition_mode[] = {
+	"U3 to U0 direct", "U3 to U0 through U35"
+};
+static const char *const pd3p0_active_cable_vdo2_u3_cld_power[] = {
+	">10mW", "5-10mW", "1-5mW", "0.5-1mW", "0.2-0.5mW", "50-200uW", "<50uW", "Reserved"
+};
+static const char *const pd3p0_ama_usb_highest_speed[] = {
+	"USB 2.0 only", "USB 3.2 Gen1 and USB 2.0", "USB 3.2 Gen1, Gen2 and USB 2.0", "billboard only",
+	"Reserved", "Reserved", "Reserved", "Reserved"
+};
+static const char *const vdo_enum_3a_capable_5a_capable[] = { "3A capable", "5A capable" };
+static const char *const pd3p0_ufp_vdo1_usb_highest_speed[] = {
+	"USB 2.0 only", "USB 3.2 Gen1", "USB 3.2/USB4 Gen2", "USB4 Gen3", "Reserved", "Reserved",
+	"Reserved", "Reserved"
+};
+static const char *const pd3p0_fixed_supply_snk_fast_role_swap_required[] = {
+	"Fast Swap not supported", "Default USB Power", "1.5A @ 5V", "3.0A @ 5V"
+};
+static const char *const pd3p1_partner_id_header_connector_type[] = {
+	"Reserved", "Reserved", "USB Type-C Receptacle", "USB Type-C Plug"
+};
+static const char *const pd3p1_passive_cable_maximum_vbus_voltage[] = {
+	"20V", "30V (Deprecated)", "40V (Deprecated)", "50V"
+};
+static const char *const pd3p1_vpd_maximum_vbus_voltage[] = {
+	"20V", "30V (Deprecated)", "40V (Deprecated)", "50V (Deprecated)"
+};
+static const char *const vdo_enum_yes_no[] = { "Yes", "No" };
+static const char *const dp_alt_mode_partner_port_capability[] = {
+	"Reserved", "DP Sink Deice Capable", "DP Source Device Capable",
+	"Both Sink and Source Device Capable"
+};
+static const char *const dp_alt_mode_partner_receptacle_indication[] = {
+	"DP interface presents as a plug", "DP interface presents as a receptacle"
+};
+static const char *const dp_alt_mode_partner_usb_2_0_signaling_not_used[] = {
+	"USB 2.0 may be needed", "USB 2.0 not needed"
+};
+static const char *const tbt3_sop_tbt_adapter[] = { "TBT3 Adapter", "TBT2 Legacy Adapter" };
+static const char *const vdo_enum_not_supported_supported[] = { "Not Supported", "Supported" };
+static const char *const tbt3_sop_pr_cable_speed[] = {
+	"Reserved", "USB 3.1 Gen1 (10 Gbps TBT Support)",
+	"10 Gbps (USB 3.2 Gen1 and Gen2 passive cables)",
+	"10 Gbps and 20 Gbps (TBT 3rd Gen active cables and 20 Gbps passive cables)", "Reserved",
+	"Reserved", "Reserved", "Reserved"
+};
+static const char *const tbt3_sop_pr_tbt_rounded_support[] = {
+	"3rd Gen Non-Rounded TBT", "3rd & 4th Gen Rounded and Non-Rounded TBT", "Reserved", "Reserved"
+};
+static const char *const vdo_enum_non_optical_optical[] = { "Non-Optical", "Optical" };
+static const char *const vdo_enum_not_re_timer_re_timer[] = { "Not re-timer", "Re-timer" };
+static const char *const tbt3_sop_pr_active_cable_plug_link_training[] = {
+	"Active with bi-directional LSRX", "Active with uni-directional LSRX"
+};
+static const char *const tbt3_sop_pr_active_passive[] = { "Passive Cable", "Active Cable" };
+
+/* USB PD 2.0 ID Header VDO (Section 6.4.4.3.1.1) */
+static const struct vdo_field_desc pd2p0_partner_id_header[] = {
+	VDO_VID("USB Vendor ID", 0, 0xffff),
+	VDO_ENUM("Modal Operation Supported", 26, 0x1, vdo_enum_no_yes),
+	VDO_ENUM("Produt Type (UFP)", 27, 0x7, pd2p0_partner_id_header_product_type_ufp),
+	VDO_ENUM("USB Capable as a Device", 30, 0x1, vdo_enum_no_yes),
+	VDO_ENUM("USB Capable as a Host", 31, 0x1, vdo_enum_no_yes),
+};
+
+static const struct vdo_field_desc pd2p0_cable_id_header[] = {
+	VDO_VID("USB Vendor ID", 0, 0xffff),
+	VDO_ENUM("Modal Operation Supported", 26, 0x1, vdo_enum_no_yes),
+	VDO_ENUM("Produt Type (UFP)", 27, 0x7, pd2p0_cable_id_header_product_type_ufp),
+	VDO_ENUM("USB Capable as a Device", 30, 0x1, vdo_enum_no_yes),
+	VDO_ENUM("USB Capable as a Host", 31, 0x1, vdo_enum_no_yes),
+};
+
+/* USB PD 2.0 Cert Stat VDO (Section 6.4.4.3.1.2) */
+static const struct vdo_field_desc pd2p0_cert_stat[] = {
+	VDO_FIELD("XID", 0, 0xffffffff),
+};
+
+/* USB PD 2.0 Product VDO (Section 6.4.4.3.1.3) */
+static const struct vdo_field_desc pd2p0_product[] = {
+	VDO_FIELD("bcdDevice", 0, 0xffff),
+	VDO_FIELD("USB Product ID", 16, 0xffff),
+};
+
+/* USB PD 2.0 Passive Cable VDO (Section 6.4.4.3.1.4.1) */
+static const struct vdo_field_desc pd2p0_passive_cable[] = {
+	VDO_ENUM("USB SuperSpeed Support", 0, 0x7, pd2p0_passive_cable_usb_superspeed_support),
+	VDO_ENUM("Vbus Through Cable", 4, 0x1, vdo_enum_no_yes),
+	VDO_ENUM("Vbus Current Handling", 5, 0x3, pd2p0_passive_cable_vbus_current_handling),
+	VDO_ENUM("SSRX2 Support", 7, 0x1, vdo_enum_fixed_configurable),
+	VDO_ENUM("SSRX1 Support", 8, 0x1, vdo_enum_fixed_configurable),
+	VDO_ENUM("SSTX2 Support", 9, 0x1, vdo_enum_fixed_configurable),
+	VDO_ENUM("SSTX1 Support", 10, 0x1, vdo_enum_fixed_configurable),
+	VDO_ENUM("Cable Termination Type", 11, 0x3, pd2p0_passive_cable_cable_termination_type),
+	VDO_ENUM("Cable Latency", 13, 0xf, pd2p0_passive_cable_cable_latency),
+	VDO_ENUM("USB Type-C plug to", 18, 0x3, pd2p0_passive_cable_usb_type_c_plug_to),
+	VDO_FIELD("Firmware Version", 24, 0xf),
+	VDO_FIELD("HW Version", 28, 0xf),
+};
+
+/* USB PD 2.0 Active Cable VDO (Section 6.4.4.3.1.4.2) */
+static const struct vdo_field_desc pd2p0_active_cable[] = {
+	VDO_ENUM("USB SuperSpeed Support", 0, 0x7, pd2p0_passive_cable_usb_superspeed_support),
+	VDO_FIELD("SOP'' Controller Present", 3, 0x1),
+	VDO_ENUM("Vbus Through Cable", 4, 0x1, vdo_enum_no_yes),
+	VDO_ENUM("Vbus Current Handling", 5, 0x3, pd2p0_passive_cable_vbus_current_handling),
+	VDO_ENUM("SSRX2 Support", 7, 0x1, vdo_enum_fixed_configurable),
+	VDO_ENUM("SSRX1 Support", 8, 0x1, vdo_enum_fixed_configurable),
+	VDO_ENUM("SSTX2 Support", 9, 0x1, vdo_enum_fixed_configurable),
+	VDO_ENUM("SSTX1 Support", 10, 0x1, vdo_enum_fixed_configurable),
+	VDO_ENUM("Cable Termination Type", 11, 0x3, pd2p0_passive_cable_cable_termination_type),
+	VDO_ENUM("Cable Latency", 13, 0xf, pd2p0_passive_cable_cable_latency),
+	VDO_ENUM("USB Type-C plug to", 18, 0x3, pd2p0_passive_cable_usb_type_c_plug_to),
+	VDO_FIELD("Firmware Version", 24, 0xf),
+	VDO_FIELD("HW Version", 28, 0xf),
+};
+
+/* USB PD 2.0 AMA VDO (Section 6.4.4.3.1.5) */
+static const struct vdo_field_desc pd2p0_ama[] = {
+	VDO_ENUM("USB SuperSpeed Support", 0, 0x7, pd2p0_passive_cable_usb_superspeed_support),
+	VDO_ENUM("Vbus required", 3, 0x1, vdo_enum_no_yes),
+	VDO_ENUM("Vconn required", 4, 0x1, vdo_enum_no_yes),
+	VDO_ENUM("Vconn power", 5, 0x7, pd2p0_ama_vconn_power),
+	VDO_ENUM("SSRX2 Support", 8, 0x1, vdo_enum_fixed_configurable),
+	VDO_ENUM("SSRX1 Support", 9, 0x1, vdo_enum_fixed_configurable),
+	VDO_ENUM("SSTX2 Support", 10, 0x1, vdo_enum_fixed_configurable),
+	VDO_ENUM("SSTX1 Support", 11, 0x1, vdo_enum_fixed_configurable),
+	VDO_FIELD("Firmware Version", 24, 0xf),
+	VDO_FIELD("HW Version", 28, 0xf),
+};
+
+/* USB PD 2.0 Fixed Supply PDO - Source (Section 6.4.1.2.3) */
+static const struct vdo_field_desc pd2p0_fixed_supply_src[] = {
+	VDO_UNIT("Maximum Current in 10mA units", 0, 0x3ff, 10, "mA"),
+	VDO_UNIT("Voltage in 50mV units", 10, 0x3ff, 50, "mV"),
+	VDO_FIELD("Peak Current", 20, 0x3),
+	VDO_FIELD("Dual-Role Data", 25, 0x1),
+	VDO_FIELD("USB Communications Capable", 26, 0x1),
+	VDO_FIELD("Unconstrained Power", 27, 0x1),
+	VDO_FIELD("USB Suspend Supported", 28, 0x1),
+	VDO_FIELD("Daul-Role Power", 29, 0x1),
+	VDO_FIELD("Fixed supply", 30, 0x3),
+};
+
+/* USB PD 2.0 Variable Supply PDO - Source (Section 6.4.1.2.4) */
+static const struct vdo_field_desc pd2p0_variable_supply_src[] = {
+	VDO_UNIT("Maximum Current in 10mA units", 0, 0x3ff, 10, "mA"),
+	VDO_UNIT("Minimum Voltage in 50mV units", 10, 0x3ff, 50, "mV"),
+	VDO_UNIT("Maximum Voltage in 50mV units", 20, 0x3ff, 50, "mV"),
+	VDO_FIELD("Variable Supply", 30, 0x3),
+};
+
+/* USB PD 2.0 Battery Supply PDO - Source (Section 6.4.1.2.5) */
+static const struct vdo_field_desc pd2p0_battery_supply_src[] = {
+	VDO_UNIT("Maximum Allowable Power in 250mW units", 0, 0x3ff, 250, "mW"),
+	VDO_UNIT("Minimum Voltage in 50mV units", 10, 0x3ff, 50, "mV"),
+	VDO_UNIT("Maximum Voltage in 50mV units", 20, 0x3ff, 50, "mV"),
+	VDO_FIELD("Battery", 30, 0x3),
+};
+
+/* USB PD 2.0 Fixed Supply PDO - Sink (Section 6.4.1.3.1) */
+static const struct vdo_field_desc pd2p0_fixed_supply_snk[] = {
+	VDO_UNIT("Operational Current in 10mA units", 0, 0x3ff, 10, "mA"),
+	VDO_UNIT("Voltage in 50mV units", 10, 0x3ff, 50, "mV"),
+	VDO_FIELD("Dual-Role Data", 25, 0x1),
+	VDO_FIELD("USB Communications Capable", 26, 0x1),
+	VDO_FIELD("Unconstrained Power", 27, 0x1),
+	VDO_FIELD("Higher Capability", 28, 0x1),
+	VDO_FIELD("Daul-Role Power", 29, 0x1),
+	VDO_FIELD("Fixed supply", 30, 0x3),
+};
+
+/* USB PD 2.0 Variable Supply PDO - Sink (Section 6.4.1.3.2) */
+static const struct vdo_field_desc pd2p0_variable_supply_snk[] = {
+	VDO_UNIT("Operational Current in 10mA units", 0, 0x3ff, 10, "mA"),
+	VDO_UNIT("Minimum Voltage in 50mV units", 10, 0x3ff, 50, "mV"),
+	VDO_UNIT("Maximum Voltage in 50mV units", 20, 0x3ff, 50, "mV"),
+	VDO_FIELD("Variable Supply", 30, 0x3),
+};
+
+/* USB PD 2.0 Battery Supply PDO - Sink (Section 6.4.1.3.3) */
+static const struct vdo_field_desc pd2p0_battery_supply_snk[] = {
+	VDO_UNIT("Operational Power in 250mW units", 0, 0x3ff, 250, "mW"),
+	VDO_UNIT("Minimum Voltage in 50mV units", 10, 0x3ff, 50, "mV"),
+	VDO_UNIT("Maximum Voltage in 50mV units", 20, 0x3ff, 50, "mV"),
+	VDO_FIELD("Battery", 30, 0x3),
+};
+
+/* USB PD 3.0 ID Header VDO (Section 6.4.4.3.1.1) */
+static const struct vdo_field_desc pd3p0_partner_id_header[] = {
+	VDO_VID("USB Vendor ID", 0, 0xffff),
+	VDO_ENUM("Product Type (DFP)", 23, 0x7, pd3p0_partner_id_header_product_type_dfp),
+	VDO_ENUM("Modal Operation Supported", 26, 0x1, vdo_enum_no_yes),
+	VDO_ENUM("Product Type (UFP)", 27, 0x7, pd3p0_partner_id_header_product_type_ufp),
+	VDO_ENUM("USB Capable as a Device", 30, 0x1, vdo_enum_no_yes),
+	VDO_ENUM("USB Capable as a Host", 31, 0x1, vdo_enum_no_yes),
+};
+
+static const struct vdo_field_desc pd3p0_cable_id_header[] = {
+	VDO_VID("USB Vendor ID", 0, 0xffff),
+	VDO_ENUM("Modal Operation Supported", 26, 0x1, vdo_enum_no_yes),
+	VDO_ENUM("Product Type (Cable Plug)", 27, 0x7, pd2p0_cable_id_header_product_type_ufp),
+	VDO_ENUM("USB Capable as a Device", 30, 0x1, vdo_enum_no_yes),
+	VDO_ENUM("USB Capable as a Host", 31, 0x1, vdo_enum_no_yes),
+};
+
+/* USB PD 3.0 Cert Stat VDO (Section 6.4.4.3.1.2) */
+static const struct vdo_field_desc pd3p0_cert_stat[] = {
+	VDO_FIELD("XID", 0, 0xffffffff),
+};
+
+/* USB PD 3.0 Product VDO (Section 6.4.4.3.1.3) */
+static const struct vdo_field_desc pd3p0_product[] = {
+	VDO_FIELD("bcdDevice", 0, 0xffff),
+	VDO_FIELD("USB Product ID", 16, 0xffff),
+};
+
+/* USB PD 3.0 Passive Cable VDO (Section 6.4.4.3.1.6) */
+static const struct vdo_field_desc pd3p0_passive_cable[] = {
+	VDO_ENUM("USB Highest Speed", 0, 0x7, pd3p0_passive_cable_usb_highest_speed),
+	VDO_ENUM("Vbus Current Handling", 5, 0x3, pd2p0_passive_cable_vbus_current_handling),
+	VDO_ENUM("Maximum Vbus Voltage", 9, 0x3, pd3p0_passive_cable_maximum_vbus_voltage),
+	VDO_ENUM("Cable Termination Type", 11, 0x3, pd2p0_passive_cable_cable_termination_type),
+	VDO_ENUM("Cable Latency", 13, 0xf, pd2p0_passive_cable_cable_latency),
+	VDO_ENUM("Connector Type", 18, 0x3, pd3p0_passive_cable_connector_type),
+	VDO_ENUM("VDO version", 21, 0x7, pd3p0_passive_cable_vdo_version),
+	VDO_FIELD("Firmware Version", 24, 0xf),
+	VDO_FIELD("HW Version", 28, 0xf),
+};
+
+/* USB PD 3.0 Active Cable VDO1/VDO2 (Section 6.4.4.3.1.7) */
+static const struct vdo_field_desc pd3p0_active_cable_vdo1[] = {
+	VDO_ENUM("USB Highest Speed", 0, 0x7, pd3p0_passive_cable_usb_highest_speed),
+	VDO_ENUM("SOP'' Controller Present", 3, 0x1, vdo_enum_no_yes),
+	VDO_ENUM("Vbus Through Cable", 4, 0x1, vdo_enum_no_yes),
+	VDO_ENUM("Vbus Current Handling", 5, 0x3, pd3p0_active_cable_vdo1_vbus_current_handling),
+	VDO_ENUM("SBU Type", 7, 0x1, pd3p0_active_cable_vdo1_sbu_type),
+	VDO_ENUM("SBU Supported", 8, 0x1, pd3p0_active_cable_vdo1_sbu_supported),
+	VDO_ENUM("Maximum Vbus Voltage", 9, 0x3, pd3p0_passive_cable_maximum_vbus_voltage),
+	VDO_ENUM("Cable Termination Type", 11, 0x3, pd3p0_active_cable_vdo1_cable_termination_type),
+	VDO_ENUM("Cable Latency", 13, 0xf, pd3p0_active_cable_vdo1_cable_latency),
+	VDO_ENUM("Connector Type", 18, 0x3, pd3p0_passive_cable_connector_type),
+	VDO_ENUM("VDO version", 21, 0x7, pd3p0_active_cable_vdo1_vdo_version),
+	VDO_FIELD("Firmware Version", 24, 0xf),
+	VDO_FIELD("HW Version", 28, 0xf),
+};
+
+static const struct vdo_field_desc pd3p0_active_cable_vdo2[] = {
+	VDO_ENUM("USB Gen", 0, 0x1, vdo_enum_gen_1_gen_2_or_higher),
+	VDO_ENUM("Optically Isolated Active Cable", 2, 0x1, vdo_enum_no_yes),
+	VDO_ENUM("USB Lanes Supported", 3, 0x1, vdo_enum_one_lane_two_lanes),
+	VDO_ENUM("USB 3.2 Supported", 4, 0x1, pd3p0_active_cable_vdo2_usb_3_2_supported),
+	VDO_ENUM("USB 2.0 Supported", 5, 0x1, pd3p0_active_cable_vdo2_usb_2_0_supported),
+	VDO_FIELD("USB 2.0 Hub Hops Consumed", 6, 0x3),
+	VDO_ENUM("USB4 Supported", 8, 0x1, pd3p0_active_cable_vdo2_usb4_supported),
+	VDO_ENUM("Active element", 9, 0x1, pd3p0_active_cable_vdo2_active_element),
+	VDO_ENUM("Physical connection", 10, 0x1, vdo_enum_copper_optical),
+	VDO_ENUM("U3 to U0 transition mode", 11, 0x1, pd3p0_active_cable_vdo2_u3_to_u0_transition_mode),
+	VDO_ENUM("U3/Cld Power", 12, 0x7, pd3p0_active_cable_vdo2_u3_cld_power),
+	VDO_FIELD("Shutdown Temperature", 16, 0xff),
+	VDO_FIELD("Maximum Operating Temperature", 24, 0xff),
+};
+
+/* USB PD 3.0 AMA VDO (Section 6.4.4.3.1.8) */
+static const struct vdo_field_desc pd3p0_ama[] = {
+	VDO_ENUM("USB Highest Speed", 0, 0x7, pd3p0_ama_usb_highest_speed),
+	VDO_ENUM("Vbus required", 3, 0x1, vdo_enum_no_yes),
+	VDO_ENUM("Vconn required", 4, 0x1, vdo_enum_no_yes),
+	VDO_ENUM("Vconn power", 5, 0x7, pd2p0_ama_vconn_power),
+	VDO_ENUM("VDO Version", 21, 0x7, pd3p0_passive_cable_vdo_version),
+	VDO_FIELD("Firmware Version", 24, 0xf),
+	VDO_FIELD("HW Version", 28, 0xf),
+};
+
+/* USB PD 3.0 VPD VDO (Section 6.4.4.3.1.9) */
+static const struct vdo_field_desc pd3p0_vpd[] = {
+	VDO_ENUM("Charge Through Support", 0, 0x1, vdo_enum_no_yes),
+	VDO_FIELD("Ground Impedance", 1, 0x3f),
+	VDO_FIELD("Vbus Impedance", 7, 0x3f),
+	VDO_ENUM("Charge Through Current Support", 14, 0x1, vdo_enum_3a_capable_5a_capable),
+	VDO_ENUM("Maximum Vbus Voltage", 15, 0x3, pd3p0_passive_cable_maximum_vbus_voltage),
+	VDO_ENUM("VDO Version", 21, 0x7, pd3p0_passive_cable_vdo_version),
+	VDO_FIELD("Firmware Version", 24, 0xf),
+	VDO_FIELD("HW Version", 28, 0xf),
+};
+
+/* USB PD 3.0 UFP VDO1/VDO2 (Section 6.4.4.3.1.4) */
+static const struct vdo_field_desc pd3p0_ufp_vdo1[] = {
+	VDO_ENUM("USB Highest Speed", 0, 0x7, pd3p0_ufp_vdo1_usb_highest_speed),
+	VDO_FIELD("Alternate Modes", 3, 0x7),
+	VDO_FIELD("Device Capability", 24, 0xf),
+	VDO_ENUM("UFP VDO Version", 29, 0x7, pd3p0_passive_cable_vdo_version),
+};
+
+static const struct vdo_field_desc pd3p0_ufp_vdo2[] = {
+	VDO_FIELD("USB3 Max Power", 0, 0x7f),
+	VDO_FIELD("USB3 Min Power", 7, 0x7f),
+	VDO_FIELD("USB4 Max Power", 16, 0x7f),
+	VDO_FIELD("USB4 Min Power", 23, 0x7f),
+};
+
+/* USB PD 3.0 DFP VDO (Section 6.4.4.3.1.5) */
+static const struct vdo_field_desc pd3p0_dfp[] = {
+	VDO_FIELD("Port Number", 0, 0x1f),
+	VDO_FIELD("Host Capability", 24, 0x7),
+	VDO_ENUM("DFP VDO Version", 29, 0x7, pd3p0_passive_cable_vdo_version),
+};
+
+/* USB PD 3.0 Fixed Supply PDO - Source (Section 6.4.1.2.2) */
+static const struct vdo_field_desc pd3p0_fixed_supply_src[] = {
+	VDO_UNIT("Maximum Current in 10mA units", 0, 0x3ff, 10, "mA"),
+	VDO_UNIT("Voltage in 50mV units", 10, 0x3ff, 50, "mV"),
+	VDO_FIELD("Peak Current", 20, 0x3),
+	VDO_FIELD("Dual-Role Data", 25, 0x1),
+	VDO_FIELD("USB Communications Capable", 26, 0x1),
+	VDO_FIELD("Unconstrained Power", 27, 0x1),
+	VDO_FIELD("USB Suspend Supported", 28, 0x1),
+	VDO_FIELD("Daul-Role Power", 29, 0x1),
+	VDO_FIELD("Fixed supply", 30, 0x3),
+};
+
+/* USB PD 3.0 Variable Supply PDO - Source (Section 6.4.1.2.3) */
+static const struct vdo_field_desc pd3p0_variable_supply_src[] = {
+	VDO_UNIT("Maximum Current in 10mA units", 0, 0x3ff, 10, "mA"),
+	VDO_UNIT("Minimum Voltage in 50mV units", 10, 0x3ff, 50, "mV"),
+	VDO_UNIT("Maximum Voltage in 50mV units", 20, 0x3ff, 50, "mV"),
+	VDO_FIELD("Variable Supply", 30, 0x3),
+};
+
+/* USB PD 3.0 Battery Supply PDO - Source (Section 6.4.1.2.4) */
+static const struct vdo_field_desc pd3p0_battery_supply_src[] = {
+	VDO_UNIT("Maximum Allowable Power in 250mW units", 0, 0x3ff, 250, "mW"),
+	VDO_UNIT("Minimum Voltage in 50mV units", 10, 0x3ff, 50, "mV"),
+	VDO_UNIT("Maximum Voltage in 50mV units", 20, 0x3ff, 50, "mV"),
+	VDO_FIELD("Battery", 30, 0x3),
+};
+
+/* USB PD 3.0 PPS APDO - Source (Section 6.4.1.2.5) */
+static const struct vdo_field_desc pd3p0_pps_apdo_src[] = {
+	VDO_UNIT("Maximum Current in 50mA increments", 0, 0x7f, 50, "mA"),
+	VDO_UNIT("Minimum Voltage in 100mV increments", 8, 0xff, 100, "mV"),
+	VDO_UNIT("Maximum Voltage in 100mV increments", 17, 0xff, 100, "mV"),
+	VDO_FIELD("PPS Power Limited", 27, 0x1),
+	VDO_FIELD("Programable Power Supply", 28, 0x3),
+	VDO_FIELD("Augmented Power Data Object", 30, 0x3),
+};
+
+/* USB PD 3.0 Fixed Supply PDO - Sink (Section 6.4.1.3.1) */
+static const struct vdo_field_desc pd3p0_fixed_supply_snk[] = {
+	VDO_UNIT("Operational Current in 10mA units", 0, 0x3ff, 10, "mA"),
+	VDO_UNIT("Voltage in 50mV units", 10, 0x3ff, 50, "mV"),
+	VDO_ENUM("Fast Role Swap Required", 23, 0x3, pd3p0_fixed_supply_snk_fast_role_swap_required),
+	VDO_FIELD("Dual-Role Data", 25, 0x1),
+	VDO_FIELD("USB Communications Capable", 26, 0x1),
+	VDO_FIELD("Unconstrained Power", 27, 0x1),
+	VDO_FIELD("Higher Capability", 28, 0x1),
+	VDO_FIELD("Daul-Role Power", 29, 0x1),
+	VDO_FIELD("Fixed supply", 30, 0x3),
+};
+
+/* USB PD 3.0 Variable Supply PDO - Sink (Section 6.4.1.3.2) */
+static const struct vdo_field_desc pd3p0_variable_supply_snk[] = {
+	VDO_UNIT("Operational Current in 10mA units", 0, 0x3ff, 10, "mA"),
+	VDO_UNIT("Minimum Voltage in 50mV units", 10, 0x3ff, 50, "mV"),
+	VDO_UNIT("Maximum Voltage in 50mV units", 20, 0x3ff, 50, "mV"),
+	VDO_FIELD("Variable Supply", 30, 0x3),
+};
+
+/* USB PD 3.0 Battery Supply PDO - Sink (Section 6.4.1.3.3) */
+static const struct vdo_field_desc pd3p0_battery_supply_snk[] = {
+	VDO_UNIT("Operational Power in 250mW units", 0, 0x3ff, 250, "mW"),
+	VDO_UNIT("Minimum Voltage in 50mV units", 10, 0x3ff, 50, "mV"),
+	VDO_UNIT("Maximum Voltage in 50mV units", 20, 0x3ff, 50, "mV"),
+	VDO_FIELD("Battery", 30, 0x3),
+};
+
+/* USB PD 3.0 PPS APDO - Sink (Section 6.4.1.3.4) */
+static const struct vdo_field_desc pd3p0_pps_apdo_snk[] = {
+	VDO_UNIT("Maximum Current in 50mA increments", 0, 0x7f, 50, "mA"),
+	VDO_UNIT("Minimum Voltage in 100mV increments", 8, 0xff, 100, "mV"),
+	VDO_UNIT("Maximum Voltage in 100mV increments", 17, 0xff, 100, "mV"),
+	VDO_FIELD("Programable Power Supply", 28, 0x3),
+	VDO_FIELD("Augmented Power Data Object", 30, 0x3),
+};
+
+/* USB PD 3.1 ID Header VDO (Section 6.4.4.3.1.1) */
+static const struct vdo_field_desc pd3p1_partner_id_header[] = {
+	VDO_VID("USB Vendor ID", 0, 0xffff),
+	VDO_ENUM("Connector Type", 21, 0x3, pd3p1_partner_id_header_connector_type),
+	VDO_ENUM("Product Type (DFP)", 23, 0x7, pd3p0_partner_id_header_product_type_dfp),
+	VDO_ENUM("Modal Operation Supported", 26, 0x1, vdo_enum_no_yes),
+	VDO_ENUM("Product Type (UFP)", 27, 0x7, pd3p0_partner_id_header_product_type_ufp),
+	VDO_ENUM("USB Capable as a Device", 30, 0x1, vdo_enum_no_yes),
+	VDO_ENUM("USB Capable as a Host", 31, 0x1, vdo_enum_no_yes),
+};
+
+static const struct vdo_field_desc pd3p1_cable_id_header[] = {
+	VDO_VID("USB Vendor ID", 0, 0xffff),
+	VDO_ENUM("Connector Type", 21, 0x3, pd3p1_partner_id_header_connector_type),
+	VDO_ENUM("Modal Operation Supported", 26, 0x1, vdo_enum_no_yes),
+	VDO_ENUM("Product Type (Cable Plug)", 27, 0x7, pd2p0_cable_id_header_product_type_ufp),
+	VDO_ENUM("USB Capable as a Device", 30, 0x1, vdo_enum_no_yes),
+	VDO_ENUM("USB Capable as a Host", 31, 0x1, vdo_enum_no_yes),
+};
+
+/* USB PD 3.1 Cert Stat VDO (Section 6.4.4.3.1.2) */
+static const struct vdo_field_desc pd3p1_cert_stat[] = {
+	VDO_FIELD("XID", 0, 0xffffffff),
+};
+
+/* USB PD 3.1 Product VDO (Section 6.4.4.3.1.3) */
+static const struct vdo_field_desc pd3p1_product[] = {
+	VDO_FIELD("bcdDevice", 0, 0xffff),
+	VDO_FIELD("USB Product ID", 16, 0xffff),
+};
+
+/* USB PD 3.1 Passive Cable VDO (Section 6.4.4.3.1.6) */
+static const struct vdo_field_desc pd3p1_passive_cable[] = {
+	VDO_ENUM("USB Highest Speed", 0, 0x7, pd3p0_passive_cable_usb_highest_speed),
+	VDO_ENUM("Vbus Current Handling", 5, 0x3, pd2p0_passive_cable_vbus_current_handling),
+	VDO_ENUM("Maximum Vbus Voltage", 9, 0x3, pd3p1_passive_cable_maximum_vbus_voltage),
+	VDO_ENUM("Cable Termination Type", 11, 0x3, pd2p0_passive_cable_cable_termination_type),
+	VDO_ENUM("Cable Latency", 13, 0xf, pd2p0_passive_cable_cable_latency),
+	VDO_ENUM("EPR Mode Capable", 17, 0x1, vdo_enum_no_yes),
+	VDO_ENUM("Type-C Connector to", 18, 0x3, pd3p0_passive_cable_connector_type),
+	VDO_ENUM("VDO version", 21, 0x7, pd3p0_passive_cable_vdo_version),
+	VDO_FIELD("Firmware Version", 24, 0xf),
+	VDO_FIELD("HW Version", 28, 0xf),
+};
+
+/* USB PD 3.1 Active Cable VDO1/VDO2 (Section 6.4.4.3.1.7) */
+static const struct vdo_field_desc pd3p1_active_cable_vdo1[] = {
+	VDO_ENUM("USB Highest Speed", 0, 0x7, pd3p0_passive_cable_usb_highest_speed),
+	VDO_ENUM("SOP'' Controller Present", 3, 0x1, vdo_enum_no_yes),
+	VDO_ENUM("Vbus Through Cable", 4, 0x1, vdo_enum_no_yes),
+	VDO_ENUM("Vbus Current Handling", 5, 0x3, pd3p0_active_cable_vdo1_vbus_current_handling),
+	VDO_ENUM("SBU Type", 7, 0x1, pd3p0_active_cable_vdo1_sbu_type),
+	VDO_ENUM("SBU Supported", 8, 0x1, pd3p0_active_cable_vdo1_sbu_supported),
+	VDO_ENUM("Maximum Vbus Voltage", 9, 0x3, pd3p0_passive_cable_maximum_vbus_voltage),
+	VDO_ENUM("Cable Termination Type", 11, 0x3, pd3p0_active_cable_vdo1_cable_termination_type),
+	VDO_ENUM("Cable Latency", 13, 0xf, pd3p0_active_cable_vdo1_cable_latency),
+	VDO_ENUM("EPR Mode Capable", 17, 0x1, vdo_enum_no_yes),
+	VDO_ENUM("USB Type-C to", 18, 0x3, pd3p0_passive_cable_connector_type),
+	VDO_ENUM("VDO version", 21, 0x7, pd3p0_active_cable_vdo1_vdo_version),
+	VDO_FIELD("Firmware Version", 24, 0xf),
+	VDO_FIELD("HW Version", 28, 0xf),
+};
+
+static const struct vdo_field_desc pd3p1_active_cable_vdo2[] = {
+	VDO_ENUM("USB Gen", 0, 0x1, vdo_enum_gen_1_gen_2_or_higher),
+	VDO_ENUM("Optically Isolated Active Cable", 2, 0x1, vdo_enum_no_yes),
+	VDO_ENUM("USB Lanes Supported", 3, 0x1, vdo_enum_one_lane_two_lanes),
+	VDO_ENUM("USB 3.2 Supported", 4, 0x1, pd3p0_active_cable_vdo2_usb_3_2_supported),
+	VDO_ENUM("USB 2.0 Supported", 5, 0x1, pd3p0_active_cable_vdo2_usb_2_0_supported),
+	VDO_FIELD("USB 2.0 Hub Hops Consumed", 6, 0x3),
+	VDO_ENUM("USB4 Supported", 8, 0x1, pd3p0_active_cable_vdo2_usb4_supported),
+	VDO_ENUM("Active element", 9, 0x1, pd3p0_active_cable_vdo2_active_element),
+	VDO_ENUM("Physical connection", 10, 0x1, vdo_enum_copper_optical),
+	VDO_ENUM("U3 to U0 transition mode", 11, 0x1, pd3p0_active_cable_vdo2_u3_to_u0_transition_mode),
+	VDO_ENUM("U3/Cld Power", 12, 0x7, pd3p0_active_cable_vdo2_u3_cld_power),
+	VDO_FIELD("Shutdown Temperature", 16, 0xff),
+	VDO_FIELD("Maximum Operating Temperature", 24, 0xff),
+};
+
+/* USB PD 3.0 VPD VDO (Section 6.4.4.3.1.9) */
+static const struct vdo_field_desc pd3p1_vpd[] = {
+	VDO_ENUM("Charge Through Support", 0, 0x1, vdo_enum_no_yes),
+	VDO_FIELD("Ground Impedance", 1, 0x3f),
+	VDO_FIELD("Vbus Impedance", 7, 0x3f),
+	VDO_ENUM("Charge Through Current Support", 14, 0x1, vdo_enum_3a_capable_5a_capable),
+	VDO_ENUM("Maximum Vbus Voltage", 15, 0x3, pd3p1_vpd_maximum_vbus_voltage),
+	VDO_ENUM("VDO Version", 21, 0x7, pd3p0_passive_cable_vdo_version),
+	VDO_FIELD("Firmware Version", 24, 0xf),
+	VDO_FIELD("HW Version", 28, 0xf),
+};
+
+/* USB PD 3.1 UFP VDO (Section 6.4.4.3.1.4) */
+static const struct vdo_field_desc pd3p1_ufp[] = {
+	VDO_ENUM("USB Highest Speed", 0, 0x7, pd3p0_ufp_vdo1_usb_highest_speed),
+	VDO_FIELD("Alternate Modes", 3, 0x7),
+	VDO_ENUM("Vbus Required", 6, 0x1, vdo_enum_yes_no),
+	VDO_ENUM("Vconn Required", 7, 0x1, vdo_enum_no_yes),
+	VDO_ENUM("Vconn Power", 8, 0x7, pd2p0_ama_vconn_power),
+	VDO_FIELD("Connector Type", 22, 0x3),
+	VDO_FIELD("Device Capability", 24, 0xf),
+	VDO_ENUM("UFP VDO Version", 29, 0x7, pd3p0_active_cable_vdo1_vdo_version),
+};
+
+/* USB PD 3.1 DFP VDO (Section 6.4.4.3.1.5) */
+static const struct vdo_field_desc pd3p1_dfp[] = {
+	VDO_FIELD("Port Number", 0, 0x1f),
+	VDO_FIELD("Connector Type", 22, 0x3),
+	VDO_FIELD("Host Capability", 24, 0x7),
+	VDO_ENUM("DFP VDO Version", 29, 0x7, pd3p0_passive_cable_vdo_version),
+};
+
+/* USB PD 3.1 Fixed Supply PDO - Source (Section 6.4.1.2.2) */
+static const struct vdo_field_desc pd3p1_fixed_supply_src[] = {
+	VDO_UNIT("Maximum Current in 10mA units", 0, 0x3ff, 10, "mA"),
+	VDO_UNIT("Voltage in 50mV units", 10, 0x3ff, 50, "mV"),
+	VDO_FIELD("Peak Current", 20, 0x3),
+	VDO_FIELD("EPR Mode Capable", 23, 0x1),
+	VDO_FIELD("Dual-Role Data", 25, 0x1),
+	VDO_FIELD("USB Communications Capable", 26, 0x1),
+	VDO_FIELD("Unconstrained Power", 27, 0x1),
+	VDO_FIELD("USB Suspend Supported", 28, 0x1),
+	VDO_FIELD("Daul-Role Power", 29, 0x1),
+	VDO_FIELD("Fixed supply", 30, 0x3),
+};
+
+/* USB PD 3.1 Variable Supply PDO - Source (Section 6.4.1.2.3) */
+static const struct vdo_field_desc pd3p1_variable_supply_src[] = {
+	VDO_UNIT("Maximum Current in 10mA units", 0, 0x3ff, 10, "mA"),
+	VDO_UNIT("Minimum Voltage in 50mV units", 10, 0x3ff, 50, "mV"),
+	VDO_UNIT("Maximum Voltage in 50mV units", 20, 0x3ff, 50, "mV"),
+	VDO_FIELD("Variable Supply", 30, 0x3),
+};
+
+/* USB PD 3.1 Battery Supply PDO - Source (Section 6.4.1.2.4) */
+static const struct vdo_field_desc pd3p1_battery_supply_src[] = {
+	VDO_UNIT("Maximum Allowable Power in 250mW units", 0, 0x3ff, 250, "mW"),
+	VDO_UNIT("Minimum Voltage in 50mV units", 10, 0x3ff, 50, "mV"),
+	VDO_UNIT("Maximum Voltage in 50mV units", 20, 0x3ff, 50, "mV"),
+	VDO_FIELD("Battery", 30, 0x3),
+};
+
+/* USB PD 3.1 PPS APDO - Source (Section 6.4.1.2.5) */
+static const struct vdo_field_desc pd3p1_pps_apdo_src[] = {
+	VDO_UNIT("Maximum Current in 50mA increments", 0, 0x7f, 50, "mA"),
+	VDO_UNIT("Minimum Voltage in 100mV increments", 8, 0xff, 100, "mV"),
+	VDO_UNIT("Maximum Voltage in 100mV increments", 17, 0xff, 100, "mV"),
+	VDO_FIELD("PPS Power Limited", 27, 0x1),
+	VDO_FIELD("SPR PPS", 28, 0x3),
+	VDO_FIELD("Augmented Power Data Object", 30, 0x3),
+};
+
+/* USB PD 3.1 Fixed Supply PDO - Sink (Section 6.4.1.3.1) */
+static const struct vdo_field_desc pd3p1_fixed_supply_snk[] = {
+	VDO_UNIT("Operational Current in 10mA units", 0, 0x3ff, 10, "mA"),
+	VDO_UNIT("Voltage in 50mV units", 10, 0x3ff, 50, "mV"),
+	VDO_ENUM("Fast Role Swap Required", 23, 0x3, pd3p0_fixed_supply_snk_fast_role_swap_required),
+	VDO_FIELD("Dual-Role Data", 25, 0x1),
+	VDO_FIELD("USB Communications Capable", 26, 0x1),
+	VDO_FIELD("Unconstrained Power", 27, 0x1),
+	VDO_FIELD("Higher Capability", 28, 0x1),
+	VDO_FIELD("Daul-Role Power", 29, 0x1),
+	VDO_FIELD("Fixed supply", 30, 0x3),
+};
+
+/* USB PD 3.1 Variable Supply PDO - Sink (Section 6.4.1.3.2) */
+static const struct vdo_field_desc pd3p1_variable_supply_snk[] = {
+	VDO_UNIT("Operational Current in 10mA units", 0, 0x3ff, 10, "mA"),
+	VDO_UNIT("Minimum Voltage in 50mV units", 10, 0x3ff, 50, "mV"),
+	VDO_UNIT("Maximum Voltage in 50mV units", 20, 0x3ff, 50, "mV"),
+	VDO_FIELD("Variable Supply", 30, 0x3),
+};
+
+/* USB PD 3.1 Battery Supply PDO - Sink (Section 6.4.1.3.3) */
+static const struct vdo_field_desc pd3p1_battery_supply_snk[] = {
+	VDO_UNIT("Operational Power in 250mW units", 0, 0x3ff, 250, "mW"),
+	VDO_UNIT("Minimum Voltage in 50mV units", 10, 0x3ff, 50, "mV"),
+	VDO_UNIT("Maximum Voltage in 50mV units", 20, 0x3ff, 50, "mV"),
+	VDO_FIELD("Battery", 30, 0x3),
+};
+
+/* USB PD 3.1 PPS APDO - Sink (Section 6.4.1.3.4) */
+static const struct vdo_field_desc pd3p1_pps_apdo_snk[] = {
+	VDO_UNIT("Maximum Current in 50mA increments", 0, 0x7f, 50, "mA"),
+	VDO_UNIT("Minimum Voltage in 100mV increments", 8, 0xff, 100, "mV"),
+	VDO_UNIT("Maximum Voltage in 100mV increments", 17, 0xff, 100, "mV"),
+	VDO_FIELD("SPR PPS", 28, 0x3),
+	VDO_FIELD("Augmented Power Data Object", 30, 0x3),
+};
+
+/* Alternate mode VDOs */
+static const struct vdo_field_desc dp_alt_mode_partner[] = {
+	VDO_ENUM("Port Capability", 0, 0x3, dp_alt_mode_partner_port_capability),
+	VDO_FIELD("Signaling for Transport of DisplaPort Protocol", 2, 0xf),
+	VDO_ENUM("Receptacle Indication", 6, 0x1, dp_alt_mode_partner_receptacle_indication),
+	VDO_ENUM("USB 2.0 Signaling Not Used", 7, 0x1, dp_alt_mode_partner_usb_2_0_signaling_not_used),
+	VDO_FIELD("DP Source Device Pin Supported", 8, 0xff),
+	VDO_FIELD("DP Sink Device Pin Supported", 16, 0xff),
+};
+
+static const struct vdo_field_desc dp_alt_mode_active_cable[] = {
+	VDO_FIELD("Signaling for Transport of DisplaPort Protocol", 2, 0xf),
+	VDO_FIELD("DP Source Device Pin Assignments Supported", 8, 0xff),
+	VDO_FIELD("DP Sink Device Pin Assignments Supported", 16, 0xff),
+};
+
+static const struct vdo_field_desc tbt3_sop[] = {
+	VDO_FIELD("TBT Alternate Mode", 0, 0xffff),
+	VDO_ENUM("TBT Adapter", 16, 0x1, tbt3_sop_tbt_adapter),
+	VDO_FIELD("Reserved", 17, 0x1ff),
+	VDO_ENUM("Intel Specific B0", 26, 0x1, vdo_enum_not_supported_supported),
+	VDO_FIELD("Reserved", 27, 0x7),
+	VDO_ENUM("Vendor Specific B0", 30, 0x1, vdo_enum_not_supported_supported),
+	VDO_ENUM("Vendor Specific B1", 31, 0x1, vdo_enum_not_supported_supported),
+};
+
+static const struct vdo_field_desc tbt3_sop_pr[] = {
+	VDO_FIELD("TBT Alternate Mode", 0, 0xffff),
+	VDO_ENUM("Cable Speed", 16, 0x7, tbt3_sop_pr_cable_speed),
+	VDO_ENUM("TBT Rounded Support", 19, 0x3, tbt3_sop_pr_tbt_rounded_support),
+	VDO_ENUM("Cable Type", 21, 0x1, vdo_enum_non_optical_optical),
+	VDO_ENUM("Re-timer", 22, 0x1, vdo_enum_not_re_timer_re_timer),
+	VDO_ENUM("Active Cable Plug Link Training", 23, 0x1, tbt3_sop_pr_active_cable_plug_link_training),
+	VDO_ENUM("Active_Passive", 25, 0x1, tbt3_sop_pr_active_passive),
+};
+
+#define VDO_LAYOUT(t) { t, sizeof(t) / sizeof(t[0]) }
+
+static const struct vdo_layout {
+	const struct vdo_field_desc *fields;
+	unsigned int num;
+} vdo_layouts[LIBTYPEC_VDO_LAYOUT_COUNT] = {
+	[LIBTYPEC_VDO_PD2P0_PARTNER_ID_HEADER] = VDO_LAYOUT(pd2p0_partner_id_header),
+	[LIBTYPEC_VDO_PD2P0_CABLE_ID_HEADER] = VDO_LAYOUT(pd2p0_cable_id_header),
+	[LIBTYPEC_VDO_PD2P0_CERT_STAT] = VDO_LAYOUT(pd2p0_cert_stat),
+	[LIBTYPEC_VDO_PD2P0_PRODUCT] = VDO_LAYOUT(pd2p0_product),
+	[LIBTYPEC_VDO_PD2P0_PASSIVE_CABLE] = VDO_LAYOUT(pd2p0_passive_cable),
+	[LIBTYPEC_VDO_PD2P0_ACTIVE_CABLE] = VDO_LAYOUT(pd2p0_active_cable),
+	[LIBTYPEC_VDO_PD2P0_AMA] = VDO_LAYOUT(pd2p0_ama),
+	[LIBTYPEC_VDO_PD2P0_FIXED_SUPPLY_SRC] = VDO_LAYOUT(pd2p0_fixed_supply_src),
+	[LIBTYPEC_VDO_PD2P0_VARIABLE_SUPPLY_SRC] = VDO_LAYOUT(pd2p0_variable_supply_src),
+	[LIBTYPEC_VDO_PD2P0_BATTERY_SUPPLY_SRC] = VDO_LAYOUT(pd2p0_battery_supply_src),
+	[LIBTYPEC_VDO_PD2P0_FIXED_SUPPLY_SNK] = VDO_LAYOUT(pd2p0_fixed_supply_snk),
+	[LIBTYPEC_VDO_PD2P0_VARIABLE_SUPPLY_SNK] = VDO_LAYOUT(pd2p0_variable_supply_snk),
+	[LIBTYPEC_VDO_PD2P0_BATTERY_SUPPLY_SNK] = VDO_LAYOUT(pd2p0_battery_supply_snk),
+	[LIBTYPEC_VDO_PD3P0_PARTNER_ID_HEADER] = VDO_LAYOUT(pd3p0_partner_id_header),
+	[LIBTYPEC_VDO_PD3P0_CABLE_ID_HEADER] = VDO_LAYOUT(pd3p0_cable_id_header),
+	[LIBTYPEC_VDO_PD3P0_CERT_STAT] = VDO_LAYOUT(pd3p0_cert_stat),
+	[LIBTYPEC_VDO_PD3P0_PRODUCT] = VDO_LAYOUT(pd3p0_product),
+	[LIBTYPEC_VDO_PD3P0_PASSIVE_CABLE] = VDO_LAYOUT(pd3p0_passive_cable),
+	[LIBTYPEC_VDO_PD3P0_ACTIVE_CABLE_VDO1] = VDO_LAYOUT(pd3p0_active_cable_vdo1),
+	[LIBTYPEC_VDO_PD3P0_ACTIVE_CABLE_VDO2] = VDO_LAYOUT(pd3p0_active_cable_vdo2),
+	[LIBTYPEC_VDO_PD3P0_AMA] = VDO_LAYOUT(pd3p0_ama),
+	[LIBTYPEC_VDO_PD3P0_VPD] = VDO_LAYOUT(pd3p0_vpd),
+	[LIBTYPEC_VDO_PD3P0_UFP_VDO1] = VDO_LAYOUT(pd3p0_ufp_vdo1),
+	[LIBTYPEC_VDO_PD3P0_UFP_VDO2] = VDO_LAYOUT(pd3p0_ufp_vdo2),
+	[LIBTYPEC_VDO_PD3P0_DFP] = VDO_LAYOUT(pd3p0_dfp),
+	[LIBTYPEC_VDO_PD3P0_FIXED_SUPPLY_SRC] = VDO_LAYOUT(pd3p0_fixed_supply_src),
+	[LIBTYPEC_VDO_PD3P0_VARIABLE_SUPPLY_SRC] = VDO_LAYOUT(pd3p0_variable_supply_src),
+	[LIBTYPEC_VDO_PD3P0_BATTERY_SUPPLY_SRC] = VDO_LAYOUT(pd3p0_battery_supply_src),
+	[LIBTYPEC_VDO_PD3P0_PPS_APDO_SRC] = VDO_LAYOUT(pd3p0_pps_apdo_src),
+	[LIBTYPEC_VDO_PD3P0_FIXED_SUPPLY_SNK] = VDO_LAYOUT(pd3p0_fixed_supply_snk),
+	[LIBTYPEC_VDO_PD3P0_VARIABLE_SUPPLY_SNK] = VDO_LAYOUT(pd3p0_variable_supply_snk),
+	[LIBTYPEC_VDO_PD3P0_BATTERY_SUPPLY_SNK] = VDO_LAYOUT(pd3p0_battery_supply_snk),
+	[LIBTYPEC_VDO_PD3P0_PPS_APDO_SNK] = VDO_LAYOUT(pd3p0_pps_apdo_snk),
+	[LIBTYPEC_VDO_PD3P1_PARTNER_ID_HEADER] = VDO_LAYOUT(pd3p1_partner_id_header),
+	[LIBTYPEC_VDO_PD3P1_CABLE_ID_HEADER] = VDO_LAYOUT(pd3p1_cable_id_header),
+	[LIBTYPEC_VDO_PD3P1_CERT_STAT] = VDO_LAYOUT(pd3p1_cert_stat),
+	[LIBTYPEC_VDO_PD3P1_PRODUCT] = VDO_LAYOUT(pd3p1_product),
+	[LIBTYPEC_VDO_PD3P1_PASSIVE_CABLE] = VDO_LAYOUT(pd3p1_passive_cable),
+	[LIBTYPEC_VDO_PD3P1_ACTIVE_CABLE_VDO1] = VDO_LAYOUT(pd3p1_active_cable_vdo1),
+	[LIBTYPEC_VDO_PD3P1_ACTIVE_CABLE_VDO2] = VDO_LAYOUT(pd3p1_active_cable_vdo2),
+	[LIBTYPEC_VDO_PD3P1_VPD] = VDO_LAYOUT(pd3p1_vpd),
+	[LIBTYPEC_VDO_PD3P1_UFP] = VDO_LAYOUT(pd3p1_ufp),
+	[LIBTYPEC_VDO_PD3P1_DFP] = VDO_LAYOUT(pd3p1_dfp),
+	[LIBTYPEC_VDO_PD3P1_FIXED_SUPPLY_SRC] = VDO_LAYOUT(pd3p1_fixed_supply_src),
+	[LIBTYPEC_VDO_PD3P1_VARIABLE_SUPPLY_SRC] = VDO_LAYOUT(pd3p1_variable_supply_src),
+	[LIBTYPEC_VDO_PD3P1_BATTERY_SUPPLY_SRC] = VDO_LAYOUT(pd3p1_battery_supply_src),
+	[LIBTYPEC_VDO_PD3P1_PPS_APDO_SRC] = VDO_LAYOUT(pd3p1_pps_apdo_src),
+	[LIBTYPEC_VDO_PD3P1_FIXED_SUPPLY_SNK] = VDO_LAYOUT(pd3p1_fixed_supply_snk),
+	[LIBTYPEC_VDO_PD3P1_VARIABLE_SUPPLY_SNK] = VDO_LAYOUT(pd3p1_variable_supply_snk),
+	[LIBTYPEC_VDO_PD3P1_BATTERY_SUPPLY_SNK] = VDO_LAYOUT(pd3p1_battery_supply_snk),
+	[LIBTYPEC_VDO_PD3P1_PPS_APDO_SNK] = VDO_LAYOUT(pd3p1_pps_apdo_snk),
+	[LIBTYPEC_VDO_DP_ALT_MODE_PARTNER] = VDO_LAYOUT(dp_alt_mode_partner),
+	[LIBTYPEC_VDO_DP_ALT_MODE_ACTIVE_CABLE] = VDO_LAYOUT(dp_alt_mode_active_cable),
+	[LIBTYPEC_VDO_TBT3_SOP] = VDO_LAYOUT(tbt3_sop),
+	[LIBTYPEC_VDO_TBT3_SOP_PR] = VDO_LAYOUT(tbt3_sop_pr),
+};
+
+#endif /*LIBTYPEC_VDO_TABLES_H*/
@@ -27,15 +27,21 @@
 #include <string.h>
 #include <getopt.h>
 #include <ctype.h>
+#include <errno.h>
+#include <stdarg.h>
+#include <time.h>
 
 #include "../libtypec.h"
 #include "lstypec.h"
 #include "names.h"
 #include "../libtypec_config.h"
 
-struct altmode_data am_data[64];
 char *session_info[LIBTYPEC_SESSION_MAX_INDEX];
 
+/* One buffer per scan; PDO and alternate mode lists are views into it */
+static unsigned char scan_buf[16384];
+static struct libtypec_arena scan_arena;
+
 typedef struct {
     int verbose;
     int help;
@@ -45,6 +51,9 @@ typedef struct {
     int cb_num;
     int am;
     int backend; // 0 for sysfs, 1 for debugfs
+    int json;
+    int binary;
+    int watch;
 } CmdArgs;
 
 CmdArgs lstypec_args;
@@ -58,6 +67,9 @@ struct option long_options[] = {
     {"cb", required_argument, NULL, 'c'},
     {"am", no_argument, &lstypec_args.am, 1},
     {"backend", required_argument, NULL, 'b'},
+    {"json", no_argument, &lstypec_args.json, 1},
+    {"binary", no_argument, &lstypec_args.binary, 1},
+    {"watch", no_argument, &lstypec_args.watch, 1},
     {0, 0, 0, 0}
 };
 
@@ -70,6 +82,9 @@ void print_usage() {
     printf("-cb [num] print cable details from the particular port\n");
     printf("-am print alternate mode details of port/partner/cable\n");
     printf("-backend [string] where string is debugfs or sysfs sets, convert it to int. backend to be used by libtypec\n");
+    printf("--json print all details as one JSON document\n");
+    printf("--binary write all details as a binary snapshot (see libtypec_snapshot_next())\n");
+    printf("--watch print all details as JSON, then one JSON line per change until interrupted\n");
 }
 
 void parse_args(int argc, char *argv[]) {
@@ -82,6 +97,9 @@ void parse_args(int argc, char *argv[]) {
     lstypec_args.cb_num = -1; // -1 indicates no cable number specified
     lstypec_args.am = -1; // -1 indicates no alternate mode number specified
     lstypec_args.backend = 0; // default backend is sysfs
+    lstypec_args.json = 0;
+    lstypec_args.binary = 0;
+    lstypec_args.watch = 0;
 
   for (int i = 1; i < argc; i++) {
         if (strcmp(argv[i], "-v") == 0) {
@@ -122,6 +140,12 @@ void parse_args(int argc, char *argv[]) {
             } else if (strcmp(argv[i], "sysfs") == 0) {
                 lstypec_args.backend = LIBTYPEC_BACKEND_SYSFS;
             }
+        } else if (strcmp(argv[i], "--json") == 0) {
+            lstypec_args.json = 1;
+        } else if (strcmp(argv[i], "--binary") == 0) {
+            lstypec_args.binary = 1;
+        } else if (strcmp(argv[i], "--watch") == 0) {
+            lstypec_args.watch = 1;
         } else {
             printf("Error: Unknown argument %s\n", argv[i]);
             exit(EXIT_FAILURE);
@@ -238,33 +262,28 @@ enum product_type get_partner_product_type(short rev, uint32_t id)
   return product_type_other;
 }
 
-void print_vdo(uint32_t vdo, int num_fields, const struct vdo_field vdo_fields[], const char *vdo_field_desc[][MAX_FIELDS])
+void print_vdo(uint32_t vdo, enum libtypec_vdo_layout layout)
 {
+  struct libtypec_vdo_field field[LIBTYPEC_VDO_MAX_FIELDS];
+  int num_fields = libtypec_decode_vdo(layout, vdo, field, LIBTYPEC_VDO_MAX_FIELDS);
+
   for (int i = 0; i < num_fields; i++) {
-    if (!vdo_fields[i].print)
-      continue;
-      uint32_t field = (vdo >> vdo_fields[i].index) & vdo_fields[i].mask;
-      printf("      %s: %*d", vdo_fields[i].name, FIELD_WIDTH(MAX_FIELD_LENGTH - ((int) strlen(vdo_fields[i].name))), ((vdo >> vdo_fields[i].index) & vdo_fields[i].mask));
-      if (vdo_field_desc[i][0] != NULL) {
-        // decode field
-        printf(" (%s)\n", vdo_field_desc[i][field]);
-      } else if (strcmp(vdo_fields[i].name, "USB Vendor ID")  == 0) {
-        // decode vendor id
-         char vendor_str[128];
-         uint16_t svid = ((vdo >> vdo_fields[i].index) & vdo_fields[i].mask);
-         get_vendor_string(vendor_str, sizeof(vendor_str), svid);
-        printf(" (%s)\n", (vendor_str[0] == '\0' ? "unknown" : vendor_str));
-      } else {
-	        int unit_step;
-        char unit_name[4];
-        if (sscanf(vdo_fields[i].name, "%*[^0-9]%d%3s units", &unit_step, unit_name) == 2) {
-          // decode unit
-          printf(" (%d%s)\n", field * unit_step, unit_name);
-        } else {
-          // No decoding
-          printf("\n");
-        }
-      }
+    printf("      %s: %*d", field[i].name, FIELD_WIDTH(MAX_FIELD_LENGTH - field[i].name_len), field[i].raw);
+    if (field[i].desc) {
+      // decode field
+      printf(" (%s)\n", field[i].desc);
+    } else if (field[i].flags & LIBTYPEC_VDO_FIELD_VID) {
+      // decode vendor id
+      char vendor_str[128];
+      get_vendor_string(vendor_str, sizeof(vendor_str), field[i].raw);
+      printf(" (%s)\n", (vendor_str[0] == '\0' ? "unknown" : vendor_str));
+    } else if (field[i].unit) {
+      // decode unit
+      printf(" (%u%s)\n", field[i].value, field[i].unit);
+    } else {
+      // No decoding
+      printf("\n");
+    }
   }
 }
 
@@ -320,7 +339,7 @@ void print_cable_prop(struct libtypec_cable_property cable_prop, int conn_num)
     printf("    Cable Plug Type: %s\n", cable_plug_type[cable_prop.plug_end_type]);
 }
 
-void get_svid_string(uint32_t svid, char* str) {
+void get_svid_string(uint32_t svid, char* str, size_t size) {
 
     switch (svid) {
         case 0xFF01:
@@ -330,28 +349,28 @@ void get_svid_string(uint32_t svid, char* str) {
             strcpy(str, "TBT Alternate Mode");
             break;
         default:
-            get_vendor_string(str, sizeof(str), svid);
+            get_vendor_string(str, size, svid);
             break;
     }
 }
 
-void print_alternate_mode_data(int recipient, uint32_t id_header, int num_modes, struct altmode_data *am_data)
+void print_alternate_mode_data(int recipient, uint32_t id_header, int num_modes, const struct altmode_data *am_data)
 {
   char vendor_id[128];
 
   if (recipient == AM_CONNECTOR) {
     for (int i = 0; i < num_modes; i++) {
-      get_svid_string(am_data[i].svid,vendor_id);
+      get_svid_string(am_data[i].svid, vendor_id, sizeof(vendor_id));
       printf("  Local Mode %d:\n", i);
       printf("    SVID: 0x%04x (%s)\n", am_data[i].svid,vendor_id);
       printf("    VDO: 0x%08x\n", am_data[i].vdo);
       if (lstypec_args.verbose) {
         switch(am_data[i].svid){
         case 0x8087:
-          print_vdo(am_data[i].vdo, 7, tbt3_sop_fields, tbt3_sop_field_desc);
+          print_vdo(am_data[i].vdo, LIBTYPEC_VDO_TBT3_SOP);
           break;
         case 0xff01:
-          print_vdo(am_data[i].vdo, 7, dp_alt_mode_partner_fields, dp_alt_mode_partner_field_desc);
+          print_vdo(am_data[i].vdo, LIBTYPEC_VDO_DP_ALT_MODE_PARTNER);
           break;
         default:
           get_vendor_string(vendor_id, sizeof(vendor_id), am_data[i].svid);
@@ -364,17 +383,17 @@ void print_alternate_mode_data(int recipient, uint32_t id_header, int num_modes,
 
   if (recipient == AM_SOP) {
     for (int i = 0; i < num_modes; i++) {
-      get_svid_string(am_data[i].svid,vendor_id);
+      get_svid_string(am_data[i].svid, vendor_id, sizeof(vendor_id));
       printf("  Partner Mode %d:\n", i);
       printf("    SVID: 0x%04x (%s)\n", am_data[i].svid,vendor_id);
       printf("    VDO: 0x%08x\n", am_data[i].vdo);
       if (lstypec_args.verbose) {
         switch(am_data[i].svid){
         case 0x8087:
-          print_vdo(am_data[i].vdo, 7, tbt3_sop_fields, tbt3_sop_field_desc);
+          print_vdo(am_data[i].vdo, LIBTYPEC_VDO_TBT3_SOP);
           break;
         case 0xff01:
-          print_vdo(am_data[i].vdo, 7, dp_alt_mode_partner_fields, dp_alt_mode_partner_field_desc);
+          print_vdo(am_data[i].vdo, LIBTYPEC_VDO_DP_ALT_MODE_PARTNER);
           break;
         default:
           get_vendor_string(vendor_id, sizeof(vendor_id), am_data[i].svid);
@@ -387,7 +406,7 @@ void print_alternate_mode_data(int recipient, uint32_t id_header, int num_modes,
 
   if (recipient == AM_SOP_PR) {
     for (int i = 0; i < num_modes; i++) {
-      get_svid_string(am_data[i].svid,vendor_id);
+      get_svid_string(am_data[i].svid, vendor_id, sizeof(vendor_id));
       printf("  Cable Plug Modes %d:\n", i);
       printf("    SVID: 0x%04x (%s)\n", am_data[i].svid,vendor_id);
       printf("    VDO: 0x%08x\n", am_data[i].vdo);
@@ -395,11 +414,11 @@ void print_alternate_mode_data(int recipient, uint32_t id_header, int num_modes,
       if (lstypec_args.verbose) {
         switch(am_data[i].svid){
         case 0x8087:
-          print_vdo(am_data[i].vdo, 7, tbt3_sop_pr_fields, tbt3_sop_pr_field_desc);
+          print_vdo(am_data[i].vdo, LIBTYPEC_VDO_TBT3_SOP_PR);
           break;
         case 0xff01:
           if ((id_header & ACTIVE_CABLE_MASK) == ACTIVE_CABLE_COMP) {
-            print_vdo(am_data[i].vdo, 7, dp_alt_mode_active_cable_fields, dp_alt_mode_active_cable_field_desc);
+            print_vdo(am_data[i].vdo, LIBTYPEC_VDO_DP_ALT_MODE_ACTIVE_CABLE);
           } else {
             get_vendor_string(vendor_id, sizeof(vendor_id), am_data[i].svid);
             printf("      SVID Decoding not supported for 0x%04x (%s)\n", am_data[i].svid, (vendor_id[0] == '\0' ? "unknown" : vendor_id));
@@ -430,27 +449,27 @@ void print_identity_data(int recipient, union libtypec_discovered_identity id, s
       {
         case 0x200:
           printf("    ID Header: 0x%08x\n", id.disc_id.id_header);
-          print_vdo(((uint32_t) id.disc_id.id_header), 6, pd2p0_partner_id_header_fields, pd2p0_partner_id_header_field_desc);
+          print_vdo(((uint32_t) id.disc_id.id_header), LIBTYPEC_VDO_PD2P0_PARTNER_ID_HEADER);
           printf("    Cert Stat: 0x%08x\n", id.disc_id.cert_stat);
-          print_vdo(((uint32_t) id.disc_id.cert_stat), 1, pd2p0_cert_stat_fields, pd2p0_cert_stat_field_desc);
+          print_vdo(((uint32_t) id.disc_id.cert_stat), LIBTYPEC_VDO_PD2P0_CERT_STAT);
           printf("    Product: 0x%08x\n", id.disc_id.product);
-          print_vdo(((uint32_t) id.disc_id.product), 2, pd2p0_product_fields, pd2p0_product_field_desc);
+          print_vdo(((uint32_t) id.disc_id.product), LIBTYPEC_VDO_PD2P0_PRODUCT);
           break;
         case 0x300:
           printf("    ID Header: 0x%08x\n", id.disc_id.id_header);
-          print_vdo(((uint32_t) id.disc_id.id_header), 7, pd3p0_partner_id_header_fields, pd3p0_partner_id_header_field_desc);
+          print_vdo(((uint32_t) id.disc_id.id_header), LIBTYPEC_VDO_PD3P0_PARTNER_ID_HEADER);
           printf("    Cert Stat: 0x%08x\n", id.disc_id.cert_stat);
-          print_vdo(((uint32_t) id.disc_id.cert_stat), 1, pd3p0_cert_stat_fields, pd3p0_cert_stat_field_desc);
+          print_vdo(((uint32_t) id.disc_id.cert_stat), LIBTYPEC_VDO_PD3P0_CERT_STAT);
           printf("    Product: 0x%08x\n", id.disc_id.product);
-          print_vdo(((uint32_t) id.disc_id.product), 2, pd3p0_product_fields, pd3p0_product_field_desc);
+          print_vdo(((uint32_t) id.disc_id.product), LIBTYPEC_VDO_PD3P0_PRODUCT);
           break;
         case 0x310:
           printf("    ID Header: 0x%08x\n", id.disc_id.id_header);
-          print_vdo(((uint32_t) id.disc_id.id_header), 8, pd3p1_partner_id_header_fields, pd3p1_partner_id_header_field_desc);
+          print_vdo(((uint32_t) id.disc_id.id_header), LIBTYPEC_VDO_PD3P1_PARTNER_ID_HEADER);
           printf("    Cert Stat: 0x%08x\n", id.disc_id.cert_stat);
-          print_vdo(((uint32_t) id.disc_id.cert_stat), 1, pd3p1_cert_stat_fields, pd3p1_cert_stat_field_desc);
+          print_vdo(((uint32_t) id.disc_id.cert_stat), LIBTYPEC_VDO_PD3P1_CERT_STAT);
           printf("    Product: 0x%08x\n", id.disc_id.product);
-          print_vdo(((uint32_t) id.disc_id.product), 2, pd3p1_product_fields, pd3p1_product_field_desc);
+          print_vdo(((uint32_t) id.disc_id.product), LIBTYPEC_VDO_PD3P1_PRODUCT);
           break;
         default:
           printf("    ID Header: 0x%08x\n", id.disc_id.id_header);
@@ -465,61 +484,61 @@ void print_identity_data(int recipient, union libtypec_discovered_identity id, s
       {
         case product_type_pd2p0_ama:
           printf("    Product VDO 1: 0x%08x\n", id.disc_id.product_type_vdo1);
-          print_vdo(((uint32_t) id.disc_id.product_type_vdo1), 11, pd2p0_ama_fields, pd2p0_ama_field_desc);
+          print_vdo(((uint32_t) id.disc_id.product_type_vdo1), LIBTYPEC_VDO_PD2P0_AMA);
           printf("    Product VDO 2: 0x%08x\n", id.disc_id.product_type_vdo2);
           printf("    Product VDO 3: 0x%08x\n", id.disc_id.product_type_vdo3);
           break;
         case product_type_pd3p0_ama:
           printf("    Product VDO 1: 0x%08x\n", id.disc_id.product_type_vdo1);
-          print_vdo(((uint32_t) id.disc_id.product_type_vdo1), 8, pd3p0_ama_fields, pd3p0_ama_field_desc);
+          print_vdo(((uint32_t) id.disc_id.product_type_vdo1), LIBTYPEC_VDO_PD3P0_AMA);
           printf("    Product VDO 2: 0x%08x\n", id.disc_id.product_type_vdo2);
           printf("    Product VDO 3: 0x%08x\n", id.disc_id.product_type_vdo3);
           break;
         case product_type_pd3p0_vpd:
           printf("    Product VDO 1: 0x%08x\n", id.disc_id.product_type_vdo1);
-          print_vdo(((uint32_t) id.disc_id.product_type_vdo1), 10, pd3p0_vpd_fields, pd3p0_vpd_field_desc);
+          print_vdo(((uint32_t) id.disc_id.product_type_vdo1), LIBTYPEC_VDO_PD3P0_VPD);
           printf("    Product VDO 2: 0x%08x\n", id.disc_id.product_type_vdo2);
           printf("    Product VDO 3: 0x%08x\n", id.disc_id.product_type_vdo3);
           break;
         case product_type_pd3p0_ufp:
           printf("    Product VDO 1: 0x%08x\n", id.disc_id.product_type_vdo1);
-          print_vdo(((uint32_t) id.disc_id.product_type_vdo1), 6, pd3p0_ufp_vdo1_fields, pd3p0_ufp_vdo1_field_desc);
+          print_vdo(((uint32_t) id.disc_id.product_type_vdo1), LIBTYPEC_VDO_PD3P0_UFP_VDO1);
           printf("    Product VDO 2: 0x%08x\n", id.disc_id.product_type_vdo2);
-          print_vdo(((uint32_t) id.disc_id.product_type_vdo2), 6, pd3p0_ufp_vdo2_fields, pd3p0_ufp_vdo2_field_desc);
+          print_vdo(((uint32_t) id.disc_id.product_type_vdo2), LIBTYPEC_VDO_PD3P0_UFP_VDO2);
           printf("    Product VDO 3: 0x%08x\n", id.disc_id.product_type_vdo3);
           break;
         case product_type_pd3p0_dfp:
           printf("    Product VDO 1: 0x%08x\n", id.disc_id.product_type_vdo1);
-          print_vdo(((uint32_t) id.disc_id.product_type_vdo1), 5, pd3p0_dfp_fields, pd3p0_dfp_field_desc);
+          print_vdo(((uint32_t) id.disc_id.product_type_vdo1), LIBTYPEC_VDO_PD3P0_DFP);
           printf("    Product VDO 2: 0x%08x\n", id.disc_id.product_type_vdo2);
           printf("    Product VDO 3: 0x%08x\n", id.disc_id.product_type_vdo3);
           break;
         case product_type_pd3p0_drd:
           printf("    Product VDO 1: 0x%08x\n", id.disc_id.product_type_vdo1);
-          print_vdo(((uint32_t) id.disc_id.product_type_vdo1), 6, pd3p0_ufp_vdo1_fields, pd3p0_ufp_vdo1_field_desc);
+          print_vdo(((uint32_t) id.disc_id.product_type_vdo1), LIBTYPEC_VDO_PD3P0_UFP_VDO1);
           printf("    Product VDO 2: 0x%08x\n", id.disc_id.product_type_vdo2);
-          print_vdo(((uint32_t) id.disc_id.product_type_vdo2), 6, pd3p0_ufp_vdo2_fields, pd3p0_ufp_vdo2_field_desc);
+          print_vdo(((uint32_t) id.disc_id.product_type_vdo2), LIBTYPEC_VDO_PD3P0_UFP_VDO2);
           printf("    Product VDO 3: 0x%08x\n", id.disc_id.product_type_vdo3);
-          print_vdo(((uint32_t) id.disc_id.product_type_vdo3), 5, pd3p0_dfp_fields, pd3p0_dfp_field_desc);
+          print_vdo(((uint32_t) id.disc_id.product_type_vdo3), LIBTYPEC_VDO_PD3P0_DFP);
           break;
         case product_type_pd3p1_ufp:
           printf("    Product VDO 1: 0x%08x\n", id.disc_id.product_type_vdo1);
-          print_vdo(((uint32_t) id.disc_id.product_type_vdo1), 10, pd3p1_ufp_fields, pd3p1_ufp_field_desc);
+          print_vdo(((uint32_t) id.disc_id.product_type_vdo1), LIBTYPEC_VDO_PD3P1_UFP);
           printf("    Product VDO 2: 0x%08x\n", id.disc_id.product_type_vdo2);
           printf("    Product VDO 3: 0x%08x\n", id.disc_id.product_type_vdo3);
           break;
         case product_type_pd3p1_dfp:
           printf("    Product VDO 1: 0x%08x\n", id.disc_id.product_type_vdo1);
-          print_vdo(((uint32_t) id.disc_id.product_type_vdo1), 6, pd3p1_dfp_fields, pd3p1_dfp_field_desc);
+          print_vdo(((uint32_t) id.disc_id.product_type_vdo1), LIBTYPEC_VDO_PD3P1_DFP);
           printf("    Product VDO 2: 0x%08x\n", id.disc_id.product_type_vdo2);
           printf("    Product VDO 3: 0x%08x\n", id.disc_id.product_type_vdo3);
           break;
         case product_type_pd3p1_drd:
           printf("    Product VDO 1: 0x%08x\n", id.disc_id.product_type_vdo1);
-          print_vdo(((uint32_t) id.disc_id.product_type_vdo1), 10, pd3p1_ufp_fields, pd3p1_ufp_field_desc);
+          print_vdo(((uint32_t) id.disc_id.product_type_vdo1), LIBTYPEC_VDO_PD3P1_UFP);
           printf("    Product VDO 2: 0x%08x\n", id.disc_id.product_type_vdo2);
           printf("    Product VDO 3: 0x%08x\n", id.disc_id.product_type_vdo3);
-          print_vdo(((uint32_t) id.disc_id.product_type_vdo3), 6, pd3p1_dfp_fields, pd3p1_dfp_field_desc);
+          print_vdo(((uint32_t) id.disc_id.product_type_vdo3), LIBTYPEC_VDO_PD3P1_DFP);
           break;
         default:
           printf("    Product VDO 1: 0x%08x\n", id.disc_id.product_type_vdo1);
@@ -551,27 +570,27 @@ void print_identity_data(int recipient, union libtypec_discovered_identity id, s
       {
         case 0x200:
           printf("    ID Header: 0x%08x\n", id.disc_id.id_header);
-          print_vdo(((uint32_t) id.disc_id.id_header), 6, pd2p0_cable_id_header_fields, pd2p0_cable_id_header_field_desc);
+          print_vdo(((uint32_t) id.disc_id.id_header), LIBTYPEC_VDO_PD2P0_CABLE_ID_HEADER);
           printf("    Cert Stat: 0x%08x\n", id.disc_id.cert_stat);
-          print_vdo(((uint32_t) id.disc_id.cert_stat), 1, pd2p0_cert_stat_fields, pd2p0_cert_stat_field_desc);
+          print_vdo(((uint32_t) id.disc_id.cert_stat), LIBTYPEC_VDO_PD2P0_CERT_STAT);
           printf("    Product: 0x%08x\n", id.disc_id.product);
-          print_vdo(((uint32_t) id.disc_id.product), 2, pd2p0_product_fields, pd2p0_product_field_desc);
+          print_vdo(((uint32_t) id.disc_id.product), LIBTYPEC_VDO_PD2P0_PRODUCT);
           break;
         case 0x300:
           printf("    ID Header: 0x%08x\n", id.disc_id.id_header);
-          print_vdo(((uint32_t) id.disc_id.id_header), 7, pd3p0_cable_id_header_fields, pd3p0_cable_id_header_field_desc);
+          print_vdo(((uint32_t) id.disc_id.id_header), LIBTYPEC_VDO_PD3P0_CABLE_ID_HEADER);
           printf("    Cert Stat: 0x%08x\n", id.disc_id.cert_stat);
-          print_vdo(((uint32_t) id.disc_id.cert_stat), 1, pd3p0_cert_stat_fields, pd3p0_cert_stat_field_desc);
+          print_vdo(((uint32_t) id.disc_id.cert_stat), LIBTYPEC_VDO_PD3P0_CERT_STAT);
           printf("    Product: 0x%08x\n", id.disc_id.product);
-          print_vdo(((uint32_t) id.disc_id.product), 2, pd3p0_product_fields, pd3p0_product_field_desc);
+          print_vdo(((uint32_t) id.disc_id.product), LIBTYPEC_VDO_PD3P0_PRODUCT);
           break;
         case 0x310:
           printf("    ID Header: 0x%08x\n", id.disc_id.id_header);
-          print_vdo(((uint32_t) id.disc_id.id_header), 8, pd3p1_cable_id_header_fields, pd3p1_cable_id_header_field_desc);
+          print_vdo(((uint32_t) id.disc_id.id_header), LIBTYPEC_VDO_PD3P1_CABLE_ID_HEADER);
           printf("    Cert Stat: 0x%08x\n", id.disc_id.cert_stat);
-          print_vdo(((uint32_t) id.disc_id.cert_stat), 1, pd3p1_cert_stat_fields, pd3p1_cert_stat_field_desc);
+          print_vdo(((uint32_t) id.disc_id.cert_stat), LIBTYPEC_VDO_PD3P1_CERT_STAT);
           printf("    Product: 0x%08x\n", id.disc_id.product);
-          print_vdo(((uint32_t) id.disc_id.product), 2, pd3p1_product_fields, pd3p1_product_field_desc);
+          print_vdo(((uint32_t) id.disc_id.product), LIBTYPEC_VDO_PD3P1_PRODUCT);
           break;
         default:
           printf("    ID Header: 0x%08x\n", id.disc_id.id_header);
@@ -586,45 +605,45 @@ void print_identity_data(int recipient, union libtypec_discovered_identity id, s
       {
         case product_type_pd2p0_passive_cable:
           printf("    Product VDO 1: 0x%08x\n", id.disc_id.product_type_vdo1);
-          print_vdo(((uint32_t) id.disc_id.product_type_vdo1), 15, pd2p0_passive_cable_fields, pd2p0_passive_cable_field_desc);
+          print_vdo(((uint32_t) id.disc_id.product_type_vdo1), LIBTYPEC_VDO_PD2P0_PASSIVE_CABLE);
           printf("    Product VDO 2: 0x%08x\n", id.disc_id.product_type_vdo2);
           printf("    Product VDO 3: 0x%08x\n", id.disc_id.product_type_vdo3);
           break;
         case product_type_pd2p0_active_cable:
           printf("    Product VDO 1: 0x%08x\n", id.disc_id.product_type_vdo1);
-          print_vdo(((uint32_t) id.disc_id.product_type_vdo1), 15, pd2p0_active_cable_fields, pd2p0_active_cable_field_desc);
+          print_vdo(((uint32_t) id.disc_id.product_type_vdo1), LIBTYPEC_VDO_PD2P0_ACTIVE_CABLE);
           printf("    Product VDO 2: 0x%08x\n", id.disc_id.product_type_vdo2);
           printf("    Product VDO 3: 0x%08x\n", id.disc_id.product_type_vdo3);
           break;
         case product_type_pd3p0_passive_cable:
           printf("    Product VDO 1: 0x%08x\n", id.disc_id.product_type_vdo1);
-          print_vdo(((uint32_t) id.disc_id.product_type_vdo1), 13, pd3p0_passive_cable_fields, pd3p0_passive_cable_field_desc);
+          print_vdo(((uint32_t) id.disc_id.product_type_vdo1), LIBTYPEC_VDO_PD3P0_PASSIVE_CABLE);
           printf("    Product VDO 2: 0x%08x\n", id.disc_id.product_type_vdo2);
           printf("    Product VDO 3: 0x%08x\n", id.disc_id.product_type_vdo3);
           break;
         case product_type_pd3p0_active_cable:
           printf("   Product VDO 1: 0x%08x\n", id.disc_id.product_type_vdo1);
-          print_vdo(((uint32_t) id.disc_id.product_type_vdo1), 15, pd3p0_active_cable_vdo1_fields, pd3p0_active_cable_vdo1_field_desc);
+          print_vdo(((uint32_t) id.disc_id.product_type_vdo1), LIBTYPEC_VDO_PD3P0_ACTIVE_CABLE_VDO1);
           printf("    Product VDO 2: 0x%08x\n", id.disc_id.product_type_vdo2);
-          print_vdo(((uint32_t) id.disc_id.product_type_vdo2), 15, pd3p0_active_cable_vdo2_fields, pd3p0_active_cable_vdo2_field_desc);
+          print_vdo(((uint32_t) id.disc_id.product_type_vdo2), LIBTYPEC_VDO_PD3P0_ACTIVE_CABLE_VDO2);
           printf("    Product VDO 3: 0x%08x\n", id.disc_id.product_type_vdo3);
           break;
         case product_type_pd3p1_passive_cable:
           printf("    Product VDO 1: 0x%08x\n", id.disc_id.product_type_vdo1);
-          print_vdo(((uint32_t) id.disc_id.product_type_vdo1), 13, pd3p1_passive_cable_fields, pd3p1_passive_cable_field_desc);
+          print_vdo(((uint32_t) id.disc_id.product_type_vdo1), LIBTYPEC_VDO_PD3P1_PASSIVE_CABLE);
           printf("    Product VDO 2: 0x%08x\n", id.disc_id.product_type_vdo2);
           printf("    Product VDO 3: 0x%08x\n", id.disc_id.product_type_vdo3);
           break;
         case product_type_pd3p1_active_cable:
           printf("    Product VDO 1: 0x%08x\n", id.disc_id.product_type_vdo1);
-          print_vdo(((uint32_t) id.disc_id.product_type_vdo1), 15, pd3p1_active_cable_vdo1_fields, pd3p1_active_cable_vdo1_field_desc);
+          print_vdo(((uint32_t) id.disc_id.product_type_vdo1), LIBTYPEC_VDO_PD3P1_ACTIVE_CABLE_VDO1);
           printf("    Product VDO 2: 0x%08x\n", id.disc_id.product_type_vdo2);
-          print_vdo(((uint32_t) id.disc_id.product_type_vdo2), 15, pd3p1_active_cable_vdo2_fields, pd3p1_active_cable_vdo2_field_desc);
+          print_vdo(((uint32_t) id.disc_id.product_type_vdo2), LIBTYPEC_VDO_PD3P1_ACTIVE_CABLE_VDO2);
           printf("    Product VDO 3: 0x%08x\n", id.disc_id.product_type_vdo3);
           break;
         case product_type_pd3p1_vpd:
           printf("    Product VDO 1: 0x%08x\n", id.disc_id.product_type_vdo1);
-          print_vdo(((uint32_t) id.disc_id.product_type_vdo1), 10, pd3p1_vpd_fields, pd3p0_vpd_field_desc);
+          print_vdo(((uint32_t) id.disc_id.product_type_vdo1), LIBTYPEC_VDO_PD3P1_VPD);
           printf("    Product VDO 2: 0x%08x\n", id.disc_id.product_type_vdo2);
           printf("    Product VDO 3: 0x%08x\n", id.disc_id.product_type_vdo3);
           break;
@@ -647,51 +666,53 @@ void print_identity_data(int recipient, union libtypec_discovered_identity id, s
   }
 }
 
-void print_source_pdo_data(struct libtypec_get_pdos *pdo_data, int num_pdos, int revision) {
+void print_source_pdo_data(const unsigned int *pdo, int num_pdos, int revision) {
   for (int i = 0; i < num_pdos; i++) {
-    printf("    PDO%d: 0x%08x\n", i+1, pdo_data->pdo[i]);
+    printf("    PDO%d: 0x%08x\n", i+1, pdo[i]);
 
-    if (lstypec_args.verbose) {
+    if (lstypec_args.verbose && pdo[i]) {
       if (revision == 0x200) {
-        switch((pdo_data->pdo[i] >> 30)) {
+        switch((pdo[i] >> 30)) {
           case PDO_FIXED:
-            print_vdo(pdo_data->pdo[i], 10, pd2p0_fixed_supply_src_fields, pd2p0_fixed_supply_src_field_desc);
+            print_vdo(pdo[i], LIBTYPEC_VDO_PD2P0_FIXED_SUPPLY_SRC);
             break;
           case PDO_BATTERY:
-            print_vdo(pdo_data->pdo[i], 4, pd2p0_battery_supply_src_fields, pd2p0_battery_supply_src_field_desc);
+            print_vdo(pdo[i], LIBTYPEC_VDO_PD2P0_BATTERY_SUPPLY_SRC);
             break;
           case PDO_VARIABLE:
-            print_vdo(pdo_data->pdo[i], 4, pd2p0_variable_supply_src_fields, pd2p0_variable_supply_src_field_desc);
+            print_vdo(pdo[i], LIBTYPEC_VDO_PD2P0_VARIABLE_SUPPLY_SRC);
             break;
         }
       } else if (revision == 0x300) {
-        switch((pdo_data->pdo[i] >> 30)) {
+        switch((pdo[i] >> 30)) {
           case PDO_FIXED:
-            print_vdo(pdo_data->pdo[i], 11, pd3p0_fixed_supply_src_fields, pd3p0_fixed_supply_src_field_desc);
+            print_vdo(pdo[i], LIBTYPEC_VDO_PD3P0_FIXED_SUPPLY_SRC);
             break;
           case PDO_BATTERY:
-            print_vdo(pdo_data->pdo[i], 4, pd3p0_battery_supply_src_fields, pd3p0_battery_supply_src_field_desc);
+            print_vdo(pdo[i], LIBTYPEC_VDO_PD3P0_BATTERY_SUPPLY_SRC);
             break;
           case PDO_VARIABLE:
-            print_vdo(pdo_data->pdo[i], 4, pd3p0_variable_supply_src_fields, pd3p0_variable_supply_src_field_desc);
+            print_vdo(pdo[i], LIBTYPEC_VDO_PD3P0_VARIABLE_SUPPLY_SRC);
             break;
           case PDO_AUGMENTED:
-            print_vdo(pdo_data->pdo[i], 9, pd3p0_pps_apdo_src_fields, pd3p0_pps_apdo_src_field_desc);
+            if (((pdo[i] >> 28) & 0x3) == APDO_SPR_PPS)
+              print_vdo(pdo[i], LIBTYPEC_VDO_PD3P0_PPS_APDO_SRC);
             break;
         }
       } else if (revision == 0x310) {
-        switch((pdo_data->pdo[i] >> 30)) {
+        switch((pdo[i] >> 30)) {
           case PDO_FIXED:
-            print_vdo(pdo_data->pdo[i], 12, pd3p1_fixed_supply_src_fields, pd3p1_fixed_supply_src_field_desc);
+            print_vdo(pdo[i], LIBTYPEC_VDO_PD3P1_FIXED_SUPPLY_SRC);
             break;
           case PDO_BATTERY:
-            print_vdo(pdo_data->pdo[i], 4, pd3p1_battery_supply_src_fields, pd3p1_battery_supply_src_field_desc);
+            print_vdo(pdo[i], LIBTYPEC_VDO_PD3P1_BATTERY_SUPPLY_SRC);
             break;
           case PDO_VARIABLE:
-            print_vdo(pdo_data->pdo[i], 4, pd3p1_variable_supply_src_fields, pd3p1_variable_supply_src_field_desc);
+            print_vdo(pdo[i], LIBTYPEC_VDO_PD3P1_VARIABLE_SUPPLY_SRC);
             break;
           case PDO_AUGMENTED:
-            print_vdo(pdo_data->pdo[i], 9, pd3p1_pps_apdo_src_fields, pd3p1_pps_apdo_src_field_desc);
+            if (((pdo[i] >> 28) & 0x3) == APDO_SPR_PPS)
+              print_vdo(pdo[i], LIBTYPEC_VDO_PD3P1_PPS_APDO_SRC);
             break;
         }
       }
@@ -699,51 +720,53 @@ void print_source_pdo_data(struct libtypec_get_pdos *pdo_data, int num_pdos, int
   }
 }
 
-void print_sink_pdo_data(struct libtypec_get_pdos *pdo_data, int num_pdos, int revision) {
+void print_sink_pdo_data(const unsigned int *pdo, int num_pdos, int revision) {
   for (int i = 0; i < num_pdos; i++) {
-    printf("    PDO%d: 0x%08x\n", i+1, pdo_data->pdo[i]);
+    printf("    PDO%d: 0x%08x\n", i+1, pdo[i]);
 
-    if (lstypec_args.verbose) {
+    if (lstypec_args.verbose && pdo[i]) {
       if (revision == 0x200) {
-        switch((pdo_data->pdo[i] >> 30)) {
+        switch((pdo[i] >> 30)) {
           case PDO_FIXED:
-            print_vdo(pdo_data->pdo[i], 9, pd2p0_fixed_supply_snk_fields, pd2p0_fixed_supply_snk_field_desc);
+            print_vdo(pdo[i], LIBTYPEC_VDO_PD2P0_FIXED_SUPPLY_SNK);
             break;
           case PDO_BATTERY:
-            print_vdo(pdo_data->pdo[i], 4, pd2p0_battery_supply_snk_fields, pd2p0_battery_supply_snk_field_desc);
+            print_vdo(pdo[i], LIBTYPEC_VDO_PD2P0_BATTERY_SUPPLY_SNK);
             break;
           case PDO_VARIABLE:
-            print_vdo(pdo_data->pdo[i], 4, pd2p0_variable_supply_snk_fields, pd2p0_variable_supply_snk_field_desc);
+            print_vdo(pdo[i], LIBTYPEC_VDO_PD2P0_VARIABLE_SUPPLY_SNK);
             break;
         }
       } else if (revision == 0x300) {
-        switch((pdo_data->pdo[i] >> 30)) {
+        switch((pdo[i] >> 30)) {
           case PDO_FIXED:
-            print_vdo(pdo_data->pdo[i], 10, pd3p0_fixed_supply_snk_fields, pd3p0_fixed_supply_snk_field_desc);
+            print_vdo(pdo[i], LIBTYPEC_VDO_PD3P0_FIXED_SUPPLY_SNK);
             break;
           case PDO_BATTERY:
-            print_vdo(pdo_data->pdo[i], 4, pd3p0_battery_supply_snk_fields, pd3p0_battery_supply_snk_field_desc);
+            print_vdo(pdo[i], LIBTYPEC_VDO_PD3P0_BATTERY_SUPPLY_SNK);
             break;
           case PDO_VARIABLE:
-            print_vdo(pdo_data->pdo[i], 4, pd3p0_variable_supply_snk_fields, pd3p0_variable_supply_snk_field_desc);
+            print_vdo(pdo[i], LIBTYPEC_VDO_PD3P0_VARIABLE_SUPPLY_SNK);
             break;
           case PDO_AUGMENTED:
-            print_vdo(pdo_data->pdo[i], 8, pd3p0_pps_apdo_snk_fields, pd3p0_pps_apdo_snk_field_desc);
+            if (((pdo[i] >> 28) & 0x3) == APDO_SPR_PPS)
+              print_vdo(pdo[i], LIBTYPEC_VDO_PD3P0_PPS_APDO_SNK);
             break;
         }
       } else if (revision == 0x310) {
-        switch((pdo_data->pdo[i] >> 30)) {
+        switch((pdo[i] >> 30)) {
           case PDO_FIXED:
-            print_vdo(pdo_data->pdo[i], 10, pd3p1_fixed_supply_snk_fields, pd3p1_fixed_supply_snk_field_desc);
+            print_vdo(pdo[i], LIBTYPEC_VDO_PD3P1_FIXED_SUPPLY_SNK);
             break;
           case PDO_BATTERY:
-            print_vdo(pdo_data->pdo[i], 4, pd3p1_battery_supply_snk_fields, pd3p1_battery_supply_snk_field_desc);
+            print_vdo(pdo[i], LIBTYPEC_VDO_PD3P1_BATTERY_SUPPLY_SNK);
             break;
           case PDO_VARIABLE:
-            print_vdo(pdo_data->pdo[i], 4, pd3p1_variable_supply_snk_fields, pd3p1_variable_supply_snk_field_desc);
+            print_vdo(pdo[i], LIBTYPEC_VDO_PD3P1_VARIABLE_SUPPLY_SNK);
             break;
           case PDO_AUGMENTED:
-            print_vdo(pdo_data->pdo[i], 8, pd3p1_pps_apdo_snk_fields, pd3p1_pps_apdo_snk_field_desc);
+            if (((pdo[i] >> 28) & 0x3) == APDO_SPR_PPS)
+              print_vdo(pdo[i], LIBTYPEC_VDO_PD3P1_PPS_APDO_SNK);
             break;
         }
       }
@@ -761,33 +784,47 @@ void lstypec_print(char *val, int type)
     else
         printf("lstypec - INFO - %s\n", val);
 }
+/* Alternate modes as a view into the scan arena */
+static int lstypec_get_modes(int recipient, int conn_num, const struct altmode_data **am)
+{
+    struct libtypec_altmode_view view;
+    int ret;
+
+    ret = libtypec_get_alternate_modes_view(recipient, conn_num, &scan_arena, &view);
+    if (ret == -ENOSPC)
+    {
+        printf("    Showing %d of %d alternate modes\n", view.num, view.total);
+        ret = view.num;
+    }
+    if (ret >= 0)
+        *am = view.am;
+
+    return ret;
+}
 void print_capabilities_partner(int i)
 {
-    int ret, num_modes, num_pdos;
+    int ret, num_modes;
 
    // Partner
-    num_modes = libtypec_get_alternate_modes(AM_SOP, i, am_data);
+    num_modes = lstypec_get_modes(AM_SOP, i, &am_data);
     if (num_modes >= 0) 
       print_alternate_mode_data(AM_SOP, id.disc_id.id_header, num_modes, am_data);
     ret = libtypec_get_pd_message(AM_SOP, i, 24, DISCOVER_ID_REQ, id.buf_disc_id);
     if (ret >= 0) {
       print_identity_data(AM_SOP, id, conn_data);
     }
-    pdo_data = malloc(sizeof(int)*8);
-    
-    ret = libtypec_get_pdos(i, 1, 0, &num_pdos, 1, 0, pdo_data);
+    ret = libtypec_get_pdos_view(i, 1, 1, 0, &scan_arena, &pdo_view);
     if (ret > 0) {
       printf("  Partner PDO Data (Source):\n");
-      print_source_pdo_data(pdo_data, num_pdos, conn_data.partner_pd_rev);
+      print_source_pdo_data(pdo_view.pdo, pdo_view.num, conn_data.partner_pd_rev);
     }
    
-    ret = libtypec_get_pdos(i, 1, 0, &num_pdos, 0, 0, pdo_data);
+    ret = libtypec_get_pdos_view(i, 1, 0, 0, &scan_arena, &pdo_view);
     if (ret > 0) {
       printf("  Partner PDO Data (Sink):\n");
-      print_sink_pdo_data(pdo_data, num_pdos, conn_data.partner_pd_rev);
+      print_sink_pdo_data(pdo_view.pdo, pdo_view.num, conn_data.partner_pd_rev);
     }
   
-    free(pdo_data);
 
 }
 void print_capabilities_cable(int i)
@@ -804,7 +841,7 @@ void print_capabilities_cable(int i)
       print_cable_prop(cable_prop, i);
 
         // Cable
-    num_modes = libtypec_get_alternate_modes(AM_SOP_PR, i, am_data);
+    num_modes = lstypec_get_modes(AM_SOP_PR, i, &am_data);
     if (num_modes >= 0) 
       print_alternate_mode_data(AM_SOP_PR, id.disc_id.id_header, num_modes, am_data);
 
@@ -816,7 +853,7 @@ void print_capabilities_cable(int i)
 }
 void print_capabilities_port(int i)
 {
-    int ret, num_modes, num_pdos;
+    int ret, num_modes;
 
     // Connector Capabilities
 	printf("\nConnector %d Capability/Status\n", i);
@@ -824,29 +861,27 @@ void print_capabilities_port(int i)
     print_conn_capability(conn_data);
 
     // Connector PDOs
-    pdo_data = malloc(sizeof(int)*8);
-    ret = libtypec_get_pdos(i, 0, 0, &num_pdos, 1, 0, pdo_data);
+    ret = libtypec_get_pdos_view(i, 0, 1, 0, &scan_arena, &pdo_view);
     if (ret > 0) {
       printf("  Connector PDO Data (Source):\n");
-      print_source_pdo_data(pdo_data, num_pdos, get_cap_data.bcdPDVersion);
+      print_source_pdo_data(pdo_view.pdo, pdo_view.num, get_cap_data.bcdPDVersion);
     }
     else
         printf("  Connector PDO Data (Source) returned : %d\n", ret);
 
-    ret = libtypec_get_pdos(i, 0, 0, &num_pdos, 0, 0, pdo_data);
+    ret = libtypec_get_pdos_view(i, 0, 0, 0, &scan_arena, &pdo_view);
     if (ret > 0) {
       printf("  Connector PDO Data (Sink):\n");
-      print_sink_pdo_data(pdo_data, num_pdos, get_cap_data.bcdPDVersion);
+      print_sink_pdo_data(pdo_view.pdo, pdo_view.num, get_cap_data.bcdPDVersion);
     }
     else
         printf("  Connector PDO Data (Source) returned : %d\n", ret);
 
-    free(pdo_data);
     
     // Supported Alternate Modes
     printf("  Alternate Modes Supported:\n");
   
-    num_modes = libtypec_get_alternate_modes(AM_CONNECTOR, i, am_data);
+    num_modes = lstypec_get_modes(AM_CONNECTOR, i, &am_data);
     if (num_modes > 0)
       print_alternate_mode_data(AM_CONNECTOR, 0x0, num_modes, am_data);
     else
@@ -878,7 +913,7 @@ void lstypec_print_am()
           printf("lstypec - ERROR - %s, Provide one less than Num Ports %d \n", "Port number out of range",get_cap_data.bNumConnectors);
           exit(1);
       }
-      int num_modes = libtypec_get_alternate_modes(AM_CONNECTOR, lstypec_args.port_num, am_data);
+      int num_modes = lstypec_get_modes(AM_CONNECTOR, lstypec_args.port_num, &am_data);
 
       if (num_modes > 0)
       print_alternate_mode_data(AM_CONNECTOR, 0x0, num_modes, am_data);
@@ -893,7 +928,7 @@ void lstypec_print_am()
         exit(1);
     }
      // Partner
-    int num_modes = libtypec_get_alternate_modes(AM_SOP, lstypec_args.partner_num, am_data);
+    int num_modes = lstypec_get_modes(AM_SOP, lstypec_args.partner_num, &am_data);
     if (num_modes >= 0) 
       print_alternate_mode_data(AM_SOP, id.disc_id.id_header, num_modes, am_data);
     ret = libtypec_get_pd_message(AM_SOP, lstypec_args.partner_num, 24, DISCOVER_ID_REQ, id.buf_disc_id);
@@ -909,7 +944,7 @@ void lstypec_print_am()
         exit(1);
     }
             // Cable
-    int num_modes = libtypec_get_alternate_modes(AM_SOP_PR, lstypec_args.cb_num, am_data);
+    int num_modes = lstypec_get_modes(AM_SOP_PR, lstypec_args.cb_num, &am_data);
     if (num_modes >= 0) 
       print_alternate_mode_data(AM_SOP_PR, id.disc_id.id_header, num_modes, am_data);
 
@@ -1027,6 +1062,7 @@ void lstypec_default_verbose()
   print_ppm_capability(get_cap_data);
   for (int i = 0; i < get_cap_data.bNumConnectors; i++) 
   {
+      libtypec_arena_reset(&scan_arena);
       print_capabilities_port(i);
       print_capabilities_cable(i);
       print_capabilities_partner(i);
@@ -1035,12 +1071,506 @@ void lstypec_default_verbose()
   printf("\n");
 
 }
+/*
+ * --json and --binary: one snapshot, formatted into a growing buffer that
+ * is written out with a single call
+ */
+static struct libtypec_snapshot snap;
+
+static struct {
+    char *buf;
+    size_t len;
+    size_t size;
+} out;
+
+static void out_reserve(size_t n)
+{
+    char *buf;
+    size_t size;
+
+    if (out.len + n <= out.size)
+        return;
+
+    size = out.size ? out.size : 16384;
+    while (size < out.len + n)
+        size *= 2;
+
+    buf = realloc(out.buf, size);
+    if (!buf)
+        lstypec_print("Out of memory", LSTYPEC_ERROR);
+
+    out.buf = buf;
+    out.size = size;
+}
+
+static void out_printf(const char *fmt, ...)
+{
+    va_list ap;
+    int n;
+
+    va_start(ap, fmt);
+    n = vsnprintf(out.buf + out.len, out.size - out.len, fmt, ap);
+    va_end(ap);
+
+    if (n >= 0 && out.len + n >= out.size)
+    {
+        out_reserve(n + 1);
+        va_start(ap, fmt);
+        vsnprintf(out.buf + out.len, out.size - out.len, fmt, ap);
+        va_end(ap);
+    }
+    if (n > 0)
+        out.len += n;
+}
+
+static void out_json_string(const char *s)
+{
+    out_reserve(strlen(s) * 6 + 2);
+
+    out.buf[out.len++] = '"';
+    for (; *s; s++)
+    {
+        unsigned char c = *s;
+
+        if (c == '"' || c == '\\')
+        {
+            out.buf[out.len++] = '\\';
+            out.buf[out.len++] = c;
+        }
+        else if (c < 0x20)
+            out.len += sprintf(out.buf + out.len, "\\u%04x", c);
+        else
+            out.buf[out.len++] = c;
+    }
+    out.buf[out.len++] = '"';
+}
+
+static void out_flush(void)
+{
+    if (out.len && fwrite(out.buf, 1, out.len, stdout) != out.len)
+        lstypec_print("Failed writing output", LSTYPEC_ERROR);
+    out.len = 0;
+}
+
+static void json_pdos(const char *key, const uint32_t *pdo, int num)
+{
+    static const char *kind_str[] = {
+        [LIBTYPEC_PDO_KIND_FIXED] = "fixed",
+        [LIBTYPEC_PDO_KIND_BATTERY] = "battery",
+        [LIBTYPEC_PDO_KIND_VARIABLE] = "variable",
+        [LIBTYPEC_PDO_KIND_SPR_PPS] = "spr_pps",
+        [LIBTYPEC_PDO_KIND_EPR_AVS] = "epr_avs",
+        [LIBTYPEC_PDO_KIND_SPR_AVS] = "spr_avs",
+        [LIBTYPEC_PDO_KIND_RESERVED] = "reserved",
+    };
+    uint8_t kind[LIBTYPEC_MAX_PDOS];
+    uint32_t min_mv[LIBTYPEC_MAX_PDOS], max_mv[LIBTYPEC_MAX_PDOS], max_ma[LIBTYPEC_MAX_PDOS];
+    uint32_t max_mw[LIBTYPEC_MAX_PDOS], flags[LIBTYPEC_MAX_PDOS];
+    struct libtypec_pdo_soa soa = {kind, min_mv, max_mv, max_ma, max_mw, flags};
+
+    libtypec_decode_pdos(pdo, num, &soa);
+
+    out_printf(",\"%s\":[", key);
+    for (int i = 0; i < num; i++)
+    {
+        /* Unused slots of a PDO list are zero */
+        if (!pdo[i])
+            continue;
+        out_printf("%s{\"index\":%d,\"raw\":\"0x%08x\",\"type\":\"%s\",\"min_mv\":%u,\"max_mv\":%u,"
+                   "\"max_ma\":%u,\"max_mw\":%u,\"flags\":\"0x%08x\"}",
+                   out.buf[out.len - 1] == '[' ? "" : ",", i + 1, pdo[i], kind_str[kind[i]],
+                   min_mv[i], max_mv[i], max_ma[i], max_mw[i], flags[i]);
+    }
+    out_printf("]");
+}
+
+static void json_altmodes(const struct altmode_data *am, int num)
+{
+    char name[128];
+
+    out_printf(",\"alt_modes\":[");
+    for (int i = 0; i < num; i++)
+    {
+        get_svid_string(am[i].svid, name, sizeof(name));
+        out_printf("%s{\"svid\":\"0x%04x\",\"vdo\":\"0x%08x\",\"name\":", i ? "," : "", am[i].svid, am[i].vdo);
+        out_json_string(name);
+        out_printf("}");
+    }
+    out_printf("]");
+}
+
+static void json_identity(const union libtypec_discovered_identity *id)
+{
+    char vendor[128];
+    uint16_t vid = id->disc_id.id_header & 0xffff;
+
+    get_vendor_string(vendor, sizeof(vendor), vid);
+
+    out_printf(",\"identity\":{\"id_header\":\"0x%08x\",\"cert_stat\":\"0x%08x\",\"product\":\"0x%08x\","
+               "\"product_type_vdo\":[\"0x%08x\",\"0x%08x\",\"0x%08x\"],\"vid\":\"0x%04x\",\"pid\":\"0x%04x\",\"vendor\":",
+               id->disc_id.id_header, id->disc_id.cert_stat, id->disc_id.product,
+               id->disc_id.product_type_vdo1, id->disc_id.product_type_vdo2, id->disc_id.product_type_vdo3,
+               vid, id->disc_id.product >> 16);
+    out_json_string(vendor);
+    out_printf("}");
+}
+
+static void json_capability(const struct libtypec_port_snapshot *port)
+{
+    if (!(port->valid & LIBTYPEC_SNAP_VALID_CAP))
+        return;
+
+    out_printf(",\"capability\":{\"operation_modes\":\"0x%02x\",\"provider\":%u,\"consumer\":%u,"
+               "\"swap_to_dfp\":%u,\"swap_to_ufp\":%u,\"swap_to_src\":%u,\"swap_to_snk\":%u,"
+               "\"extended_operation_modes\":\"0x%02x\",\"miscellaneous_capabilities\":\"0x%x\","
+               "\"partner_pd_revision\":%u}",
+               port->cap.opr_mode.raw_operationmode, port->cap.provider, port->cap.consumer,
+               port->cap.swap2dfp, port->cap.swap2ufp, port->cap.swap2src, port->cap.swap2snk,
+               port->cap.extended_operation_mode, port->cap.miscellaneous_capabilities,
+               port->cap.partner_pd_rev);
+}
+
+static void json_status(const struct libtypec_port_snapshot *port)
+{
+    if (!(port->valid & LIBTYPEC_SNAP_VALID_STATUS))
+        return;
+
+    out_printf(",\"status\":{\"connected\":%u,\"power_operation_mode\":%u,\"power_direction\":%u,"
+               "\"partner_type\":%u,\"partner_flags\":\"0x%02x\",\"rdo\":\"0x%08x\",\"orientation\":%u}",
+               port->status.ConnectStatus, port->status.PowerOperationMode, port->status.PowerDirection,
+               port->status.ConnectorPartnerType, port->status.ConnectorPartnerFlags,
+               port->status.RequestDataObject, port->status.Orientation);
+}
+
+static void json_cable(const struct libtypec_port_snapshot *port)
+{
+    if (!(port->valid & (LIBTYPEC_SNAP_VALID_CABLE | LIBTYPEC_SNAP_VALID_CABLE_ID)) &&
+        !port->num_altmodes[LIBTYPEC_SNAP_AM_CABLE])
+    {
+        out_printf(",\"cable\":null");
+        return;
+    }
+
+    out_printf(",\"cable\":{\"present\":1");
+    if (port->valid & LIBTYPEC_SNAP_VALID_CABLE)
+        out_printf(",\"speed_supported\":%u,\"current_capability\":%u,\"vbus_support\":%u,"
+                   "\"cable_type\":%u,\"directionality\":%u,\"plug_end_type\":%u,\"mode_support\":%u,"
+                   "\"pd_revision\":%u,\"latency\":%u",
+                   port->cable.speed_supported, port->cable.current_capability, port->cable.vbus_support,
+                   port->cable.cable_type, port->cable.directionality, port->cable.plug_end_type,
+                   port->cable.mode_support, port->cable.cable_pd_revision, port->cable.latency);
+    if (port->valid & LIBTYPEC_SNAP_VALID_CABLE_ID)
+        json_identity(&port->cable_id);
+    json_altmodes(port->altmode[LIBTYPEC_SNAP_AM_CABLE], port->num_altmodes[LIBTYPEC_SNAP_AM_CABLE]);
+    out_printf("}");
+}
+
+static void json_partner(const struct libtypec_port_snapshot *port)
+{
+    int present;
+
+    /* Without a connector status, show whatever partner data was read */
+    if (port->valid & LIBTYPEC_SNAP_VALID_STATUS)
+        present = port->status.ConnectStatus;
+    else
+        present = port->valid & LIBTYPEC_SNAP_VALID_PARTNER_ID || port->num_pdos[LIBTYPEC_SNAP_PARTNER_SRC] ||
+                  port->num_pdos[LIBTYPEC_SNAP_PARTNER_SNK] || port->num_altmodes[LIBTYPEC_SNAP_AM_PARTNER];
+
+    if (!present)
+    {
+        out_printf(",\"partner\":null");
+        return;
+    }
+
+    out_printf(",\"partner\":{\"present\":1");
+    if (port->valid & LIBTYPEC_SNAP_VALID_PARTNER_ID)
+        json_identity(&port->partner_id);
+    json_pdos("source_pdos", port->pdo[LIBTYPEC_SNAP_PARTNER_SRC], port->num_pdos[LIBTYPEC_SNAP_PARTNER_SRC]);
+    json_pdos("sink_pdos", port->pdo[LIBTYPEC_SNAP_PARTNER_SNK], port->num_pdos[LIBTYPEC_SNAP_PARTNER_SNK]);
+    json_altmodes(port->altmode[LIBTYPEC_SNAP_AM_PARTNER], port->num_altmodes[LIBTYPEC_SNAP_AM_PARTNER]);
+    out_printf("}");
+}
+
+static void json_port(const struct libtypec_port_snapshot *port)
+{
+    out_printf("{\"port\":%u", port->conn_num);
+    json_capability(port);
+    json_status(port);
+    json_pdos("source_pdos", port->pdo[LIBTYPEC_SNAP_PORT_SRC], port->num_pdos[LIBTYPEC_SNAP_PORT_SRC]);
+    json_pdos("sink_pdos", port->pdo[LIBTYPEC_SNAP_PORT_SNK], port->num_pdos[LIBTYPEC_SNAP_PORT_SNK]);
+    json_altmodes(port->altmode[LIBTYPEC_SNAP_AM_PORT], port->num_altmodes[LIBTYPEC_SNAP_AM_PORT]);
+    json_cable(port);
+    json_partner(port);
+    out_printf("}");
+}
+
+static void lstypec_snapshot_init(void)
+{
+    int ret;
+
+    ret = libtypec_init(session_info, lstypec_args.backend);
+    if (ret < 0)
+        lstypec_print("Failed in Initializing libtypec", LSTYPEC_ERROR);
+
+    ret = libtypec_snapshot_take(&snap);
+    if (ret < 0)
+        lstypec_print("Failed in Get Capability", LSTYPEC_ERROR);
+}
+
+static void json_snapshot(void)
+{
+    out_printf("{\"version\":1,\"timestamp_ns\":%llu,\"session\":{\"libtypec\":", (unsigned long long)snap.ts_ns);
+    out_json_string(session_info[LIBTYPEC_VERSION_INDEX]);
+    out_printf(",\"os\":");
+    out_json_string(session_info[LIBTYPEC_OS_INDEX]);
+    out_printf(",\"kernel\":");
+    out_json_string(session_info[LIBTYPEC_KERNEL_INDEX]);
+    out_printf(",\"backend\":");
+    out_json_string(session_info[LIBTYPEC_OPS_INDEX]);
+
+    out_printf("},\"ppm\":{\"num_connectors\":%u,\"num_alt_modes\":%u,\"attributes\":\"0x%08x\","
+               "\"optional_features\":\"0x%02x%02x%02x\",\"bcd_bc_version\":\"0x%04x\","
+               "\"bcd_pd_version\":\"0x%04x\",\"bcd_typec_version\":\"0x%04x\"},\"ports\":[",
+               snap.ppm.bNumConnectors, snap.ppm.bNumAltModes, snap.ppm.bmAttributes.raw_attrs,
+               snap.ppm.bmOptionalFeatures.raw_optfeas[2], snap.ppm.bmOptionalFeatures.raw_optfeas[1],
+               snap.ppm.bmOptionalFeatures.raw_optfeas[0], snap.ppm.bcdBCVersion,
+               snap.ppm.bcdPDVersion, snap.ppm.bcdTypeCVersion);
+
+    for (int i = 0; i < snap.num_ports; i++)
+    {
+        if (i)
+            out_printf(",");
+        json_port(&snap.port[i]);
+    }
+    out_printf("]}\n");
+}
+
+void lstypec_print_json()
+{
+    lstypec_snapshot_init();
+    json_snapshot();
+    out_flush();
+}
+
+void lstypec_print_binary()
+{
+    int len;
+
+    lstypec_snapshot_init();
+
+    len = libtypec_snapshot_encode(&snap, NULL, 0);
+    out_reserve(len);
+    out.len = libtypec_snapshot_encode(&snap, out.buf, out.size);
+
+    out_flush();
+}
+
+/*
+ * --watch: one session, the full snapshot once, then a line per event with
+ * the fields of the affected connector that changed, as found by
+ * libtypec_snapshot_port_diff()
+ */
+static const char *watch_event_str[] = {
+    [USBC_DEVICE_CONNECTED] = "connected",
+    [USBC_DEVICE_DISCONNECTED] = "disconnected",
+    [USBC_EXT_SUPPLY_CHANGED] = "ext_supply_changed",
+    [USBC_POWER_OPMODE_CHANGED] = "power_opmode_changed",
+    [USBC_ATTENTION] = "attention",
+    [USBC_PROVIDER_CAPS_CHANGED] = "provider_caps_changed",
+    [USBC_POWER_LEVEL_CHANGED] = "power_level_changed",
+    [USBC_PD_RESET_COMPLETE] = "pd_reset_complete",
+    [USBC_CAM_CHANGED] = "cam_changed",
+    [USBC_BATTERY_STATUS_CHANGED] = "battery_status_changed",
+    [USBC_PARTNER_CHANGED] = "partner_changed",
+    [USBC_POWER_DIRECTION_CHANGED] = "power_direction_changed",
+    [USBC_SINK_PATH_CHANGED] = "sink_path_changed",
+    [USBC_CONNECTOR_ERROR] = "connector_error",
+};
+
+static const char *watch_object_str[] = {
+    [LIBTYPEC_SNAP_REC_PPM] = "ppm",
+    [LIBTYPEC_SNAP_REC_PORT_CAP] = "capability",
+    [LIBTYPEC_SNAP_REC_PORT_STATUS] = "status",
+    [LIBTYPEC_SNAP_REC_CABLE] = "cable",
+    [LIBTYPEC_SNAP_REC_PARTNER_ID] = "partner_identity",
+    [LIBTYPEC_SNAP_REC_CABLE_ID] = "cable_identity",
+    [LIBTYPEC_SNAP_REC_PDOS] = "pdos",
+    [LIBTYPEC_SNAP_REC_ALTMODES] = "alt_modes",
+};
+
+static const char *watch_pdo_list_str[] = {
+    [LIBTYPEC_SNAP_PORT_SRC] = "source",
+    [LIBTYPEC_SNAP_PORT_SNK] = "sink",
+    [LIBTYPEC_SNAP_PARTNER_SRC] = "partner_source",
+    [LIBTYPEC_SNAP_PARTNER_SNK] = "partner_sink",
+};
+
+static const char *watch_am_list_str[] = {
+    [LIBTYPEC_SNAP_AM_PORT] = "port",
+    [LIBTYPEC_SNAP_AM_PARTNER] = "partner",
+    [LIBTYPEC_SNAP_AM_CABLE] = "cable",
+};
+
+static int watch_ignore(const struct libtypec_snapshot_change *change)
+{
+    if (change->object != LIBTYPEC_SNAP_REC_PORT_STATUS)
+        return 0;
+
+    /* Change bits and VBUS readings alone are not a state change */
+    switch (change->field)
+    {
+    case LIBTYPEC_FIELD_STATUS_CHANGE:
+    case LIBTYPEC_FIELD_STATUS_POWER_READING_READY:
+    case LIBTYPEC_FIELD_STATUS_CURRENT_SCALE:
+    case LIBTYPEC_FIELD_STATUS_PEAK_CURRENT:
+    case LIBTYPEC_FIELD_STATUS_AVERAGE_CURRENT:
+    case LIBTYPEC_FIELD_STATUS_VOLTAGE_SCALE:
+    case LIBTYPEC_FIELD_STATUS_VOLTAGE_READING:
+        return 1;
+    }
+
+    return 0;
+}
+
+static void json_change(const struct libtypec_snapshot_change *change)
+{
+    const char *name = libtypec_snapshot_field_name(change->object, change->field);
+
+    out_printf("{\"object\":");
+    out_json_string(change->object < sizeof(watch_object_str) / sizeof(watch_object_str[0]) &&
+                    watch_object_str[change->object] ? watch_object_str[change->object] : "unknown");
+
+    if (change->object == LIBTYPEC_SNAP_REC_PDOS && change->list < LIBTYPEC_SNAP_PDO_LISTS)
+    {
+        out_printf(",\"list\":");
+        out_json_string(watch_pdo_list_str[change->list]);
+    }
+    else if (change->object == LIBTYPEC_SNAP_REC_ALTMODES && change->list < LIBTYPEC_SNAP_AM_LISTS)
+    {
+        out_printf(",\"list\":");
+        out_json_string(watch_am_list_str[change->list]);
+    }
+
+    out_printf(",\"field\":");
+    if (name)
+        out_json_string(name);
+    else
+        out_printf("%u", change->field);
+
+    /* List entries also carry their index */
+    if ((change->object == LIBTYPEC_SNAP_REC_PDOS || change->object == LIBTYPEC_SNAP_REC_ALTMODES) &&
+        change->field != LIBTYPEC_FIELD_PRESENT)
+        out_printf(",\"index\":%u", change->field);
+
+    out_printf(",\"old\":%llu,\"new\":%llu}",
+               (unsigned long long)change->old_value, (unsigned long long)change->new_value);
+}
+
+static void watch_port(enum usb_typec_event event, int conn_num)
+{
+    static struct libtypec_port_snapshot cur;
+    static struct libtypec_snapshot_change change[128];
+    const int max = sizeof(change) / sizeof(change[0]);
+    struct timespec ts;
+    int n, num = 0;
+
+    libtypec_snapshot_port(conn_num, &cur);
+
+    n = libtypec_snapshot_port_diff(&snap.port[conn_num], &cur, change, max);
+    for (int i = 0; i < n && i < max; i++)
+        if (!watch_ignore(&change[i]))
+            num++;
+
+    if (!num)
+    {
+        snap.port[conn_num] = cur;
+        return;
+    }
+
+    clock_gettime(CLOCK_REALTIME, &ts);
+    out_printf("{\"timestamp_ns\":%llu,\"event\":\"%s\",\"port\":%d",
+               (unsigned long long)ts.tv_sec * 1000000000ull + ts.tv_nsec, watch_event_str[event], conn_num);
+
+    if (n > max)
+    {
+        /* Too many changes for one record, resend the whole connector */
+        out_printf(",\"resync\":");
+        json_port(&cur);
+    }
+    else
+    {
+        out_printf(",\"changes\":[");
+        for (int i = 0, first = 1; i < n; i++)
+        {
+            if (watch_ignore(&change[i]))
+                continue;
+            if (!first)
+                out_printf(",");
+            json_change(&change[i]);
+            first = 0;
+        }
+        out_printf("]");
+    }
+    out_printf("}\n");
+
+    out_flush();
+    fflush(stdout);
+
+    snap.port[conn_num] = cur;
+}
+
+static void watch_event_cb(enum usb_typec_event event, void *data)
+{
+    struct libtypec_event_info info;
+    int first = 0, last = snap.num_ports;
+
+    /* Only the connector the event is about, when the backend knows it */
+    if (libtypec_get_event_info(&info) == 0 && info.conn_num >= 0 && info.conn_num < snap.num_ports)
+    {
+        first = info.conn_num;
+        last = first + 1;
+    }
+
+    for (int i = first; i < last; i++)
+        watch_port(event, i);
+}
+
+void lstypec_watch()
+{
+    lstypec_snapshot_init();
+
+    json_snapshot();
+    out_flush();
+    fflush(stdout);
+
+    for (int event = USBC_DEVICE_CONNECTED; event <= USBC_CONNECTOR_ERROR; event++)
+        libtypec_register_typec_notification_callback(event, watch_event_cb, NULL);
+
+    libtypec_monitor_events();
+}
+
 int main(int argc, char *argv[])
 {
 
   parse_args(argc, argv);
 
   names_init();
+  libtypec_arena_init(&scan_arena, scan_buf, sizeof(scan_buf));
+
+  if (lstypec_args.json) {
+      lstypec_print_json();
+      goto cleanup;
+  }
+
+  if (lstypec_args.binary) {
+      lstypec_print_binary();
+      goto cleanup;
+  }
+
+  if (lstypec_args.watch) {
+      lstypec_watch();
+      goto cleanup;
+  }
 
   if (lstypec_args.port_num != -1) {
       lstypec_print_port();
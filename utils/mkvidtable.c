@@ -0,0 +1,129 @@
+/*
+    Copyright (c) 2021-2022 by Rajaram Regupathy, rajaram.regupathy@gmail.com
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; version 2 of the License.
+
+    This program is distributed in the hope that it will be useful, but WITHOUT
+    ANY WARRANTY; without even the implied warranty MERCHANTABILITY or FITNESS
+    FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+    details.
+
+    (See the full license text in the LICENSES directory)
+*/
+// SPDX-License-Identifier: GPL-2.0-only
+/*
+ * Build time helper: converts the vendor lines of usb.ids into the mmappable
+ * table read by names.c.
+ *
+ * Usage: mkvidtable usb.ids output
+ */
+
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "names.h"
+
+struct vendor {
+    uint16_t vid;
+    size_t seq;
+    char *name;
+};
+
+static int vendor_cmp(const void *a, const void *b)
+{
+    const struct vendor *va = a, *vb = b;
+
+    if (va->vid != vb->vid)
+        return va->vid - vb->vid;
+    return va->seq < vb->seq ? -1 : va->seq > vb->seq;
+}
+
+int main(int argc, char **argv)
+{
+    struct vendor *v = NULL;
+    size_t num = 0, cap = 0, i, j;
+    struct vid_table_hdr hdr = { .magic = VID_TABLE_MAGIC, .version = VID_TABLE_VERSION };
+    char line[512];
+    uint32_t off;
+    FILE *in, *out;
+
+    if (argc != 3)
+    {
+        fprintf(stderr, "Usage: %s usb.ids output\n", argv[0]);
+        return 1;
+    }
+
+    in = fopen(argv[1], "r");
+    if (!in)
+    {
+        perror(argv[1]);
+        return 1;
+    }
+
+    /* Vendor lines are "vvvv  Name" in column 0; devices are tab indented */
+    while (fgets(line, sizeof(line), in))
+    {
+        char *end;
+
+        if (!isxdigit(line[0]) || !isxdigit(line[1]) || !isxdigit(line[2]) ||
+            !isxdigit(line[3]) || line[4] != ' ' || line[5] != ' ')
+            continue;
+
+        line[strcspn(line, "\r\n")] = '\0';
+        if (num == cap)
+        {
+            cap = cap ? cap * 2 : 4096;
+            v = realloc(v, cap * sizeof(*v));
+            if (!v)
+                return 1;
+        }
+        v[num].vid = strtoul(line, &end, 16);
+        v[num].seq = num;
+        v[num].name = strdup(line + 6);
+        if (!v[num].name)
+            return 1;
+        num++;
+    }
+    fclose(in);
+
+    qsort(v, num, sizeof(*v), vendor_cmp);
+
+    /* Keep the first name of duplicate ids */
+    for (i = j = 0; i < num; i++)
+        if (j == 0 || v[i].vid != v[j - 1].vid)
+            v[j++] = v[i];
+    num = j;
+
+    out = fopen(argv[2], "wb");
+    if (!out)
+    {
+        perror(argv[2]);
+        return 1;
+    }
+
+    hdr.count = num;
+    fwrite(&hdr, sizeof(hdr), 1, out);
+
+    off = sizeof(hdr) + num * sizeof(struct vid_table_ent);
+    for (i = 0; i < num; i++)
+    {
+        struct vid_table_ent ent = { .vid = v[i].vid, .off = off };
+
+        fwrite(&ent, sizeof(ent), 1, out);
+        off += strlen(v[i].name) + 1;
+    }
+
+    for (i = 0; i < num; i++)
+        fwrite(v[i].name, strlen(v[i].name) + 1, 1, out);
+
+    if (fclose(out))
+    {
+        perror(argv[2]);
+        return 1;
+    }
+
+    return 0;
+}
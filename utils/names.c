@@ -15,40 +15,96 @@
 // SPDX-License-Identifier: GPL-2.0-only
 /*
  * Code based on usbutils: https://github.com/gregkh/usbutils
+ *
+ * Names are resolved on first use: hwdb is only opened when a name is
+ * actually asked for, and every answer, including "not found", is kept in a
+ * small hash table for the rest of the run. Hosts without hwdb can fall back
+ * to a vendor table generated from usb.ids at build time (see mkvidtable.c),
+ * which is mmapped and binary searched.
  */
 
 #include <libudev.h>
 #include <string.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "names.h"
+
+#ifndef NAMES_VID_TABLE
+#define NAMES_VID_TABLE "/usr/share/libtypec/usb-vendors.tbl"
+#endif
+
+#define NAMES_CACHE_SIZE 256
 
 static struct udev *udev = NULL;
 static struct udev_hwdb *hwdb = NULL;
+static int hwdb_tried;
+
+static const unsigned char *vid_table;
+static size_t vid_table_len;
+static int vid_table_tried;
+
+/* key: vid << 16 | pid for products, bit 32 set for vendors */
+static struct names_cache_entry {
+    uint64_t key;
+    char *name;
+    int used;
+} names_cache[NAMES_CACHE_SIZE];
 
 int names_init(void)
 {
-    udev = udev_new();
-    if (udev == NULL)
-    {
-        return -1;
-    }
-    hwdb = udev_hwdb_new(udev);
-    if (hwdb == NULL)
+    return 0;
+}
+
+void names_exit(void)
+{
+    int i;
+
+    for (i = 0; i < NAMES_CACHE_SIZE; i++)
     {
-        return -1;
+        free(names_cache[i].name);
+        names_cache[i].name = NULL;
+        names_cache[i].used = 0;
     }
 
-    return 0;
+    if (vid_table)
+        munmap((void *)vid_table, vid_table_len);
+    vid_table = NULL;
+    vid_table_tried = 0;
+
+    if (hwdb)
+        hwdb = udev_hwdb_unref(hwdb);
+    if (udev)
+        udev = udev_unref(udev);
+    hwdb_tried = 0;
 }
 
-void names_exit(void)
+static struct udev_hwdb *hwdb_open(void)
 {
-    hwdb = udev_hwdb_unref(hwdb);
-    udev = udev_unref(udev);
+    if (hwdb_tried)
+        return hwdb;
+
+    hwdb_tried = 1;
+    udev = udev_new();
+    if (udev == NULL)
+        return NULL;
+
+    hwdb = udev_hwdb_new(udev);
+
+    return hwdb;
 }
 
 static const char *hwdb_get(const char *modalias, const char *key)
 {
     struct udev_list_entry *entry;
+
+    if (!hwdb_open())
+        return NULL;
+
     udev_list_entry_foreach(entry, udev_hwdb_get_properties_list_entry(hwdb, modalias, 0))
     {
         if (strcmp(udev_list_entry_get_name(entry), key) == 0)
@@ -59,22 +115,142 @@ static const char *hwdb_get(const char *modalias, const char *key)
     return NULL;
 }
 
-const char *names_vendor(u_int16_t vendorid)
+static const struct vid_table_hdr *vid_table_open(void)
+{
+    const struct vid_table_hdr *hdr;
+    struct stat st;
+    void *map;
+    int fd;
+
+    if (vid_table_tried)
+        return (const struct vid_table_hdr *)vid_table;
+
+    vid_table_tried = 1;
+    fd = open(NAMES_VID_TABLE, O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        return NULL;
+
+    if (fstat(fd, &st) || (size_t)st.st_size < sizeof(*hdr))
+    {
+        close(fd);
+        return NULL;
+    }
+
+    map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED)
+        return NULL;
+
+    hdr = map;
+    if (memcmp(hdr->magic, VID_TABLE_MAGIC, sizeof(hdr->magic)) ||
+        hdr->version != VID_TABLE_VERSION ||
+        sizeof(*hdr) + (uint64_t)hdr->count * sizeof(struct vid_table_ent) > (uint64_t)st.st_size ||
+        ((const char *)map)[st.st_size - 1] != '\0')
+    {
+        munmap(map, st.st_size);
+        return NULL;
+    }
+
+    vid_table = map;
+    vid_table_len = st.st_size;
+
+    return hdr;
+}
+
+static const char *vid_table_get(uint16_t vid)
+{
+    const struct vid_table_hdr *hdr = vid_table_open();
+    const struct vid_table_ent *ent;
+    uint32_t lo = 0, hi;
+
+    if (!hdr)
+        return NULL;
+
+    ent = (const struct vid_table_ent *)(hdr + 1);
+    hi = hdr->count;
+    while (lo < hi)
+    {
+        uint32_t mid = lo + (hi - lo) / 2;
+
+        if (ent[mid].vid == vid)
+            return ent[mid].off < vid_table_len ? (const char *)vid_table + ent[mid].off : NULL;
+        if (ent[mid].vid < vid)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+
+    return NULL;
+}
+
+static struct names_cache_entry *names_cache_slot(uint64_t key)
+{
+    uint32_t h = (uint32_t)((key ^ (key >> 32)) * 2654435761u) >> 24;
+    int i;
+
+    for (i = 0; i < NAMES_CACHE_SIZE; i++)
+    {
+        struct names_cache_entry *e = &names_cache[(h + i) % NAMES_CACHE_SIZE];
+
+        if (!e->used || e->key == key)
+            return e;
+    }
+
+    return NULL;
+}
+
+static const char *names_lookup(uint64_t key, const char *(*resolve)(uint64_t key))
+{
+    struct names_cache_entry *e = names_cache_slot(key);
+    const char *name;
+
+    if (e && e->used)
+        return e->name;
+
+    name = resolve(key);
+    if (e)
+    {
+        e->used = 1;
+        e->key = key;
+        e->name = name ? strdup(name) : NULL;
+        return e->name;
+    }
+
+    /* Table full: answer uncached */
+    return name;
+}
+
+static const char *resolve_vendor(uint64_t key)
 {
     char modalias[64];
-    sprintf(modalias, "usb:v%04X*", vendorid);
-    return hwdb_get(modalias, "ID_VENDOR_FROM_DATABASE");
+    const char *name;
+    uint16_t vendorid = key >> 16;
+
+    snprintf(modalias, sizeof(modalias), "usb:v%04X*", vendorid);
+    name = hwdb_get(modalias, "ID_VENDOR_FROM_DATABASE");
+
+    return name ? name : vid_table_get(vendorid);
 }
 
-const char *names_product(u_int16_t vendorid, u_int16_t productid)
+static const char *resolve_product(uint64_t key)
 {
     char modalias[64];
 
-    sprintf(modalias, "usb:v%04Xp%04X*", vendorid, productid);
+    snprintf(modalias, sizeof(modalias), "usb:v%04Xp%04X*", (unsigned int)(key >> 16) & 0xffff, (unsigned int)key & 0xffff);
 
     return hwdb_get(modalias, "ID_MODEL_FROM_DATABASE");
 }
 
+const char *names_vendor(u_int16_t vendorid)
+{
+    return names_lookup(1ULL << 32 | (uint32_t)vendorid << 16, resolve_vendor);
+}
+
+const char *names_product(u_int16_t vendorid, u_int16_t productid)
+{
+    return names_lookup((uint32_t)vendorid << 16 | productid, resolve_product);
+}
+
 int get_vendor_string(char *buf, size_t size, u_int16_t vid)
 {
     const char *cp;
@@ -97,4 +273,4 @@ int get_product_string(char *buf, size_t size, u_int16_t vid, u_int16_t pid)
     if (!(cp = names_product(vid, pid)))
         return 0;
     return snprintf(buf, size, "%s", cp);
-}
\ No newline at end of file
+}
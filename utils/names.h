@@ -20,6 +20,29 @@
 #ifndef NAMES_H
 #define NAMES_H
 
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Vendor name table written by mkvidtable: header, count entries sorted by
+ * vid, then the NUL terminated names the entries point at (off is from the
+ * start of the file).
+ */
+#define VID_TABLE_MAGIC "TCVT"
+#define VID_TABLE_VERSION 1
+
+struct vid_table_hdr {
+    char magic[4];
+    uint32_t version;
+    uint32_t count;
+    uint32_t reserved;
+};
+
+struct vid_table_ent {
+    uint16_t vid;
+    uint16_t reserved;
+    uint32_t off;
+};
 
 int names_init(void);
 void names_exit(void);
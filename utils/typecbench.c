@@ -0,0 +1,212 @@
+/*
+MIT License
+
+Copyright (c) 2022 Rajaram Regupathy <rajaram.regupathy@gmail.com>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+// SPDX-License-Identifier: MIT
+/**
+ * @file typecbench.c
+ * @author Rajaram Regupathy <rajaram.regupathy@gmail.com>
+ * @brief Benchmark of bulk PDO and ID Header decoding against per object
+ *        decoding through the libtypec unions. Run with LIBTYPEC_BULK_SCALAR=1
+ *        to measure the scalar path of the bulk API.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <getopt.h>
+#include "../libtypec.h"
+
+struct pdo_rec {
+    uint8_t kind;
+    uint32_t min_mv, max_mv, max_ma, max_mw, flags;
+};
+
+static double now_s(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* A plausible mix of source capabilities: mostly fixed, some PPS and AVS */
+static uint32_t random_pdo(unsigned int *seed)
+{
+    static const uint32_t pdos[] = {
+        0x2701912c, 0x0002d12c, 0x0003c12c, 0x0004b12c, 0x000641f4,
+        0xc1a4213c, 0xc1a4215a, 0x9000a0c8, 0x0008c1f4, 0xd3c0968c,
+        0x6404b12c, 0x8fa0c8c8,
+    };
+
+    return pdos[rand_r(seed) % (sizeof(pdos) / sizeof(pdos[0]))] ^ (rand_r(seed) & 0x3);
+}
+
+static void decode_one_by_one(const uint32_t *pdo, size_t num, struct pdo_rec *rec)
+{
+    for (size_t i = 0; i < num; i++)
+    {
+        union libtypec_fixed_supply_src fxd = { .fixed_supply = pdo[i] };
+        union libtypec_variable_supply_src var = { .variable_supply = pdo[i] };
+        union libtypec_battery_supply_src bat = { .battery_supply = pdo[i] };
+        union libtypec_pps_src pps = { .spr_pps_supply = pdo[i] };
+        struct pdo_rec *r = &rec[i];
+
+        memset(r, 0, sizeof(*r));
+        r->kind = fxd.obj_fixed_sply.type;
+        switch (fxd.obj_fixed_sply.type)
+        {
+        case PDO_FIXED:
+            r->min_mv = r->max_mv = fxd.obj_fixed_sply.volt * 50;
+            r->max_ma = fxd.obj_fixed_sply.max_cur * 10;
+            r->max_mw = r->max_mv * r->max_ma / 1000;
+            break;
+        case PDO_BATTERY:
+            r->min_mv = bat.obj_bat_sply.min_volt * 50;
+            r->max_mv = bat.obj_bat_sply.max_volt * 50;
+            r->max_mw = bat.obj_bat_sply.max_pwr * 250;
+            break;
+        case PDO_VARIABLE:
+            r->min_mv = var.obj_var_sply.min_volt * 50;
+            r->max_mv = var.obj_var_sply.max_volt * 50;
+            r->max_ma = var.obj_var_sply.max_cur * 10;
+            r->max_mw = r->max_mv * r->max_ma / 1000;
+            break;
+        default:
+            r->kind += pps.obj_pps_sply.pps_type;
+            if (pps.obj_pps_sply.pps_type == APDO_SPR_PPS)
+            {
+                r->min_mv = pps.obj_pps_sply.min_volt * 100;
+                r->max_mv = pps.obj_pps_sply.max_volt * 100;
+                r->max_ma = pps.obj_pps_sply.max_cur * 50;
+                r->max_mw = r->max_mv * r->max_ma / 1000;
+                r->flags = pps.obj_pps_sply.pwr_ltd;
+            }
+            break;
+        }
+    }
+}
+
+static void report(const char *what, size_t num, int rounds, double secs, size_t bytes)
+{
+    printf("  %-28s %8.1f Mobj/s %8.2f GB/s\n", what, num * rounds / secs / 1e6,
+           (double)bytes * rounds / secs / 1e9);
+}
+
+int main(int argc, char **argv)
+{
+    size_t num = 16 << 20;
+    int rounds = 5, ret, r;
+    unsigned int seed = 1;
+    uint32_t *pdo;
+    struct pdo_rec *rec;
+    struct libtypec_pdo_soa soa;
+    struct libtypec_id_header_soa ids;
+    double t0;
+
+    static struct option options[] =
+    {
+        {"count", required_argument, 0, 'n'},
+        {"rounds", required_argument, 0, 'r'},
+        {0, 0, 0, 0}
+    };
+
+    while ((ret = getopt_long(argc, argv, "n:r:", options, NULL)) != -1)
+    {
+        if (ret == 'n')
+            num = strtoul(optarg, NULL, 10);
+        else if (ret == 'r')
+            rounds = atoi(optarg);
+        else
+        {
+            printf("typecbench - Benchmark bulk PDO/VDO decoding\n Usage:\t typecbench [--count objects] [--rounds n]\n");
+            return 1;
+        }
+    }
+
+    if (!num || rounds <= 0)
+        return 1;
+
+    pdo = malloc(num * sizeof(*pdo));
+    rec = malloc(num * sizeof(*rec));
+    soa.kind = malloc(num);
+    soa.min_mv = malloc(num * sizeof(uint32_t));
+    soa.max_mv = malloc(num * sizeof(uint32_t));
+    soa.max_ma = malloc(num * sizeof(uint32_t));
+    soa.max_mw = malloc(num * sizeof(uint32_t));
+    soa.flags = malloc(num * sizeof(uint32_t));
+    /* The ID Header pass reuses the PDO output buffers */
+    ids.vid = (uint16_t *)soa.min_mv;
+    ids.ufp_type = (uint8_t *)soa.max_mv;
+    ids.dfp_type = (uint8_t *)soa.max_ma;
+    ids.flags = soa.kind;
+
+    if (!pdo || !rec || !soa.kind || !soa.min_mv || !soa.max_mv || !soa.max_ma ||
+        !soa.max_mw || !soa.flags)
+    {
+        printf("Out of memory for %zu objects\n", num);
+        return 1;
+    }
+
+    for (size_t i = 0; i < num; i++)
+        pdo[i] = random_pdo(&seed);
+
+    /* Fault the outputs in so the first round is not measuring page faults */
+    memset(rec, 0, num * sizeof(*rec));
+    memset(soa.kind, 0, num);
+    memset(soa.min_mv, 0, num * sizeof(uint32_t));
+    memset(soa.max_mv, 0, num * sizeof(uint32_t));
+    memset(soa.max_ma, 0, num * sizeof(uint32_t));
+    memset(soa.max_mw, 0, num * sizeof(uint32_t));
+    memset(soa.flags, 0, num * sizeof(uint32_t));
+
+    printf("typecbench: %zu objects, %d rounds\n", num, rounds);
+
+    t0 = now_s();
+    for (r = 0; r < rounds; r++)
+        decode_one_by_one(pdo, num, rec);
+    report("PDO, per object (unions)", num, rounds, now_s() - t0, num * sizeof(uint32_t));
+
+    t0 = now_s();
+    for (r = 0; r < rounds; r++)
+        libtypec_decode_pdos(pdo, num, &soa);
+    report("PDO, libtypec_decode_pdos", num, rounds, now_s() - t0, num * sizeof(uint32_t));
+
+    t0 = now_s();
+    for (r = 0; r < rounds; r++)
+        libtypec_decode_id_headers(pdo, num, &ids);
+    report("ID Header, bulk", num, rounds, now_s() - t0, num * sizeof(uint32_t));
+
+    free(pdo);
+    free(rec);
+    free(soa.kind);
+    free(soa.min_mv);
+    free(soa.max_mv);
+    free(soa.max_ma);
+    free(soa.max_mw);
+    free(soa.flags);
+
+    return 0;
+}
@@ -0,0 +1,277 @@
+/*
+MIT License
+
+Copyright (c) 2022 Rajaram Regupathy <rajaram.regupathy@gmail.com>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+// SPDX-License-Identifier: MIT
+/**
+ * @file typecjournal.c
+ * @author Rajaram Regupathy <rajaram.regupathy@gmail.com>
+ * @brief Lists the connector state changes recorded in the libtypec journal
+ *        (see typecstatus --rb --journal) over a time range
+ */
+
+#define _XOPEN_SOURCE 700
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <getopt.h>
+#include "../libtypec.h"
+
+static const char *event_str[] = {
+    [USBC_DEVICE_CONNECTED] = "connected",
+    [USBC_DEVICE_DISCONNECTED] = "disconnected",
+    [USBC_EXT_SUPPLY_CHANGED] = "ext_supply_changed",
+    [USBC_POWER_OPMODE_CHANGED] = "power_opmode_changed",
+    [USBC_ATTENTION] = "attention",
+    [USBC_PROVIDER_CAPS_CHANGED] = "provider_caps_changed",
+    [USBC_POWER_LEVEL_CHANGED] = "power_level_changed",
+    [USBC_PD_RESET_COMPLETE] = "pd_reset_complete",
+    [USBC_CAM_CHANGED] = "cam_changed",
+    [USBC_BATTERY_STATUS_CHANGED] = "battery_status_changed",
+    [USBC_PARTNER_CHANGED] = "partner_changed",
+    [USBC_POWER_DIRECTION_CHANGED] = "power_direction_changed",
+    [USBC_SINK_PATH_CHANGED] = "sink_path_changed",
+    [USBC_CONNECTOR_ERROR] = "connector_error",
+    [USBC_ALERT] = "alert",
+    [USBC_ALERT_CLEARED] = "alert_cleared",
+};
+
+struct query {
+    int port;
+    int json;
+    int state;
+};
+
+static const char *event_name(int event)
+{
+    if (event >= 0 && event < (int)(sizeof(event_str) / sizeof(event_str[0])) && event_str[event])
+        return event_str[event];
+    return "unknown";
+}
+
+/*
+ * Times are "now", "@<epoch seconds>", "-<n>[smhd]" relative to now,
+ * "YYYY-MM-DD[ T]HH:MM[:SS]" or "HH:MM[:SS]" today, in local time
+ */
+static int parse_time(const char *s, uint64_t *ns)
+{
+    struct timespec ts;
+    time_t now, t;
+    struct tm tm;
+    const char *end;
+    char *e;
+
+    clock_gettime(CLOCK_REALTIME, &ts);
+    now = ts.tv_sec;
+
+    if (!strcmp(s, "now"))
+    {
+        *ns = (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+        return 0;
+    }
+
+    if (s[0] == '@')
+    {
+        double v = strtod(s + 1, &e);
+
+        if (e == s + 1 || *e || v < 0)
+            return -1;
+        *ns = v * 1e9;
+        return 0;
+    }
+
+    if (s[0] == '-')
+    {
+        unsigned long v = strtoul(s + 1, &e, 10);
+        unsigned long unit = 1;
+
+        switch (*e)
+        {
+        case 'd': unit = 86400; e++; break;
+        case 'h': unit = 3600; e++; break;
+        case 'm': unit = 60; e++; break;
+        case 's': e++; break;
+        case 0: break;
+        default: return -1;
+        }
+        if (e == s + 1 || *e || v * unit > (unsigned long)now)
+            return -1;
+        *ns = (uint64_t)(now - v * unit) * 1000000000ull + ts.tv_nsec;
+        return 0;
+    }
+
+    localtime_r(&now, &tm);
+    tm.tm_sec = 0;
+    if (!(end = strptime(s, "%Y-%m-%d %H:%M", &tm)) && !(end = strptime(s, "%Y-%m-%dT%H:%M", &tm)))
+    {
+        localtime_r(&now, &tm);
+        tm.tm_sec = 0;
+        if (!(end = strptime(s, "%H:%M", &tm)))
+            return -1;
+    }
+    if (*end == ':' && !(end = strptime(end + 1, "%S", &tm)))
+        return -1;
+    if (*end)
+        return -1;
+
+    tm.tm_isdst = -1;
+    t = mktime(&tm);
+    if (t == (time_t)-1)
+        return -1;
+
+    *ns = (uint64_t)t * 1000000000ull;
+    return 0;
+}
+
+static void print_fields(const struct libtypec_journal_entry *e, uint32_t mask, int json)
+{
+    int first = 1;
+
+    for (int f = 0; f < LIBTYPEC_FIELD_STATUS_COUNT; f++)
+    {
+        const char *name;
+
+        if (!(mask & (1u << f)))
+            continue;
+
+        name = libtypec_snapshot_field_name(LIBTYPEC_SNAP_REC_PORT_STATUS, f);
+        if (json)
+            printf("%s\"%s\":%u", first ? "" : ",", name, e->value[f]);
+        else if (f == LIBTYPEC_FIELD_STATUS_RDO || f == LIBTYPEC_FIELD_STATUS_PD_VERSION ||
+                 f == LIBTYPEC_FIELD_STATUS_PARTNER_FLAGS)
+            printf(" %s=0x%x", name, e->value[f]);
+        else
+            printf(" %s=%u", name, e->value[f]);
+        first = 0;
+    }
+}
+
+static int print_entry(const struct libtypec_journal_entry *e, void *data)
+{
+    const struct query *q = data;
+    time_t t = e->ts_ns / 1000000000ull;
+    char buf[32];
+    struct tm tm;
+
+    if (q->port >= 0 && e->conn_num != q->port)
+        return 0;
+
+    if (q->json)
+    {
+        printf("{\"timestamp_ns\":%llu,\"port\":%d,\"event\":\"%s\"",
+               (unsigned long long)e->ts_ns, e->conn_num, event_name(e->event));
+        if (e->event == USBC_ALERT || e->event == USBC_ALERT_CLEARED)
+            printf(",\"alert_id\":%d,\"alert_value\":%d", e->alert_id, e->alert_value);
+        printf(",\"changed\":{");
+        print_fields(e, e->changed, 1);
+        if (q->state)
+        {
+            printf("},\"state\":{");
+            print_fields(e, e->known, 1);
+        }
+        printf("}}\n");
+        return 0;
+    }
+
+    localtime_r(&t, &tm);
+    strftime(buf, sizeof(buf), "%Y-%m-%d %H:%M:%S", &tm);
+    printf("%s.%06u ", buf, (unsigned int)(e->ts_ns % 1000000000ull / 1000));
+    if (e->conn_num >= 0)
+        printf("port%d ", e->conn_num);
+    printf("%s", event_name(e->event));
+    if (e->event == USBC_ALERT || e->event == USBC_ALERT_CLEARED)
+        printf(" id=%d value=%d", e->alert_id, e->alert_value);
+    print_fields(e, q->state ? e->known : e->changed, 0);
+    printf("\n");
+
+    return 0;
+}
+
+static void usage(void)
+{
+    printf("typecjournal - List connector state changes recorded by libtypec\n"
+           " Usage:\t typecjournal [--file path] [--since time] [--until time] [--port num] [--state] [--json]\n"
+           "\t--since, --until\t now, @epoch, -N[smhd], [YYYY-MM-DD ]HH:MM[:SS]\n"
+           "\t--state\t\t show the whole known state, not only what changed\n");
+}
+
+int main(int argc, char *argv[])
+{
+    const char *path = NULL;
+    uint64_t from_ns = 0, to_ns = UINT64_MAX;
+    struct query q = { .port = -1 };
+    int ret;
+
+    static struct option options[] =
+    {
+        {"file", required_argument, 0, 'f'},
+        {"since", required_argument, 0, 's'},
+        {"until", required_argument, 0, 'u'},
+        {"port", required_argument, 0, 'p'},
+        {"state", no_argument, 0, 'S'},
+        {"json", no_argument, 0, 'j'},
+        {"help", no_argument, 0, 'h'},
+        {0, 0, 0, 0}
+    };
+
+    while ((ret = getopt_long(argc, argv, "f:s:u:p:Sjh", options, NULL)) != -1)
+    {
+        switch (ret)
+        {
+        case 'f':
+            path = optarg;
+            break;
+        case 's':
+        case 'u':
+            if (parse_time(optarg, ret == 's' ? &from_ns : &to_ns) < 0)
+            {
+                printf("Invalid time %s\n", optarg);
+                return 1;
+            }
+            break;
+        case 'p':
+            q.port = atoi(optarg);
+            break;
+        case 'S':
+            q.state = 1;
+            break;
+        case 'j':
+            q.json = 1;
+            break;
+        default:
+            usage();
+            return ret == 'h' ? 0 : 1;
+        }
+    }
+
+    ret = libtypec_journal_query(path, from_ns, to_ns, print_entry, &q);
+    if (ret < 0)
+    {
+        printf("Unable to read journal %s: %s\n", path ? path : LIBTYPEC_JOURNAL_FILE, strerror(-ret));
+        return 1;
+    }
+
+    return 0;
+}
@@ -34,6 +34,12 @@ SOFTWARE.
 #include <fcntl.h>
 #include <unistd.h>
 #include <stdio.h>
+#include <string.h>
+#include <signal.h>
+#include <time.h>
+#include <stdarg.h>
+#include <syslog.h>
+#include <pthread.h>
 #include <getopt.h>
 #include "libtypec.h"
 #include <stdlib.h>
@@ -107,6 +113,20 @@ static unsigned long get_dword_from_path(char *path)
 	return dword;
 }
 
+static char *bmconf_str_array[]= {"Unspecified Error","AUM not attempted","AUM attempt unsuccessful","AUM configuration successful"};
+
+#define BB_AUM_CONFIGURED 3
+
+/* bmConfig holds two state bits per alternate mode, four modes per byte */
+static int bb_aum_state(struct bb_bos_descritor *bb_bos_desc, int x, unsigned int *svid)
+{
+    unsigned char *aum = &bb_bos_desc->cap_desc_aum_array_start + (x*4);
+
+    *svid = (aum[1] << 8) | aum[0];
+
+    return (bb_bos_desc->cap_desc_bmconfig[x / 4] >> ((x % 4) * 2)) & 0x3;
+}
+
 int typec_status_billboard()
 {
         int ret;
@@ -144,30 +164,10 @@ int typec_status_billboard()
 
                     for(int x=0;x<bb_bos_desc->cap_desc_num_aum;x++)
                     {
-                        int idx = 0, k=0, j=0;
-                        #define bmCONF_STR_ARR_MAX 4
-
-                        char *bmconf_str_array[]= {"Unspecified Error","AUM not attempted","AUM attempt unsuccessful","AUM configuration successful","Undefined Configuration"};
-
-                        if( (x !=0) && ((x % 4) == 0))
-                        {
-                            j++;
-                            k=0;
-                        }
-
-                        idx = bb_bos_desc->cap_desc_bmconfig[j];
-
-                        idx = (idx >> k) & 0x3;
-
-                        k++;
+                        unsigned int svid;
+                        int idx = bb_aum_state(bb_bos_desc, x, &svid);
 
-                        idx =  idx < bmCONF_STR_ARR_MAX ? idx : bmCONF_STR_ARR_MAX;
-
-                        unsigned char *aum = &bb_bos_desc->cap_desc_aum_array_start;
-
-                        aum = aum + (x*4);
-
-                        printf("\tAlternate Mode 0x%02X%02X in state :  %s\n",aum[1]&0xFF,aum[0]&0xFF,bmconf_str_array[idx]);
+                        printf("\tAlternate Mode 0x%04X in state :  %s\n",svid,bmconf_str_array[idx]);
                     }
                 }
             }
@@ -178,7 +178,8 @@ int typec_status_billboard()
 int typecstatus_power_contract()
 {
        unsigned long tdp, bst_pwr;
-       int ret;
+       int ret, energy_ok;
+       struct libtypec_energy energy;
         struct libtypec_capability_data get_cap_data;
 
         // PPM Capabilities
@@ -189,6 +190,14 @@ int typecstatus_power_contract()
         else {
 
 
+            /* Counters are accumulated by a running typecstatus --rb */
+            energy_ok = libtypec_energy_open(NULL, 0) == 0;
+
+            /* Package power limits are system wide, read them once */
+            tdp = get_dword_from_path("/sys/class/powercap/intel-rapl:0/constraint_0_power_limit_uw")/1000000;
+
+            bst_pwr = get_dword_from_path("/sys/class/powercap/intel-rapl:0/constraint_1_power_limit_uw")/1000000;
+
             printf("USB-C Power Status\n==================\n");
             printf("Number of USB-C port(s): %d\n======================\n",get_cap_data.bNumConnectors);
 
@@ -201,31 +210,460 @@ int typecstatus_power_contract()
 
                     printf("\tUSB-C power contract Operating Power %d W, with Max Power %d W\n",(((conn_sts.RequestDataObject >>10)&0x3ff) * 250)/1000,((conn_sts.RequestDataObject &0x3ff) * 250)/1000);
 
-                    tdp = get_dword_from_path("/sys/class/powercap/intel-rapl:0/constraint_0_power_limit_uw")/1000000;
-
-                    bst_pwr = get_dword_from_path("/sys/class/powercap/intel-rapl:0/constraint_1_power_limit_uw")/1000000;
-
                     printf("\tCharging System with TDP %ld W, with boost power requirement of %ld W\n",tdp,bst_pwr);
                 }
                 else
                     printf("\tNo Power Contract on port %d\n",i);        
+
+                if(energy_ok && libtypec_energy_get_port(i, &energy) == 0)
+                    printf("\tEnergy delivered %.3f Wh, received %.3f Wh\n", energy.delivered_uj / 3.6e9, energy.received_uj / 3.6e9);
             }
+
+            libtypec_energy_close();
         }
 	return 0;
 }
 
+/*
+ * Charging efficiency sampler for --rb --interval: RAPL energy counters and USB-C
+ * input power are sampled together, system draw is compared against the
+ * negotiated input and under-powered charger episodes are reported.
+ */
+#define RAPL_PATH "/sys/class/powercap"
+#define RAPL_MAX_DOMAINS 8
+#define RB_MAX_PORTS 32
+#define RB_EPISODE_SAMPLES 3	/* consecutive deficit samples to open an episode */
+#define RB_CONTRACT_REFRESH 10	/* samples between connector status reads */
+#define RB_ENERGY_PERIOD_MS 1000	/* telemetry period for energy accounting */
+
+struct rapl_domain {
+    int fd;
+    unsigned long long max_uj;
+    unsigned long long last_uj;
+};
+
+static struct rapl_domain rapl[RAPL_MAX_DOMAINS];
+static int num_rapl;
+static volatile sig_atomic_t rb_stop;
+
+static int read_ull_fd(int fd, unsigned long long *val)
+{
+    char buf[32];
+    ssize_t len = pread(fd, buf, sizeof(buf) - 1, 0);
+
+    if (len <= 0)
+        return -1;
+
+    buf[len] = '\0';
+    *val = strtoull(buf, NULL, 10);
+
+    return 0;
+}
+
+static int rapl_open_domain(int idx)
+{
+    char path[128];
+    struct rapl_domain *d = &rapl[num_rapl];
+    int max_fd, ret;
+
+    snprintf(path, sizeof(path), RAPL_PATH "/intel-rapl:%d/max_energy_range_uj", idx);
+    max_fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (max_fd < 0)
+        return -1;
+    ret = read_ull_fd(max_fd, &d->max_uj);
+    close(max_fd);
+
+    snprintf(path, sizeof(path), RAPL_PATH "/intel-rapl:%d/energy_uj", idx);
+    d->fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (d->fd < 0)
+        return -1;
+
+    /* energy_uj is root only on recent kernels, open() alone does not tell */
+    if (ret < 0 || read_ull_fd(d->fd, &d->last_uj) < 0)
+    {
+        close(d->fd);
+        return -1;
+    }
+
+    num_rapl++;
+    return 0;
+}
+
+/*
+ * Use the platform (psys) domain when present since it covers the whole
+ * system; otherwise sum the top level package domains.
+ */
+static int rapl_open(void)
+{
+    char path[128], name[32];
+    int i, num_domains;
+
+    for (i = 0; i < RAPL_MAX_DOMAINS; i++)
+    {
+        FILE *fp;
+        int psys;
+
+        snprintf(path, sizeof(path), RAPL_PATH "/intel-rapl:%d/name", i);
+        fp = fopen(path, "r");
+        if (fp == NULL)
+            break;
+
+        psys = fgets(name, sizeof(name), fp) && !strncmp(name, "psys", 4);
+        fclose(fp);
+
+        if (psys && rapl_open_domain(i) == 0)
+            return num_rapl;
+    }
+    num_domains = i;
+
+    for (i = 0; i < num_domains; i++)
+        rapl_open_domain(i);
+
+    return num_rapl;
+}
+
+/* Energy in uJ since the previous call, across all open domains */
+static unsigned long long rapl_delta_uj(void)
+{
+    unsigned long long total = 0, now;
+    int i;
+
+    for (i = 0; i < num_rapl; i++)
+    {
+        if (read_ull_fd(rapl[i].fd, &now) < 0)
+            continue;
+
+        /* The counter wraps at max_energy_range_uj */
+        total += now >= rapl[i].last_uj ? now - rapl[i].last_uj : rapl[i].max_uj - rapl[i].last_uj + now;
+        rapl[i].last_uj = now;
+    }
+
+    return total;
+}
+
+static void rb_signal(int sig)
+{
+    rb_stop = 1;
+}
+
+static double ts_diff(const struct timespec *a, const struct timespec *b)
+{
+    return (a->tv_sec - b->tv_sec) + (a->tv_nsec - b->tv_nsec) / 1e9;
+}
+
+int typecstatus_efficiency(unsigned int interval_ms)
+{
+    struct libtypec_connector_status sts;
+    struct libtypec_capability_data get_cap_data;
+    struct timespec start, next, prev, now;
+    double contract_w[RB_MAX_PORTS] = {0};
+    double sys_j = 0, in_j = 0, episode_s = 0, episode_peak = 0, total_episode_s = 0;
+    unsigned long samples = 0;
+    int num_ports, deficit_run = 0, in_episode = 0, episodes = 0;
+
+    if (libtypec_get_capability(&get_cap_data) < 0)
+    {
+        printf("Unable to read typec capabilities\n");
+        return -1;
+    }
+
+    num_ports = get_cap_data.bNumConnectors < RB_MAX_PORTS ? get_cap_data.bNumConnectors : RB_MAX_PORTS;
+
+    if (!rapl_open())
+        printf("RAPL energy counters not readable, reporting USB-C input only\n");
+
+    signal(SIGINT, rb_signal);
+    signal(SIGTERM, rb_signal);
+
+    printf("Monitoring %d USB-C port(s) every %u ms\n", num_ports, interval_ms);
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    prev = next = start;
+
+    while (!rb_stop)
+    {
+        double dt, sys_w, in_w = 0, nego_w = 0;
+        int i;
+
+        next.tv_nsec += (long)interval_ms * 1000000;
+        next.tv_sec += next.tv_nsec / 1000000000;
+        next.tv_nsec %= 1000000000;
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, NULL);
+
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        dt = ts_diff(&now, &prev);
+        prev = now;
+        if (dt <= 0)
+            continue;
+
+        sys_w = num_rapl ? rapl_delta_uj() / 1e6 / dt : 0;
+
+        for (i = 0; i < num_ports; i++)
+        {
+            struct libtypec_power_sample ps;
+
+            /* The contract changes rarely, the live reading every sample */
+            if (samples % RB_CONTRACT_REFRESH == 0)
+            {
+                if (libtypec_get_connector_status(i, &sts) >= 0 && sts.ConnectStatus && !sts.PowerDirection)
+                    contract_w[i] = ((sts.RequestDataObject >> 10) & 0x3ff) * 250 / 1000.0;
+                else
+                    contract_w[i] = 0;
+            }
+
+            if (libtypec_get_power_sample(i, &ps) == 0 && ps.connected && !ps.sourcing)
+                in_w += ps.voltage_mv * (double)ps.current_ma / 1e6;
+
+            nego_w += contract_w[i];
+        }
+        samples++;
+
+        sys_j += sys_w * dt;
+        in_j += in_w * dt;
+
+        /* Charging from USB-C but drawing more than the charger agreed to give */
+        if (nego_w > 0 && num_rapl && sys_w > nego_w)
+        {
+            if (++deficit_run == RB_EPISODE_SAMPLES)
+            {
+                in_episode = 1;
+                episode_s = 0;
+                episode_peak = 0;
+                episodes++;
+                printf("[%.1f] under-powered: system %.1f W > contract %.1f W\n", ts_diff(&now, &start), sys_w, nego_w);
+            }
+            if (in_episode)
+            {
+                episode_s += dt;
+                if (sys_w - nego_w > episode_peak)
+                    episode_peak = sys_w - nego_w;
+            }
+        }
+        else
+        {
+            if (in_episode)
+            {
+                printf("[%.1f] under-powered episode over after %.1f s, peak deficit %.1f W\n", ts_diff(&now, &start), episode_s, episode_peak);
+                total_episode_s += episode_s;
+            }
+            deficit_run = 0;
+            in_episode = 0;
+        }
+
+        if (samples % (interval_ms >= 1000 ? 1 : 1000 / interval_ms) == 0)
+            printf("[%.1f] system %.2f W input %.2f W contract %.1f W headroom %.1f W\n",
+                   ts_diff(&now, &start), sys_w, in_w, nego_w, nego_w - sys_w);
+    }
+
+    if (in_episode)
+        total_episode_s += episode_s;
+
+    printf("\n%lu samples over %.1f s: system %.1f Wh, USB-C input %.1f Wh, %d under-powered episode(s) totalling %.1f s\n",
+           samples, ts_diff(&prev, &start), sys_j / 3600, in_j / 3600, episodes, total_episode_s);
+
+    while (num_rapl)
+        close(rapl[--num_rapl].fd);
+
+    return 0;
+}
+
+/*
+ * Event driven background monitor. It sleeps in the library event monitor
+ * and re-evaluates only the connector an event names, printing a line only
+ * when something a user cares about changed.
+ */
+struct rb_port {
+    int valid;
+    int connected;
+    unsigned int rdo;
+};
+
+static struct rb_port rb_ports[RB_MAX_PORTS];
+static int rb_num_ports;
+static int syslog_flag;
+static char rb_bb_failures[512];
+
+static void rb_notify(const char *fmt, ...)
+{
+    va_list ap;
+
+    va_start(ap, fmt);
+    if (syslog_flag)
+        vsyslog(LOG_NOTICE, fmt, ap);
+    else
+    {
+        struct timespec now;
+
+        clock_gettime(CLOCK_REALTIME, &now);
+        printf("[%lld] ", (long long)now.tv_sec);
+        vprintf(fmt, ap);
+        putchar('\n');
+    }
+    va_end(ap);
+}
+
+static void rb_eval_port(int i)
+{
+    struct libtypec_connector_status sts;
+    struct rb_port *p = &rb_ports[i];
+    unsigned int rdo;
+
+    if (libtypec_get_connector_status(i, &sts) < 0)
+        return;
+
+    rdo = sts.ConnectStatus ? sts.RequestDataObject : 0;
+
+    if (!p->valid || p->connected != sts.ConnectStatus)
+        rb_notify("port%d: partner %s", i, sts.ConnectStatus ? "attached" : "detached");
+
+    if ((!p->valid && rdo) || (p->valid && p->rdo != rdo))
+    {
+        if (rdo)
+            rb_notify("port%d: contract %d W, max %d W", i, (((rdo >> 10) & 0x3ff) * 250) / 1000, ((rdo & 0x3ff) * 250) / 1000);
+        else if (sts.ConnectStatus)
+            rb_notify("port%d: no power contract", i);
+    }
+
+    p->valid = 1;
+    p->connected = sts.ConnectStatus;
+    p->rdo = rdo;
+}
+
+/* Report billboard alternate modes that did not configure, on change only */
+static void rb_eval_billboard(void)
+{
+    char bb_data[512], failures[sizeof(rb_bb_failures)] = "";
+    unsigned int num_bb = 0;
+    size_t len = 0;
+
+    if (libtypec_get_bb_status(&num_bb) < 0)
+        num_bb = 0;
+
+    for (unsigned int i = 1; i <= num_bb; i++)
+    {
+        int ret = libtypec_get_bb_data(i, bb_data);
+        int bb_loc;
+
+        if (ret < 0 || (bb_loc = find_bb_bos_index(bb_data, ret)) <= 0)
+            continue;
+
+        struct bb_bos_descritor *bb_bos_desc = (struct bb_bos_descritor *)&bb_data[bb_loc];
+
+        for (int x = 0; x < bb_bos_desc->cap_desc_num_aum && len < sizeof(failures); x++)
+        {
+            unsigned int svid;
+            int idx = bb_aum_state(bb_bos_desc, x, &svid);
+
+            if (idx != BB_AUM_CONFIGURED)
+                len += snprintf(failures + len, sizeof(failures) - len, " bb%u:0x%04X %s", i, svid, bmconf_str_array[idx]);
+        }
+    }
+
+    if (strcmp(failures, rb_bb_failures))
+    {
+        if (failures[0])
+            rb_notify("billboard:%s", failures);
+        else if (rb_bb_failures[0])
+            rb_notify("billboard: all alternate modes configured");
+        snprintf(rb_bb_failures, sizeof(rb_bb_failures), "%s", failures);
+    }
+}
+
+static void rb_event_cb(enum usb_typec_event event, void *data)
+{
+    struct libtypec_event_info info;
+
+    if (libtypec_get_event_info(&info) == 0 && info.conn_num >= 0 && info.conn_num < rb_num_ports)
+        rb_eval_port(info.conn_num);
+    else
+        for (int i = 0; i < rb_num_ports; i++)
+            rb_eval_port(i);
+
+    /* A partner that failed to enter its modes exposes a billboard */
+    if (event == USBC_DEVICE_CONNECTED || event == USBC_DEVICE_DISCONNECTED)
+        rb_eval_billboard();
+}
+
+static void *rb_monitor_thread(void *arg)
+{
+    libtypec_monitor_events();
+    return NULL;
+}
+
+int typecstatus_background(unsigned int interval_ms)
+{
+    static const enum usb_typec_event rb_events[] = {
+        USBC_DEVICE_CONNECTED, USBC_DEVICE_DISCONNECTED, USBC_POWER_OPMODE_CHANGED,
+        USBC_PROVIDER_CAPS_CHANGED, USBC_POWER_LEVEL_CHANGED, USBC_PARTNER_CHANGED,
+        USBC_POWER_DIRECTION_CHANGED,
+    };
+    struct libtypec_capability_data get_cap_data;
+    pthread_t monitor;
+    int ret;
+
+    if (libtypec_get_capability(&get_cap_data) < 0)
+    {
+        printf("Unable to read typec capabilities\n");
+        return -1;
+    }
+
+    rb_num_ports = get_cap_data.bNumConnectors < RB_MAX_PORTS ? get_cap_data.bNumConnectors : RB_MAX_PORTS;
+
+    if (syslog_flag)
+        openlog("typecstatus", LOG_PID, LOG_DAEMON);
+    else
+        setvbuf(stdout, NULL, _IOLBF, 0);
+
+    for (unsigned int i = 0; i < sizeof(rb_events) / sizeof(rb_events[0]); i++)
+        libtypec_register_typec_notification_callback(rb_events[i], rb_event_cb, NULL);
+
+    /* Accumulate the energy counters that --ro prints */
+    ret = libtypec_energy_open(NULL, 1);
+    if (ret == 0)
+        ret = libtypec_telemetry_start(rb_num_ports < 32 ? (1u << rb_num_ports) - 1 : ~0u,
+                                       RB_ENERGY_PERIOD_MS * 1000);
+    if (ret < 0)
+        rb_notify("energy accounting not running: %s", strerror(-ret));
+
+    /* Baseline, then report changes only */
+    for (int i = 0; i < rb_num_ports; i++)
+        rb_eval_port(i);
+    rb_eval_billboard();
+
+    if (!interval_ms)
+    {
+        libtypec_monitor_events();
+        return 0;
+    }
+
+    if (pthread_create(&monitor, NULL, rb_monitor_thread, NULL))
+    {
+        printf("Unable to start event monitor\n");
+        return -1;
+    }
+    pthread_detach(monitor);
+
+    return typecstatus_efficiency(interval_ms);
+}
+
 /* Check all typec ports */
 static int ro_flag;
+static int rb_flag;
 char *session_info[LIBTYPEC_SESSION_MAX_INDEX];
 
 int main (int argc, char **argv)
 {
     int ret,index=0;
+    unsigned int interval_ms = 0;
+    const char *journal = NULL;
 
     if(argc == 1)
     {
-	    printf("typecstatus - Check status of typec ports\n Usage:\t typecstatus --ro | --rb \n\
-        --ro\t Run once to gather typec port status \n\t--rb\t Run as background and notify\n");
+	    printf("typecstatus - Check status of typec ports\n Usage:\t typecstatus --ro | --rb [--syslog] [--interval ms] [--journal path]\n\
+        --ro\t Run once to gather typec port status \n\t--rb\t Run as background, notify and account energy\n\
+        --syslog\t Send background notifications to syslog/journald\n\
+        --interval\t Also sample RAPL and USB-C input power every ms\n\
+        --journal\t Record state changes to a journal file, read with typecjournal\n");
         exit(0);
     }
 
@@ -233,12 +671,22 @@ int main (int argc, char **argv)
     {
         /* These options set a flag. */
         {"ro", no_argument,&ro_flag, 1},
+        {"rb", no_argument,&rb_flag, 1},
+        {"syslog", no_argument,&syslog_flag, 1},
+        {"interval", required_argument, 0, 'i'},
+        {"journal", required_argument, 0, 'j'},
+        {0, 0, 0, 0}
     };
 
-    ret = getopt_long (argc, argv, "", options, &index);
-
-    if(ret != 0)    
-        printf("typecstatus - Check status of typec ports\n Usage:\t typecstatus --all \n");
+    while ((ret = getopt_long (argc, argv, "", options, &index)) != -1)
+    {
+        if (ret == 'i')
+            interval_ms = strtoul(optarg, NULL, 10);
+        else if (ret == 'j')
+            journal = optarg;
+        else if (ret != 0)
+            printf("typecstatus - Check status of typec ports\n Usage:\t typecstatus --ro | --rb [--syslog] [--interval ms] [--journal path]\n");
+    }
 
     names_init();
 
@@ -257,6 +705,18 @@ int main (int argc, char **argv)
         typec_status_billboard();
 
     }
+    else if(rb_flag)
+    {
+        if (journal && (ret = libtypec_journal_open(journal, 0)) < 0)
+            printf("Unable to open journal %s: %s\n", journal, strerror(-ret));
+
+        typecstatus_background(interval_ms);
+
+        libtypec_telemetry_stop();
+        libtypec_energy_close();
+    }
+
+    libtypec_exit();
     names_exit();
 
 }
@@ -460,6 +460,7 @@ void ucsicontrol_print(const char *ucsictrl)
 	printf("  --set_new_cam <conn_num> <Entry/Exit>\n");
 	printf("				<NewCAM> <AMSpec>\n		Set New Current Alternate Mode\n");
 	printf("  --get_cam_cs <conn_num> <cam>         Get Current Alt mode Configuration and Status\n");
+	printf("  --broker                              Serve UCSI commands for other libtypec clients\n");
 }
 int main(int argc, char *argv[])
 {
@@ -484,6 +485,7 @@ int main(int argc, char *argv[])
 		{"set_ccom", required_argument, NULL, 'q'},
 		{"set_new_cam", required_argument, NULL, 'w'},
 		{"get_cam_cs", required_argument, NULL, 'x'},
+		{"broker", no_argument, NULL, 'b'},
     	{NULL, 0, NULL, 0} // End of options marker
 	};
 
@@ -495,7 +497,7 @@ int main(int argc, char *argv[])
         return -1;
     }
 
-	while ((c = getopt_long(argc, argv, "htgcspradoelmqwx", long_options, &option_index)) != -1) {
+	while ((c = getopt_long(argc, argv, "htgcspradoelmqwxb", long_options, &option_index)) != -1) {
         switch (c) {
             case 'h':
                 ucsicontrol_print(argv[0]);
@@ -727,6 +729,11 @@ int main(int argc, char *argv[])
 				print_get_cam_cs(&cam_cs);
  				return 0;
 
+			case 'b':
+				ret = libtypec_run_cmd_broker();
+				printf("UCSI command broker exited: %d\n", ret);
+				return -1;
+
             default:
                 ucsicontrol_print(argv[0]);
                 return 0;
@@ -49,27 +49,25 @@ GtkTreeStore *create_tree_store() {
 
   return store;
 }
-void build_vdo(uint32_t vdo, int num_fields, const struct vdo_field vdo_fields[], const char *vdo_field_desc[][MAX_FIELDS])
+void build_vdo(uint32_t vdo, enum libtypec_vdo_layout layout)
 {
   char val[1024];
-  for (int i = 0; i < num_fields; i++) {
-    if (!vdo_fields[i].print)
-      continue;
+  struct libtypec_vdo_field field[LIBTYPEC_VDO_MAX_FIELDS];
+  int num_fields = libtypec_decode_vdo(layout, vdo, field, LIBTYPEC_VDO_MAX_FIELDS);
 
-    uint32_t field = (vdo >> vdo_fields[i].index) & vdo_fields[i].mask;
-    sprintf(val,"      %s: %*d", vdo_fields[i].name, FIELD_WIDTH(MAX_FIELD_LENGTH - ((int) strlen(vdo_fields[i].name))), ((vdo >> vdo_fields[i].index) & vdo_fields[i].mask));
+  for (int i = 0; i < num_fields; i++) {
+    sprintf(val,"      %s: %*d", field[i].name, FIELD_WIDTH(MAX_FIELD_LENGTH - field[i].name_len), field[i].raw);
     gtk_text_buffer_insert_at_cursor(txt_buffer, val,strlen(val));
 
-    if (vdo_field_desc[i][0] != NULL) {
+    if (field[i].desc) {
       // decode field
-      sprintf(val," (%s)\n", vdo_field_desc[i][field]);
+      sprintf(val," (%s)\n", field[i].desc);
       gtk_text_buffer_insert_at_cursor(txt_buffer, val,strlen(val));
 
-    } else if (strcmp(vdo_fields[i].name, "USB Vendor ID")  == 0) {
+    } else if (field[i].flags & LIBTYPEC_VDO_FIELD_VID) {
       // decode vendor id
        char vendor_str[128];
-       uint16_t svid = ((vdo >> vdo_fields[i].index) & vdo_fields[i].mask);
-       get_vendor_string(vendor_str, sizeof(vendor_str), svid);
+       get_vendor_string(vendor_str, sizeof(vendor_str), field[i].raw);
       sprintf(val," (%s)\n", (vendor_str[0] == '\0' ? "unknown" : vendor_str));
       gtk_text_buffer_insert_at_cursor(txt_buffer, val,strlen(val));
 
@@ -100,7 +98,7 @@ void build_conn_capability(struct libtypec_connector_cap_data conn_data)
   gtk_text_buffer_insert_at_cursor(txt_buffer, val,strlen(val));
 
 }
-void get_svid_string(uint32_t svid, char* str) {
+void get_svid_string(uint32_t svid, char* str, size_t size) {
 
     switch (svid) {
         case 0xFF01:
@@ -110,19 +108,21 @@ void get_svid_string(uint32_t svid, char* str) {
             strcpy(str, "TBT Alternate Mode");
             break;
         default:
-            get_vendor_string(str, sizeof(str), svid);
+            get_vendor_string(str, size, svid);
             break;
     }
 }
 
-void  build_alternate_mode_data(int recipient, uint32_t id_header, int num_modes, struct altmode_data *am_data)
+static struct altmode_data am_buf[LIBTYPEC_MAX_ALTMODES_LEGACY];
+
+void  build_alternate_mode_data(int recipient, uint32_t id_header, int num_modes, const struct altmode_data *am_data)
 {
   char vendor_id[128];
   char val[512];
 
   if (recipient == AM_CONNECTOR) {
     for (int i = 0; i < num_modes; i++) {
-      get_svid_string(am_data[i].svid,vendor_id);
+      get_svid_string(am_data[i].svid, vendor_id, sizeof(vendor_id));
       sprintf(val,"  Local Mode %d:\n", i);
       gtk_text_buffer_insert_at_cursor(txt_buffer, val,strlen(val));
 
@@ -134,10 +134,10 @@ void  build_alternate_mode_data(int recipient, uint32_t id_header, int num_modes
 
       switch(am_data[i].svid){
         case 0x8087:
-          build_vdo(am_data[i].vdo, 7, tbt3_sop_fields, tbt3_sop_field_desc);
+          build_vdo(am_data[i].vdo, LIBTYPEC_VDO_TBT3_SOP);
           break;
         case 0xff01:
-          build_vdo(am_data[i].vdo, 7, dp_alt_mode_partner_fields, dp_alt_mode_partner_field_desc);
+          build_vdo(am_data[i].vdo, LIBTYPEC_VDO_DP_ALT_MODE_PARTNER);
           break;
         default:
           get_vendor_string(vendor_id, sizeof(vendor_id), am_data[i].svid);
@@ -150,7 +150,7 @@ void  build_alternate_mode_data(int recipient, uint32_t id_header, int num_modes
 
   if (recipient == AM_SOP) {
     for (int i = 0; i < num_modes; i++) {
-      get_svid_string(am_data[i].svid,vendor_id);
+      get_svid_string(am_data[i].svid, vendor_id, sizeof(vendor_id));
       sprintf(val,"  Partner Mode %d:\n", i);
       gtk_text_buffer_insert_at_cursor(txt_buffer, val,strlen(val));
 
@@ -162,10 +162,10 @@ void  build_alternate_mode_data(int recipient, uint32_t id_header, int num_modes
 
       switch(am_data[i].svid){
       case 0x8087:
-        build_vdo(am_data[i].vdo, 7, tbt3_sop_fields, tbt3_sop_field_desc);
+        build_vdo(am_data[i].vdo, LIBTYPEC_VDO_TBT3_SOP);
         break;
       case 0xff01:
-        build_vdo(am_data[i].vdo, 7, dp_alt_mode_partner_fields, dp_alt_mode_partner_field_desc);
+        build_vdo(am_data[i].vdo, LIBTYPEC_VDO_DP_ALT_MODE_PARTNER);
         break;
       default:
         get_vendor_string(vendor_id, sizeof(vendor_id), am_data[i].svid);
@@ -179,7 +179,7 @@ void  build_alternate_mode_data(int recipient, uint32_t id_header, int num_modes
 
   if (recipient == AM_SOP_PR) {
     for (int i = 0; i < num_modes; i++) {
-      get_svid_string(am_data[i].svid,vendor_id);
+      get_svid_string(am_data[i].svid, vendor_id, sizeof(vendor_id));
       sprintf(val,"  Cable Plug Modes %d:\n", i);
       gtk_text_buffer_insert_at_cursor(txt_buffer, val,strlen(val));
 
@@ -191,11 +191,11 @@ void  build_alternate_mode_data(int recipient, uint32_t id_header, int num_modes
 
       switch(am_data[i].svid){
       case 0x8087:
-        build_vdo(am_data[i].vdo, 7, tbt3_sop_pr_fields, tbt3_sop_pr_field_desc);
+        build_vdo(am_data[i].vdo, LIBTYPEC_VDO_TBT3_SOP_PR);
         break;
       case 0xff01:
         if ((id_header & ACTIVE_CABLE_MASK) == ACTIVE_CABLE_COMP) {
-          build_vdo(am_data[i].vdo, 7, dp_alt_mode_active_cable_fields, dp_alt_mode_active_cable_field_desc);
+          build_vdo(am_data[i].vdo, LIBTYPEC_VDO_DP_ALT_MODE_ACTIVE_CABLE);
         } else {
           get_vendor_string(vendor_id, sizeof(vendor_id), am_data[i].svid);
           sprintf(val,"      SVID Decoding not supported for 0x%04x (%s)\n", am_data[i].svid, (vendor_id[0] == '\0' ? "unknown" : vendor_id));
@@ -235,9 +235,9 @@ void build_capabilities_partner(int i)
     int num_modes;
 
    // Partner
-    num_modes = libtypec_get_alternate_modes(AM_SOP, i, am_data);
+    num_modes = libtypec_get_alternate_modes(AM_SOP, i, am_buf);
     if (num_modes >= 0) 
-      build_alternate_mode_data(AM_SOP, id.disc_id.id_header, num_modes, am_data);
+      build_alternate_mode_data(AM_SOP, id.disc_id.id_header, num_modes, am_buf);
 }
 void build_capabilities_cable(int i)
 {
@@ -253,9 +253,9 @@ void build_capabilities_cable(int i)
       build_cable_prop(cable_prop, i);
 
         // Cable
-    num_modes = libtypec_get_alternate_modes(AM_SOP_PR, i, am_data);
+    num_modes = libtypec_get_alternate_modes(AM_SOP_PR, i, am_buf);
     if (num_modes >= 0) 
-      build_alternate_mode_data(AM_SOP_PR, id.disc_id.id_header, num_modes, am_data);
+      build_alternate_mode_data(AM_SOP_PR, id.disc_id.id_header, num_modes, am_buf);
 }
 
 void build_capabilities_port(int i)
@@ -275,9 +275,9 @@ void build_capabilities_port(int i)
   sprintf(val,"  Alternate Modes Supported:\n");
   gtk_text_buffer_insert_at_cursor(txt_buffer, val,strlen(val));
 
-  num_modes = libtypec_get_alternate_modes(AM_CONNECTOR, i, am_data);
+  num_modes = libtypec_get_alternate_modes(AM_CONNECTOR, i, am_buf);
   if (num_modes > 0)
-    build_alternate_mode_data(AM_CONNECTOR, 0x0, num_modes, am_data);
+    build_alternate_mode_data(AM_CONNECTOR, 0x0, num_modes, am_buf);
   else {
     sprintf(val,"    No Local Modes listed with typec class\n");
     gtk_text_buffer_insert_at_cursor(txt_buffer, val,strlen(val));